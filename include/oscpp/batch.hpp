@@ -0,0 +1,238 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_BATCH_HPP_INCLUDED
+#define OSCPP_BATCH_HPP_INCLUDED
+
+#include <oscpp/client.hpp>
+#include <oscpp/error.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+namespace OSCPP { namespace Client {
+
+//! Coalesce messages into bundles with a size and latency limit.
+/*!
+ * Messages added to a Batcher are written into an open bundle, which
+ * is passed to the sink as a single datagram when the bundle gets too
+ * full for another message of the largest size seen so far, when a
+ * message doesn't fit anymore, when the oldest pending message has
+ * waited for the latency budget, or when flush() is called.
+ *
+ * The sink is called as sink(const void* data, size_t size). The Clock
+ * type must provide now(), time_point and duration like the clocks in
+ * std::chrono. The deadline is checked in add() and poll(); call poll()
+ * regularly (e.g. once per audio block) so that messages don't wait
+ * for longer than the budget when no further messages are added.
+ *
+ * A batch holding a single message is sent as a plain message when the
+ * bundle time is kImmediate, saving the bundle header.
+ */
+template <typename Sink, typename Clock = std::chrono::steady_clock>
+class Batcher
+{
+public:
+    typedef typename Clock::duration   Duration;
+    typedef typename Clock::time_point TimePoint;
+
+    //! Time tag for messages to be processed immediately.
+    static const uint64_t kImmediate = 1;
+
+    //! Constructor.
+    /*!
+     * \param sink Datagram sink.
+     * \param mtu Maximum datagram size in bytes.
+     * \param budget Maximum time a message is held back.
+     * \param time Time tag of the bundles sent.
+     *
+     * \throw std::invalid_argument mtu too small for a bundle.
+     */
+    Batcher(Sink sink, size_t mtu, Duration budget,
+            uint64_t time = kImmediate)
+    : m_sink(sink)
+    , m_mtu(mtu & ~size_t(3))
+    , m_budget(budget)
+    , m_time(time)
+    , m_buffer(new char[m_mtu])
+    , m_packet(m_buffer.get(), m_mtu)
+    , m_pending(0)
+    , m_maxElement(0)
+    , m_numPackets(0)
+    , m_numMessages(0)
+    {
+        if (m_mtu < Size::bundle(1) + 8)
+            throw std::invalid_argument("MTU too small for a bundle");
+    }
+
+    //! Flush pending messages, ignoring sink errors.
+    ~Batcher()
+    {
+        try
+        {
+            flush();
+        }
+        catch (std::exception&)
+        {
+        }
+    }
+
+    Batcher(const Batcher&) = delete;
+    Batcher& operator=(const Batcher&) = delete;
+
+    //! Add a message.
+    /*!
+     * Calls build(packet), which has to write a single message (or
+     * bundle) to the packet, flushing the pending messages first if the
+     * message doesn't fit.
+     *
+     * \throw OSCPP::OverflowError message doesn't fit into the MTU by
+     * itself; the message is dropped.
+     */
+    template <typename Builder> void add(Builder build)
+    {
+        if (m_pending == 0)
+            open();
+        const Packet::Mark mark = m_packet.mark();
+        size_t             begin = m_packet.size();
+        try
+        {
+            build(m_packet);
+        }
+        catch (OverflowError&)
+        {
+            m_packet.rewind(mark);
+            if (m_pending == 0)
+            {
+                m_packet.reset();
+                throw;
+            }
+            flush();
+            open();
+            begin = m_packet.size();
+            try
+            {
+                build(m_packet);
+            }
+            catch (OverflowError&)
+            {
+                m_packet.reset();
+                throw;
+            }
+        }
+        // Flush early when the largest message seen so far wouldn't fit
+        // anymore, which avoids building it twice in the common case.
+        const size_t end = m_packet.size();
+        m_maxElement = std::max(m_maxElement, end - begin);
+        const TimePoint now = Clock::now();
+        if (m_pending++ == 0)
+            m_deadline = now + m_budget;
+        if (now >= m_deadline || m_mtu - end < m_maxElement)
+            flush();
+    }
+
+    //! Flush pending messages if the deadline has passed.
+    void poll()
+    {
+        if (m_pending > 0 && Clock::now() >= m_deadline)
+            flush();
+    }
+
+    //! Send pending messages.
+    void flush()
+    {
+        if (m_pending == 0)
+            return;
+        m_packet.closeBundle();
+        const char* data = static_cast<const char*>(m_packet.data());
+        size_t      size = m_packet.size();
+        if (m_pending == 1 && m_time == kImmediate)
+        {
+            // Strip bundle header and element size
+            data += Size::bundle(1);
+            size -= Size::bundle(1);
+        }
+        m_numPackets++;
+        m_numMessages += m_pending;
+        m_pending = 0;
+        m_packet.reset();
+        m_sink(data, size);
+    }
+
+    //! Number of messages waiting to be sent.
+    size_t pending() const
+    {
+        return m_pending;
+    }
+
+    //! Time at which pending messages are due.
+    TimePoint deadline() const
+    {
+        return m_deadline;
+    }
+
+    //! Maximum datagram size, rounded down to a multiple of four.
+    size_t mtu() const
+    {
+        return m_mtu;
+    }
+
+    //! Number of datagrams sent.
+    uint64_t numPackets() const
+    {
+        return m_numPackets;
+    }
+
+    //! Number of messages sent.
+    uint64_t numMessages() const
+    {
+        return m_numMessages;
+    }
+
+private:
+    void open()
+    {
+        m_packet.reset();
+        m_packet.openBundle(m_time);
+    }
+
+    Sink                    m_sink;
+    size_t                  m_mtu;
+    Duration                m_budget;
+    uint64_t                m_time;
+    std::unique_ptr<char[]> m_buffer;
+    Packet                  m_packet;
+    size_t                  m_pending;
+    size_t                  m_maxElement;
+    TimePoint               m_deadline;
+    uint64_t                m_numPackets;
+    uint64_t                m_numMessages;
+};
+
+}} // namespace OSCPP::Client
+
+#endif // OSCPP_BATCH_HPP_INCLUDED
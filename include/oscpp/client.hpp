@@ -27,9 +27,11 @@
 
 #include <oscpp/detail/host.hpp>
 #include <oscpp/detail/stream.hpp>
+#include <oscpp/stats.hpp>
 #include <oscpp/util.hpp>
 
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <sstream>
 #include <stdexcept>
@@ -130,6 +132,43 @@ public:
         reset(m_buffer, m_capacity);
     }
 
+    //! Construction state saved by mark().
+    class Mark
+    {
+        friend class Packet;
+        char*  m_pos;
+        char*  m_sizePosB;
+        size_t m_inBundle;
+    };
+
+    //! Save the current construction state.
+    /*!
+     * \pre Must not be called while a message is open.
+     */
+    Mark mark() const
+    {
+        Mark m;
+        m.m_pos = const_cast<char*>(m_args.pos());
+        m.m_sizePosB = m_sizePosB;
+        m.m_inBundle = m_inBundle;
+        return m;
+    }
+
+    //! Discard everything written since mark was saved.
+    /*!
+     * Typically used for dropping a partially written message after an
+     * OSCPP::OverflowError, keeping the packet contents up to the mark
+     * intact.
+     */
+    void rewind(const Mark& mark)
+    {
+        m_args.setPos(mark.m_pos);
+        m_tags = WriteStream();
+        m_sizePosM = nullptr;
+        m_sizePosB = mark.m_sizePosB;
+        m_inBundle = mark.m_inBundle;
+    }
+
     Packet& openBundle(uint64_t time)
     {
         if (m_inBundle > 0)
@@ -150,6 +189,7 @@ public:
                 "Cannot open toplevel bundle in non-empty packet");
         }
 
+        Stats::countBundle(Stats::kBuilt, m_inBundle);
         m_inBundle++;
         m_args.putString("#bundle");
         m_args.putUInt64(time);
@@ -183,6 +223,8 @@ public:
                 m_sizePosB = prevPos;
             }
             m_inBundle--;
+            if (m_inBundle == 0)
+                Stats::countPacket(Stats::kBuilt, size());
         }
         else
         {
@@ -193,6 +235,13 @@ public:
     }
 
     Packet& openMessage(const char* addr, size_t numTags)
+    {
+        return openMessage(addr, std::strlen(addr), numTags);
+    }
+
+    //! Open a message with an address of the given length that need not
+    //! be NUL-terminated.
+    Packet& openMessage(const char* addr, size_t addrLength, size_t numTags)
     {
         if (m_inBundle > 0)
         {
@@ -201,8 +250,10 @@ public:
             // advance arg stream
             m_args.skip(4);
         }
-        m_args.putString(addr);
+        m_args.putString(addr, addrLength);
         size_t sigLen = numTags + 2;
+        // Report a full buffer as overflow rather than tag stream underrun
+        m_args.checkWritable(align(sigLen));
         m_tags = WriteStream(m_args, sigLen);
         m_args.zero(align(sigLen));
         m_tags.putChar(',');
@@ -211,6 +262,9 @@ public:
 
     Packet& closeMessage()
     {
+        if (m_tags.consumed() > 0)
+            Stats::countMessage(Stats::kBuilt, m_tags.begin() + 1,
+                                m_tags.consumed() - 1);
         if (m_inBundle > 0)
         {
             // Get current stream pos
@@ -223,9 +277,34 @@ public:
             // reset tag stream
             m_tags = WriteStream();
         }
+        else
+        {
+            Stats::countPacket(Stats::kBuilt, size());
+        }
         return *this;
     }
 
+    //! Write a complete message from encoded arguments.
+    /*!
+     * Copies the argument data of a message received before, or read
+     * from another encoding, without decoding it. tags holds numTags
+     * type tags without the leading ','; args must be encoded according
+     * to them.
+     *
+     * \throw OSCPP::OverflowError packet buffer too small.
+     */
+    Packet& putMessage(const char* address, size_t addressLength,
+                       const char* tags, size_t numTags, const void* args,
+                       size_t argsSize)
+    {
+        openMessage(address, addressLength, numTags);
+        if (numTags > 0)
+            std::memcpy(m_tags.pos(), tags, numTags);
+        m_tags.advance(numTags);
+        m_args.putData(args, argsSize);
+        return closeMessage();
+    }
+
     //! Write integer message argument.
     /*!
      * Write a 32 bit integer message argument.
@@ -251,6 +330,27 @@ public:
         return *this;
     }
 
+    Packet& int64(int64_t arg)
+    {
+        m_tags.putChar('h');
+        m_args.putUInt64(static_cast<uint64_t>(arg));
+        return *this;
+    }
+
+    Packet& timeTag(uint64_t arg)
+    {
+        m_tags.putChar('t');
+        m_args.putUInt64(arg);
+        return *this;
+    }
+
+    Packet& float64(double arg)
+    {
+        m_tags.putChar('d');
+        m_args.putFloat64(arg);
+        return *this;
+    }
+
     Packet& string(const char* arg)
     {
         m_tags.putChar('s');
@@ -258,6 +358,15 @@ public:
         return *this;
     }
 
+    //! Write a string argument of the given length that need not be
+    //! NUL-terminated.
+    Packet& string(const char* arg, size_t length)
+    {
+        m_tags.putChar('s');
+        m_args.putString(arg, length);
+        return *this;
+    }
+
     // @throw std::invalid_argument if blob size is greater than
     // std::numeric_limits<int32_t>::max()
     Packet& blob(const Blob& arg)
@@ -273,6 +382,63 @@ public:
         return *this;
     }
 
+    //! Write boolean message argument.
+    /*!
+     * Writes a 'T' or 'F' type tag without argument data.
+     */
+    Packet& boolean(bool arg)
+    {
+        m_tags.putChar(arg ? 'T' : 'F');
+        return *this;
+    }
+
+    Packet& nil()
+    {
+        m_tags.putChar('N');
+        return *this;
+    }
+
+    Packet& infinitum()
+    {
+        m_tags.putChar('I');
+        return *this;
+    }
+
+    Packet& character(char arg)
+    {
+        m_tags.putChar('c');
+        m_args.putInt32(static_cast<unsigned char>(arg));
+        return *this;
+    }
+
+    Packet& rgba(const Rgba& arg)
+    {
+        m_tags.putChar('r');
+        m_args.putUInt32(arg.value());
+        return *this;
+    }
+
+    Packet& midi(const Midi& arg)
+    {
+        m_tags.putChar('m');
+        m_args.putUInt32(arg.value());
+        return *this;
+    }
+
+    Packet& symbol(const char* arg)
+    {
+        m_tags.putChar('S');
+        m_args.putString(arg);
+        return *this;
+    }
+
+    Packet& symbol(const char* arg, size_t length)
+    {
+        m_tags.putChar('S');
+        m_args.putString(arg, length);
+        return *this;
+    }
+
     Packet& openArray()
     {
         m_tags.putChar('[');
@@ -328,6 +494,14 @@ template <> inline Packet& Packet::put<float>(float x)
 {
     return float32(x);
 }
+template <> inline Packet& Packet::put<int64_t>(int64_t x)
+{
+    return int64(x);
+}
+template <> inline Packet& Packet::put<double>(double x)
+{
+    return float64(x);
+}
 template <> inline Packet& Packet::put<const char*>(const char* x)
 {
     return string(x);
@@ -336,6 +510,22 @@ template <> inline Packet& Packet::put<Blob>(Blob x)
 {
     return blob(x);
 }
+template <> inline Packet& Packet::put<bool>(bool x)
+{
+    return boolean(x);
+}
+template <> inline Packet& Packet::put<char>(char x)
+{
+    return character(x);
+}
+template <> inline Packet& Packet::put<Rgba>(Rgba x)
+{
+    return rgba(x);
+}
+template <> inline Packet& Packet::put<Midi>(Midi x)
+{
+    return midi(x);
+}
 
 template <size_t buffer_size> class StaticPacket : public Packet
 {
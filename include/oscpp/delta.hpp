@@ -0,0 +1,458 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_DELTA_HPP_INCLUDED
+#define OSCPP_DELTA_HPP_INCLUDED
+
+#include <oscpp/client.hpp>
+#include <oscpp/error.hpp>
+#include <oscpp/server.hpp>
+#include <oscpp/symbol.hpp>
+#include <oscpp/util.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+//! \file
+//! Dictionary compression of message streams.
+/*!
+ * Peers that repeatedly send messages with the same address and type
+ * tags can exchange delta frames instead of OSC packets. A frame is a
+ * datagram made of records, each starting with a 32 bit word whose
+ * high byte is a marker that can't start an OSC packet:
+ *
+ *     D1 00 index      define: uint32 size, OSC message
+ *     D2 words index   reference: argument data of 4 * words bytes
+ *     D2 FF index      reference: uint32 size, argument data
+ *     D3 00 0000       reset: forget all definitions
+ *
+ * A definition carries a complete message and assigns its address and
+ * type tags to a 16 bit dictionary index; index FFFF defines nothing.
+ * A reference sends only the argument data of a message whose address
+ * and type tags have been defined before. All sizes are multiples of
+ * four. Receivers tell frames from plain OSC packets by their first
+ * byte, so both can be sent over the same transport.
+ */
+
+namespace OSCPP {
+
+namespace detail {
+
+static const unsigned kDeltaDefine = 0xD1;
+static const unsigned kDeltaReference = 0xD2;
+static const unsigned kDeltaReset = 0xD3;
+static const unsigned kDeltaLongSize = 0xFF;
+static const uint32_t kDeltaNoIndex = 0xFFFF;
+
+inline uint32_t deltaWord(unsigned marker, unsigned extra, uint32_t index)
+{
+    return (uint32_t(marker) << 24) | (uint32_t(extra) << 16) | index;
+}
+
+} // namespace detail
+
+namespace Client {
+
+//! Encoder of delta frames.
+/*!
+ * Writes messages to a frame in a caller-provided buffer, defining
+ * each new combination of address and type tags once and referencing
+ * it afterwards. Up to maxEntries combinations are kept; messages
+ * beyond that are sent as definitions that aren't stored.
+ *
+ * Definitions are assumed to reach the decoder before the references
+ * to them. On lossy transports, setting refresh to N repeats the
+ * definition with every Nth use of an entry, so that a decoder that
+ * missed it (or was restarted) drops at most N - 1 messages.
+ */
+class DeltaEncoder
+{
+public:
+    //! Maximum number of dictionary entries.
+    static const size_t kMaxEntries = detail::kDeltaNoIndex;
+
+    //! Constructor.
+    /*!
+     * \throw std::invalid_argument maxEntries greater than kMaxEntries.
+     */
+    DeltaEncoder(void* buffer, size_t capacity, size_t maxEntries = 4096,
+                 size_t refresh = 0)
+    : m_buffer(buffer)
+    , m_stream(buffer, capacity)
+    , m_maxEntries(maxEntries)
+    , m_refresh(refresh)
+    , m_reset(false)
+    {
+        if (maxEntries > kMaxEntries)
+            throw std::invalid_argument("Too many delta dictionary entries");
+        size_t numSlots = 8;
+        m_shift = 61;
+        while (numSlots < 2 * maxEntries)
+        {
+            numSlots *= 2;
+            m_shift--;
+        }
+        m_slots.assign(numSlots, uint32_t(kEmpty));
+        m_entries.reserve(maxEntries);
+    }
+
+    DeltaEncoder(const DeltaEncoder&) = delete;
+    DeltaEncoder& operator=(const DeltaEncoder&) = delete;
+
+    //! Append a message to the frame.
+    /*!
+     * \throw OSCPP::OverflowError message doesn't fit into the frame;
+     * the frame and dictionary are left unchanged.
+     */
+    void add(const Server::Message& msg)
+    {
+        ReadStream tags, args;
+        std::tie(tags, args) = msg.args().state();
+        const char*  address = msg.address();
+        const size_t addressLength = msg.addressLength();
+        const size_t numTags = tags.consumable();
+        const size_t argsSize = align(args.consumable());
+
+        const uint64_t hash = detail::hashMix(
+            detail::hashString(address, addressLength),
+            detail::hashString(tags.pos(), numTags));
+        size_t   slot = lookup(hash, address, addressLength, tags.pos(),
+                               numTags);
+        Entry*   entry = m_slots[slot] == kEmpty ? nullptr
+                                                 : &m_entries[m_slots[slot]];
+        uint32_t index = detail::kDeltaNoIndex;
+        bool     define = true;
+        if (entry != nullptr)
+        {
+            index = entry->index;
+            define = m_refresh > 0 && entry->uses + 1 >= m_refresh;
+        }
+        else if (m_entries.size() < m_maxEntries)
+        {
+            index = static_cast<uint32_t>(m_entries.size());
+        }
+
+        const size_t tagsSize = align(numTags + 2);
+        const size_t words = argsSize / 4;
+        const size_t messageSize =
+            align(addressLength + 1) + tagsSize + argsSize;
+        const size_t size =
+            (m_reset ? 4 : 0) +
+            (define ? 8 + messageSize
+                    : 4 + (words >= detail::kDeltaLongSize ? 4 : 0) +
+                          argsSize);
+        m_stream.checkWritable(size);
+
+        if (m_reset)
+        {
+            m_stream.putUInt32(detail::deltaWord(detail::kDeltaReset, 0, 0));
+            m_reset = false;
+        }
+        if (define)
+        {
+            m_stream.putUInt32(
+                detail::deltaWord(detail::kDeltaDefine, 0, index));
+            m_stream.putUInt32(static_cast<uint32_t>(messageSize));
+            m_stream.putString(address, addressLength);
+            char* pos = m_stream.pos();
+            pos[0] = ',';
+            std::memcpy(pos + 1, tags.pos(), numTags);
+            std::memset(pos + 1 + numTags, 0, tagsSize - numTags - 1);
+            m_stream.advance(tagsSize);
+        }
+        else if (words >= detail::kDeltaLongSize)
+        {
+            m_stream.putUInt32(detail::deltaWord(
+                detail::kDeltaReference, detail::kDeltaLongSize, index));
+            m_stream.putUInt32(static_cast<uint32_t>(argsSize));
+        }
+        else
+        {
+            m_stream.putUInt32(detail::deltaWord(
+                detail::kDeltaReference, static_cast<unsigned>(words),
+                index));
+        }
+        m_stream.putData(args.pos(), args.consumable());
+
+        if (entry != nullptr)
+        {
+            entry->uses = define ? 0 : entry->uses + 1;
+        }
+        else if (index != detail::kDeltaNoIndex)
+        {
+            m_slots[slot] = index;
+            m_entries.push_back(Entry{static_cast<uint32_t>(hash),
+                                      static_cast<uint32_t>(m_keys.size()),
+                                      addressLength, numTags, index, 0});
+            m_keys.append(address, addressLength);
+            m_keys.append(tags.pos(), numTags);
+        }
+    }
+
+    //! Start a new frame, keeping the dictionary.
+    void clear()
+    {
+        m_stream = WriteStream(m_buffer, m_stream.capacity());
+    }
+
+    //! Forget all definitions.
+    /*!
+     * The next record written tells the decoder to do the same.
+     */
+    void reset()
+    {
+        m_slots.assign(m_slots.size(), uint32_t(kEmpty));
+        m_entries.clear();
+        m_keys.clear();
+        m_reset = true;
+    }
+
+    const void* data() const
+    {
+        return m_buffer;
+    }
+
+    //! Size of the frame.
+    size_t size() const
+    {
+        return m_stream.consumed();
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    //! Number of dictionary entries.
+    size_t numEntries() const
+    {
+        return m_entries.size();
+    }
+
+private:
+    static const uint32_t kEmpty = 0xFFFFFFFF;
+
+    struct Entry
+    {
+        uint32_t hash;
+        uint32_t key; // Offset of address and type tags in m_keys
+        size_t   addressLength;
+        size_t   numTags;
+        uint32_t index;
+        size_t   uses; // Uses since the last definition
+    };
+
+    // Return the slot holding the entry of a key or the empty slot
+    // where it would be inserted.
+    size_t lookup(uint64_t hash, const char* address, size_t addressLength,
+                  const char* tags, size_t numTags) const
+    {
+        const size_t mask = m_slots.size() - 1;
+        size_t       slot =
+            static_cast<size_t>((hash * 0x9E3779B97F4A7C15ull) >> m_shift);
+        for (;; slot = (slot + 1) & mask)
+        {
+            if (m_slots[slot] == kEmpty)
+                return slot;
+            const Entry& entry = m_entries[m_slots[slot]];
+            const char*  key = m_keys.data() + entry.key;
+            if (entry.hash == static_cast<uint32_t>(hash) &&
+                entry.addressLength == addressLength &&
+                entry.numTags == numTags &&
+                detail::equalBytes(key, address, addressLength) &&
+                detail::equalBytes(key + addressLength, tags, numTags))
+                return slot;
+        }
+    }
+
+    void*                 m_buffer;
+    WriteStream           m_stream;
+    size_t                m_maxEntries;
+    size_t                m_refresh;
+    bool                  m_reset;
+    unsigned              m_shift;
+    std::vector<uint32_t> m_slots;
+    std::vector<Entry>    m_entries;
+    std::string           m_keys;
+};
+
+} // namespace Client
+
+namespace Server {
+
+//! Decoder of delta frames.
+/*!
+ * Keeps the definitions received so far and presents the messages of a
+ * frame as Message views, whose addresses and type tags refer to the
+ * dictionary and whose arguments refer to the frame. References to
+ * undefined entries are skipped and counted.
+ */
+class DeltaDecoder
+{
+public:
+    DeltaDecoder()
+    : m_numDropped(0)
+    {}
+
+    //! Return true if data starts with a delta record rather than an
+    //! OSC packet.
+    static bool isFrame(const void* data, size_t size)
+    {
+        const unsigned marker = size > 0 ? *static_cast<const uint8_t*>(data)
+                                         : 0;
+        return marker >= detail::kDeltaDefine &&
+               marker <= detail::kDeltaReset;
+    }
+
+    //! Call f(msg) for every message in a frame.
+    /*!
+     * The message views are valid during the call to f. Returns the
+     * number of messages decoded.
+     *
+     * \throw OSCPP::ParseError, OSCPP::UnderrunError malformed frame.
+     */
+    template <typename F> size_t decode(const void* data, size_t size, F&& f)
+    {
+        ReadStream stream(data, size);
+        size_t     n = 0;
+        while (!stream.atEnd())
+        {
+            const uint32_t word = stream.getUInt32();
+            const uint32_t index = word & 0xFFFF;
+            switch (word >> 24)
+            {
+                case detail::kDeltaDefine:
+                {
+                    const size_t messageSize = getSize(stream);
+                    const Packet packet(ReadStream(stream, messageSize), 1);
+                    stream.skip(messageSize);
+                    const Message msg(packet);
+                    if (index != detail::kDeltaNoIndex)
+                        define(index, msg);
+                    f(msg);
+                    n++;
+                    break;
+                }
+                case detail::kDeltaReference:
+                {
+                    const unsigned words = (word >> 16) & 0xFF;
+                    const size_t   argsSize = words == detail::kDeltaLongSize
+                                                  ? getSize(stream)
+                                                  : 4 * words;
+                    const ReadStream args(stream, argsSize);
+                    stream.skip(argsSize);
+                    if (index >= m_entries.size() ||
+                        m_entries[index].numTags == kUndefined)
+                    {
+                        m_numDropped++;
+                        break;
+                    }
+                    const Entry& entry = m_entries[index];
+                    const char*  key = entry.key.data();
+                    f(Message(key, entry.addressLength,
+                              ArgStream(ReadStream(key + entry.addressLength +
+                                                       1,
+                                                   entry.numTags),
+                                        args)));
+                    n++;
+                    break;
+                }
+                case detail::kDeltaReset:
+                    for (Entry& entry : m_entries)
+                        entry.numTags = kUndefined;
+                    break;
+                default:
+                    throw ParseError("Invalid delta record");
+            }
+        }
+        return n;
+    }
+
+    //! Append the messages of a frame to packet as OSC messages.
+    /*!
+     * \throw OSCPP::ParseError, OSCPP::UnderrunError malformed frame.
+     * \throw OSCPP::OverflowError packet buffer too small.
+     */
+    size_t decodeInto(const void* data, size_t size, Client::Packet& packet)
+    {
+        return decode(data, size, [&packet](const Message& msg) {
+            ReadStream tags, args;
+            std::tie(tags, args) = msg.args().state();
+            packet.putMessage(msg.address(), msg.addressLength(), tags.pos(),
+                              tags.consumable(), args.pos(),
+                              args.consumable());
+        });
+    }
+
+    //! Number of references to undefined entries skipped.
+    uint64_t numDropped() const
+    {
+        return m_numDropped;
+    }
+
+private:
+    static const size_t kUndefined = static_cast<size_t>(-1);
+
+    struct Entry
+    {
+        std::string key; // NUL-terminated address and type tags
+        size_t      addressLength;
+        size_t      numTags;
+    };
+
+    static size_t getSize(ReadStream& stream)
+    {
+        const uint32_t size = stream.getUInt32();
+        if (size % 4 != 0)
+            throw ParseError("Invalid delta record size");
+        return size;
+    }
+
+    void define(uint32_t index, const Message& msg)
+    {
+        if (index >= m_entries.size())
+            m_entries.resize(index + 1, Entry{std::string(), 0, kUndefined});
+        ReadStream tags, args;
+        std::tie(tags, args) = msg.args().state();
+        Entry& entry = m_entries[index];
+        entry.key.assign(msg.address(), msg.addressLength() + 1);
+        entry.key.append(tags.pos(), tags.consumable());
+        entry.addressLength = msg.addressLength();
+        entry.numTags = tags.consumable();
+    }
+
+    std::vector<Entry> m_entries;
+    uint64_t           m_numDropped;
+};
+
+} // namespace Server
+
+} // namespace OSCPP
+
+#endif // OSCPP_DELTA_HPP_INCLUDED
@@ -0,0 +1,224 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_BASE64_HPP_INCLUDED
+#define OSCPP_BASE64_HPP_INCLUDED
+
+#include <oscpp/detail/host.hpp>
+#include <oscpp/error.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace OSCPP { namespace detail {
+
+//! Base64 alphabet of RFC 4648.
+template <typename T = void> struct Base64Alphabet
+{
+    static const char kChars[65];
+};
+
+template <typename T>
+const char Base64Alphabet<T>::kChars[65] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Encoding table mapping 12 bits of input to two output characters.
+struct Base64EncodeTable
+{
+    Base64EncodeTable()
+    {
+        const char* chars = Base64Alphabet<>::kChars;
+        for (size_t i = 0; i < 4096; i++)
+        {
+            pairs[i][0] = chars[i >> 6];
+            pairs[i][1] = chars[i & 0x3F];
+        }
+    }
+
+    char pairs[4096][2];
+};
+
+// Decoding tables mapping the four characters of a quantum to their bits
+// in the 24 bit output word. Invalid characters map to values above 24
+// bits so that a single test per quantum detects them.
+struct Base64DecodeTable
+{
+    static const uint32_t kInvalid = 0xFF000000u;
+
+    Base64DecodeTable()
+    {
+        for (size_t i = 0; i < 4; i++)
+            for (size_t c = 0; c < 256; c++)
+                bits[i][c] = kInvalid;
+        const char* chars = Base64Alphabet<>::kChars;
+        for (uint32_t k = 0; k < 64; k++)
+        {
+            const unsigned char c = static_cast<unsigned char>(chars[k]);
+            bits[0][c] = k << 18;
+            bits[1][c] = k << 12;
+            bits[2][c] = k << 6;
+            bits[3][c] = k;
+        }
+    }
+
+    uint32_t bits[4][256];
+};
+
+inline const Base64EncodeTable& base64EncodeTable()
+{
+    static const Base64EncodeTable table;
+    return table;
+}
+
+inline const Base64DecodeTable& base64DecodeTable()
+{
+    static const Base64DecodeTable table;
+    return table;
+}
+
+//! Return the size of the padded Base64 encoding of size bytes.
+inline size_t base64EncodedSize(size_t size)
+{
+    return (size + 2) / 3 * 4;
+}
+
+//! Return an upper bound of the decoded size of length characters.
+inline size_t base64DecodedSize(size_t length)
+{
+    return (length + 3) / 4 * 3;
+}
+
+//! Encode size bytes to base64EncodedSize(size) characters.
+/*!
+ * Six input bytes are loaded as one 64 bit word and encoded with four
+ * lookups of twelve bits each.
+ */
+inline void base64Encode(const void* data, size_t size, char* out)
+{
+    const unsigned char* in = static_cast<const unsigned char*>(data);
+    const char(*pairs)[2] = base64EncodeTable().pairs;
+    while (size >= 8)
+    {
+        uint64_t x;
+        std::memcpy(&x, in, 8);
+        x = convert64<NetworkByteOrder>(x);
+        std::memcpy(out, pairs[(x >> 52) & 0xFFF], 2);
+        std::memcpy(out + 2, pairs[(x >> 40) & 0xFFF], 2);
+        std::memcpy(out + 4, pairs[(x >> 28) & 0xFFF], 2);
+        std::memcpy(out + 6, pairs[(x >> 16) & 0xFFF], 2);
+        in += 6;
+        size -= 6;
+        out += 8;
+    }
+    while (size >= 3)
+    {
+        const uint32_t x = (uint32_t(in[0]) << 16) | (uint32_t(in[1]) << 8) |
+                           uint32_t(in[2]);
+        std::memcpy(out, pairs[x >> 12], 2);
+        std::memcpy(out + 2, pairs[x & 0xFFF], 2);
+        in += 3;
+        size -= 3;
+        out += 4;
+    }
+    if (size > 0)
+    {
+        const char*    chars = Base64Alphabet<>::kChars;
+        const uint32_t x =
+            (uint32_t(in[0]) << 16) | (size > 1 ? uint32_t(in[1]) << 8 : 0);
+        out[0] = chars[x >> 18];
+        out[1] = chars[(x >> 12) & 0x3F];
+        out[2] = size > 1 ? chars[(x >> 6) & 0x3F] : '=';
+        out[3] = '=';
+    }
+}
+
+//! Decode length characters of Base64 to out and return the decoded
+//! size, which is at most base64DecodedSize(length).
+/*!
+ * The final quantum may be padded with '=' or unpadded.
+ *
+ * \throw OSCPP::ParseError invalid character or length.
+ */
+inline size_t base64Decode(const char* in, size_t length, void* data)
+{
+    if (length > 0 && in[length - 1] == '=')
+        length -= length > 1 && in[length - 2] == '=' ? 2 : 1;
+    if (length % 4 == 1)
+        throw ParseError("Invalid Base64 length");
+
+    const uint32_t(*bits)[256] = base64DecodeTable().bits;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(in);
+    unsigned char*       out = static_cast<unsigned char*>(data);
+    unsigned char* const begin = out;
+
+    // Two quanta per iteration with a combined validity test
+    while (length >= 8)
+    {
+        const uint32_t x =
+            bits[0][p[0]] | bits[1][p[1]] | bits[2][p[2]] | bits[3][p[3]];
+        const uint32_t y =
+            bits[0][p[4]] | bits[1][p[5]] | bits[2][p[6]] | bits[3][p[7]];
+        if ((x | y) & Base64DecodeTable::kInvalid)
+            throw ParseError("Invalid Base64 character");
+        out[0] = static_cast<unsigned char>(x >> 16);
+        out[1] = static_cast<unsigned char>(x >> 8);
+        out[2] = static_cast<unsigned char>(x);
+        out[3] = static_cast<unsigned char>(y >> 16);
+        out[4] = static_cast<unsigned char>(y >> 8);
+        out[5] = static_cast<unsigned char>(y);
+        p += 8;
+        length -= 8;
+        out += 6;
+    }
+    if (length > 0)
+    {
+        // Remaining full quantum and/or partial quantum of 2 or 3
+        // characters
+        unsigned char quantum[8] = {'A', 'A', 'A', 'A', 'A', 'A', 'A', 'A'};
+        std::memcpy(quantum, p, length);
+        uint32_t x = bits[0][quantum[0]] | bits[1][quantum[1]] |
+                     bits[2][quantum[2]] | bits[3][quantum[3]];
+        uint32_t y = bits[0][quantum[4]] | bits[1][quantum[5]] |
+                     bits[2][quantum[6]] | bits[3][quantum[7]];
+        if ((x | y) & Base64DecodeTable::kInvalid)
+            throw ParseError("Invalid Base64 character");
+        unsigned char bytes[6] = {
+            static_cast<unsigned char>(x >> 16),
+            static_cast<unsigned char>(x >> 8),
+            static_cast<unsigned char>(x),
+            static_cast<unsigned char>(y >> 16),
+            static_cast<unsigned char>(y >> 8),
+            static_cast<unsigned char>(y)};
+        const size_t n =
+            length / 4 * 3 + (length % 4 == 0 ? 0 : length % 4 - 1);
+        std::memcpy(out, bytes, n);
+        out += n;
+    }
+    return static_cast<size_t>(out - begin);
+}
+
+}} // namespace OSCPP::detail
+
+#endif // OSCPP_BASE64_HPP_INCLUDED
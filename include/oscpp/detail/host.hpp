@@ -27,7 +27,9 @@
 
 #include <oscpp/detail/endian.hpp>
 
+#include <cassert>
 #include <cstdint>
+#include <cstring>
 #include <stdexcept>
 
 namespace OSCPP {
@@ -70,6 +72,33 @@ inline static uint64_t bswap64(int64_t x)
 }
 #endif
 
+//! Return a mask with the high bit set in every zero byte of a word.
+inline uint32_t zeroBytes(const char* word)
+{
+    uint32_t x;
+    std::memcpy(&x, word, 4);
+    // Exact per-byte zero test without carries between bytes
+    return ~(((x & 0x7F7F7F7Fu) + 0x7F7F7F7Fu) | x | 0x7F7F7F7Fu);
+}
+
+//! Return the memory index of the first zero byte in a non-zero mask
+//! returned by zeroBytes().
+inline size_t firstZeroByte(uint32_t mask)
+{
+    assert(mask != 0);
+#if defined(__GNUC__)
+#    if defined(OSCPP_LITTLE_ENDIAN)
+    return static_cast<size_t>(__builtin_ctz(mask)) >> 3;
+#    else
+    return static_cast<size_t>(__builtin_clz(mask)) >> 3;
+#    endif
+#else
+    unsigned char bytes[4];
+    std::memcpy(bytes, &mask, 4);
+    return bytes[0] ? 0 : bytes[1] ? 1 : bytes[2] ? 2 : 3;
+#endif
+}
+
 enum ByteOrder
 {
     NetworkByteOrder,
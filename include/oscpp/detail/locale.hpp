@@ -0,0 +1,107 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_LOCALE_HPP_INCLUDED
+#define OSCPP_LOCALE_HPP_INCLUDED
+
+#include <clocale>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+#if defined(_WIN32)
+#    include <locale.h>
+#    include <stdio.h>
+#    include <stdlib.h>
+#else
+#    include <locale.h>
+#    include <stdlib.h>
+#    if defined(__APPLE__)
+#        include <xlocale.h>
+#    endif
+#endif
+
+// Conversions between floating point numbers and text that use the C
+// locale regardless of the locale selected by the application, which may
+// use a decimal comma.
+
+namespace OSCPP { namespace detail {
+
+#if defined(_WIN32)
+typedef _locale_t CLocale;
+
+inline CLocale cLocale()
+{
+    static const CLocale locale = _create_locale(LC_ALL, "C");
+    return locale;
+}
+#else
+typedef locale_t CLocale;
+
+inline CLocale cLocale()
+{
+    static const CLocale locale =
+        newlocale(LC_ALL_MASK, "C", static_cast<locale_t>(0));
+    return locale;
+}
+#endif
+
+//! Format a double like snprintf with "%.*g" in the C locale.
+inline int formatDouble(char* buffer, size_t size, int precision, double x)
+{
+#if defined(_WIN32)
+    return _snprintf_l(buffer, size, "%.*g", cLocale(), precision, x);
+#else
+    // There is no snprintf_l on all platforms; switch the calling
+    // thread's locale instead.
+    const locale_t previous = uselocale(cLocale());
+    const int      n = std::snprintf(buffer, size, "%.*g", precision, x);
+    uselocale(previous);
+    return n;
+#endif
+}
+
+//! Like std::strtod in the C locale.
+inline double strtodC(const char* str, char** end)
+{
+#if defined(_WIN32)
+    return _strtod_l(str, end, cLocale());
+#else
+    return strtod_l(str, end, cLocale());
+#endif
+}
+
+//! Like std::strtof in the C locale.
+inline float strtofC(const char* str, char** end)
+{
+#if defined(_WIN32)
+    return _strtof_l(str, end, cLocale());
+#else
+    return strtof_l(str, end, cLocale());
+#endif
+}
+
+}} // namespace OSCPP::detail
+
+#endif // OSCPP_LOCALE_HPP_INCLUDED
@@ -0,0 +1,206 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_MMAP_HPP_INCLUDED
+#define OSCPP_MMAP_HPP_INCLUDED
+
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <system_error>
+
+#if defined(_WIN32)
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+namespace OSCPP { namespace detail {
+
+//! Read-only memory mapping of a whole file.
+/*!
+ * The mapping starts at a page boundary, so data at 4-byte aligned file
+ * offsets is 4-byte aligned in memory. Empty files are represented by a
+ * null mapping of size zero.
+ */
+class MappedFile
+{
+public:
+    MappedFile()
+    : m_data(nullptr)
+    , m_size(0)
+    {}
+
+    //! Map a file.
+    /*!
+     * \throw std::system_error the file couldn't be opened or mapped.
+     */
+    explicit MappedFile(const std::string& path)
+    : m_data(nullptr)
+    , m_size(0)
+    {
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ,
+                                  FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw lastError("Couldn't open " + path);
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size))
+        {
+            const std::system_error e = lastError("Couldn't stat " + path);
+            CloseHandle(file);
+            throw e;
+        }
+        m_size = static_cast<size_t>(size.QuadPart);
+        if (m_size > 0)
+        {
+            HANDLE mapping =
+                CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping != nullptr)
+            {
+                m_data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                CloseHandle(mapping);
+            }
+            if (m_data == nullptr)
+            {
+                const std::system_error e = lastError("Couldn't map " + path);
+                CloseHandle(file);
+                throw e;
+            }
+        }
+        CloseHandle(file);
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw lastError("Couldn't open " + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0)
+        {
+            const std::system_error e = lastError("Couldn't stat " + path);
+            ::close(fd);
+            throw e;
+        }
+        m_size = static_cast<size_t>(st.st_size);
+        if (m_size > 0)
+        {
+            void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (data == MAP_FAILED)
+            {
+                const std::system_error e = lastError("Couldn't map " + path);
+                ::close(fd);
+                throw e;
+            }
+            m_data = data;
+        }
+        ::close(fd);
+#endif
+    }
+
+    MappedFile(MappedFile&& other)
+    : m_data(other.m_data)
+    , m_size(other.m_size)
+    {
+        other.m_data = nullptr;
+        other.m_size = 0;
+    }
+
+    MappedFile& operator=(MappedFile&& other)
+    {
+        if (this != &other)
+        {
+            unmap();
+            m_data = other.m_data;
+            m_size = other.m_size;
+            other.m_data = nullptr;
+            other.m_size = 0;
+        }
+        return *this;
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile()
+    {
+        unmap();
+    }
+
+    const char* data() const
+    {
+        return static_cast<const char*>(m_data);
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    //! Return true if a file exists and can be opened for reading.
+    static bool exists(const std::string& path)
+    {
+#if defined(_WIN32)
+        return GetFileAttributesA(path.c_str()) != INVALID_FILE_ATTRIBUTES;
+#else
+        return ::access(path.c_str(), R_OK) == 0;
+#endif
+    }
+
+private:
+    static std::system_error lastError(const std::string& what)
+    {
+#if defined(_WIN32)
+        return std::system_error(static_cast<int>(GetLastError()),
+                                 std::system_category(), what);
+#else
+        return std::system_error(errno, std::system_category(), what);
+#endif
+    }
+
+    void unmap()
+    {
+        if (m_data != nullptr)
+        {
+#if defined(_WIN32)
+            UnmapViewOfFile(m_data);
+#else
+            ::munmap(m_data, m_size);
+#endif
+            m_data = nullptr;
+        }
+    }
+
+    void*  m_data;
+    size_t m_size;
+};
+
+}} // namespace OSCPP::detail
+
+#endif // OSCPP_MMAP_HPP_INCLUDED
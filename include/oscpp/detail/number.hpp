@@ -0,0 +1,245 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_NUMBER_HPP_INCLUDED
+#define OSCPP_NUMBER_HPP_INCLUDED
+
+#include <oscpp/detail/locale.hpp>
+#include <oscpp/error.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace OSCPP { namespace detail {
+
+template <typename T = void> struct Pow10Table
+{
+    static const double kValues[23];
+};
+
+template <typename T>
+const double Pow10Table<T>::kValues[23] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+//! Return 10^k for 0 <= k <= 22, which is exact.
+inline double pow10(int k)
+{
+    return Pow10Table<>::kValues[k];
+}
+
+//! Scale v by 10^k; a single correctly rounded operation for |k| <= 22.
+inline double scalePow10(double v, int k)
+{
+    while (k > 22)
+    {
+        v *= pow10(22);
+        k -= 22;
+    }
+    while (k < -22)
+    {
+        v /= pow10(22);
+        k += 22;
+    }
+    return k >= 0 ? v * pow10(k) : v / pow10(-k);
+}
+
+//! Decimal number in JSON syntax, as mantissa * 10^exponent.
+struct Decimal
+{
+    const char* begin;
+    const char* end;
+    uint64_t    mantissa;
+    int         exponent;
+    bool        negative;
+    bool        integer; //!< No fraction or exponent
+    bool        exact;   //!< Mantissa holds all significant digits
+};
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Accumulate a significant digit; exponent is -1 for fraction digits.
+inline void addDigit(Decimal& n, char c, int exponent)
+{
+    const uint64_t d = static_cast<uint64_t>(c - '0');
+    if (n.exact && n.mantissa <= (UINT64_MAX - d) / 10)
+    {
+        n.mantissa = n.mantissa * 10 + d;
+        n.exponent += exponent;
+    }
+    else
+    {
+        // Drop digits beyond the precision of the mantissa
+        n.exact = false;
+        n.exponent += exponent + 1;
+    }
+}
+
+//! Parse a number in JSON syntax at pos and advance pos past it.
+/*!
+ * \throw OSCPP::ParseError no number at pos.
+ */
+inline Decimal parseDecimal(const char*& pos, const char* end)
+{
+    const char* p = pos;
+    Decimal     n = {p, p, 0, 0, false, true, true};
+    if (p != end && *p == '-')
+    {
+        n.negative = true;
+        p++;
+    }
+    if (p == end || !isDigit(*p))
+        throw ParseError("Expected number");
+    if (*p == '0')
+    {
+        p++;
+    }
+    else
+    {
+        while (p != end && isDigit(*p))
+            addDigit(n, *p++, 0);
+    }
+    if (p != end && *p == '.')
+    {
+        n.integer = false;
+        p++;
+        if (p == end || !isDigit(*p))
+            throw ParseError("Expected digit in number");
+        while (p != end && isDigit(*p))
+            addDigit(n, *p++, -1);
+    }
+    if (p != end && (*p == 'e' || *p == 'E'))
+    {
+        n.integer = false;
+        p++;
+        bool negative = false;
+        if (p != end && (*p == '+' || *p == '-'))
+            negative = *p++ == '-';
+        if (p == end || !isDigit(*p))
+            throw ParseError("Expected digit in number");
+        int e = 0;
+        while (p != end && isDigit(*p))
+        {
+            if (e < 100000)
+                e = e * 10 + (*p - '0');
+            p++;
+        }
+        n.exponent += negative ? -e : e;
+    }
+    n.end = pos = p;
+    return n;
+}
+
+inline void checkInteger(const Decimal& n)
+{
+    if (!n.integer)
+        throw ParseError("Expected integer");
+    if (!n.exact)
+        throw ParseError("Integer out of range");
+}
+
+inline uint64_t toUInt64(const Decimal& n, uint64_t max)
+{
+    checkInteger(n);
+    if (n.mantissa > max || (n.negative && n.mantissa != 0))
+        throw ParseError("Integer out of range");
+    return n.mantissa;
+}
+
+inline int64_t toInt64(const Decimal& n, int64_t min, int64_t max)
+{
+    checkInteger(n);
+    if (n.negative)
+    {
+        if (n.mantissa == 0)
+            return 0;
+        if (n.mantissa - 1 > static_cast<uint64_t>(-(min + 1)))
+            throw ParseError("Integer out of range");
+        return -static_cast<int64_t>(n.mantissa - 1) - 1;
+    }
+    if (n.mantissa > static_cast<uint64_t>(max))
+        throw ParseError("Integer out of range");
+    return static_cast<int64_t>(n.mantissa);
+}
+
+template <typename F>
+inline F parseDecimalText(const Decimal& n, F (*parse)(const char*, char**))
+{
+    char         buffer[64];
+    const size_t length = static_cast<size_t>(n.end - n.begin);
+    if (length < sizeof(buffer))
+    {
+        std::memcpy(buffer, n.begin, length);
+        buffer[length] = '\0';
+        return parse(buffer, nullptr);
+    }
+    return parse(std::string(n.begin, length).c_str(), nullptr);
+}
+
+//! Convert a number with a single correctly rounded operation where
+//! possible and fall back to the C library, in the C locale, otherwise.
+inline double toDouble(const Decimal& n)
+{
+    if (n.exact && n.mantissa <= (uint64_t(1) << 53) && n.exponent >= -22 &&
+        n.exponent <= 22)
+    {
+        const double x =
+            scalePow10(static_cast<double>(n.mantissa), n.exponent);
+        return n.negative ? -x : x;
+    }
+    return parseDecimalText<double>(n, strtodC);
+}
+
+inline float toFloat(const Decimal& n)
+{
+    // Rounding the correctly rounded double to float is correct unless
+    // the double lies exactly halfway between two floats.
+    if (n.exact && n.mantissa <= (uint64_t(1) << 53) && n.exponent >= -22 &&
+        n.exponent <= 22)
+    {
+        const double d =
+            scalePow10(static_cast<double>(n.mantissa), n.exponent);
+        const float  f = static_cast<float>(d);
+        const double e = f;
+        if (e == d ||
+            (!std::isinf(f) &&
+             d != (e + std::nextafter(f, d > e
+                                             ? std::numeric_limits<float>::max()
+                                             : 0.f)) /
+                      2))
+            return n.negative ? -f : f;
+    }
+    return parseDecimalText<float>(n, strtofC);
+}
+
+}} // namespace OSCPP::detail
+
+#endif // OSCPP_NUMBER_HPP_INCLUDED
@@ -60,12 +60,14 @@ public:
 
     Stream(const Stream& stream, size_t size)
     {
+        if (size > stream.consumable())
+            throw UnderrunError();
         m_begin = m_pos = stream.m_pos;
         m_end = m_begin + size;
-        if (m_end > stream.m_end)
-            throw UnderrunError();
     }
 
+    Stream& operator=(const Stream&) = default;
+
     void reset()
     {
         m_pos = m_begin;
@@ -157,6 +159,8 @@ public:
     : Stream(stream, size)
     {}
 
+    BasicWriteStream& operator=(const BasicWriteStream&) = default;
+
     // throw (OverflowError)
     inline void checkWritable(size_t n) const
     {
@@ -195,6 +199,15 @@ public:
         advance(4);
     }
 
+    void putUInt32(uint32_t x)
+    {
+        checkWritable(4);
+        checkAlignment(4);
+        const uint32_t un = convert32<B>(x);
+        std::memcpy(pos(), &un, 4);
+        advance(4);
+    }
+
     void putUInt64(uint64_t x)
     {
         checkWritable(8);
@@ -230,7 +243,8 @@ public:
         const size_t padding = OSCPP::padding(size);
         const size_t n = size + padding;
         checkWritable(n);
-        std::memcpy(pos(), data, size);
+        if (size > 0)
+            std::memcpy(pos(), data, size);
         std::memset(pos() + size, 0, padding);
         advance(n);
     }
@@ -239,6 +253,18 @@ public:
     {
         putData(s, strlen(s) + 1);
     }
+
+    //! Write a string of the given length that need not be
+    //! NUL-terminated.
+    void putString(const char* s, size_t length)
+    {
+        const size_t n = align(length + 1);
+        checkWritable(n);
+        if (length > 0)
+            std::memcpy(pos(), s, length);
+        std::memset(pos() + length, 0, n - length);
+        advance(n);
+    }
 };
 
 typedef BasicWriteStream<NetworkByteOrder> WriteStream;
@@ -261,6 +287,8 @@ public:
     : Stream(stream, size)
     {}
 
+    BasicReadStream& operator=(const BasicReadStream&) = default;
+
     // throw (UnderrunError)
     void checkReadable(size_t n) const
     {
@@ -311,6 +339,17 @@ public:
         return x;
     }
 
+    // throw (UnderrunError)
+    inline uint32_t getUInt32()
+    {
+        checkReadable(4);
+        checkAlignment(4);
+        uint32_t un;
+        std::memcpy(&un, pos(), 4);
+        advance(4);
+        return convert32<B>(un);
+    }
+
     // throw (UnderrunError)
     inline uint64_t getUInt64()
     {
@@ -349,27 +388,41 @@ public:
         return f;
     }
 
-    // throw (UnderrunError, ParseError)
-    const char* getString()
+    //! Read a string and return its length.
+    /*!
+     * The string ends in the first word containing a NULL byte; the
+     * string length is determined from that word, avoiding a separate
+     * call to strlen.
+     */
+    // throw (UnderrunError)
+    const char* getString(size_t& length)
     {
-        checkReadable(4); // min string length
-
-        const char* ptr = static_cast<const char*>(pos()) + 3;
+        const char* begin = static_cast<const char*>(pos());
         const char* end = static_cast<const char*>(this->end());
+        const char* ptr = begin;
+        uint32_t    mask;
 
         while (true)
         {
-            if (ptr >= end)
+            if (end - ptr < 4)
                 throw UnderrunError();
-            if (*ptr == '\0')
+            mask = zeroBytes(ptr);
+            if (mask != 0)
                 break;
             ptr += 4;
         }
 
-        const char* x = pos();
-        advance(ptr - pos() + 1);
+        length = static_cast<size_t>(ptr - begin) + firstZeroByte(mask);
+        advance(ptr - begin + 4);
 
-        return x;
+        return begin;
+    }
+
+    // throw (UnderrunError)
+    const char* getString()
+    {
+        size_t length;
+        return getString(length);
     }
 };
 
@@ -0,0 +1,233 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_TAGS_HPP_INCLUDED
+#define OSCPP_TAGS_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+namespace OSCPP { namespace detail {
+
+//! Classification of message argument type tags.
+/*!
+ * Kinds are distinct bits, so that the kinds of several tags can be
+ * combined and tested at once.
+ */
+enum TagKind
+{
+    kTagFixed = 1,      //!< Fixed size payload (possibly empty)
+    kTagString = 2,     //!< NULL-terminated string padded to 4 bytes
+    kTagBlob = 4,       //!< Size prefixed data padded to 4 bytes
+    kTagArrayBegin = 8, //!< Array start marker
+    kTagArrayEnd = 16,  //!< Array end marker
+    kTagInvalid = 32    //!< Unknown type tag
+};
+
+//! Tag kinds whose payload size doesn't depend on the argument data.
+static const unsigned kTagSizeIndependent =
+    kTagFixed | kTagArrayBegin | kTagArrayEnd;
+
+struct TagInfo
+{
+    uint8_t kind; //!< TagKind
+    uint8_t size; //!< Payload size in bytes, zero for non-fixed kinds
+};
+
+constexpr bool isOneOf(char t, const char* set)
+{
+    return *set != '\0' && (*set == t || isOneOf(t, set + 1));
+}
+
+constexpr TagInfo makeTagInfo(char t)
+{
+    // clang-format off
+    return isOneOf(t, "ifcrm") ? TagInfo{kTagFixed, 4}
+         : isOneOf(t, "htd")   ? TagInfo{kTagFixed, 8}
+         : isOneOf(t, "TFNI")  ? TagInfo{kTagFixed, 0}
+         : isOneOf(t, "sS")    ? TagInfo{kTagString, 0}
+         : t == 'b'            ? TagInfo{kTagBlob, 0}
+         : t == '['            ? TagInfo{kTagArrayBegin, 0}
+         : t == ']'            ? TagInfo{kTagArrayEnd, 0}
+                               : TagInfo{kTagInvalid, 0};
+    // clang-format on
+}
+
+// Lookup table indexed by the unsigned value of a type tag. The class
+// template allows defining the table in a header.
+template <typename T = void> struct TagTable
+{
+    static const TagInfo kInfo[256];
+};
+
+#define OSCPP_TAG_INFO_4(n)                    \
+    makeTagInfo(static_cast<char>(n)),         \
+        makeTagInfo(static_cast<char>(n + 1)), \
+        makeTagInfo(static_cast<char>(n + 2)), \
+        makeTagInfo(static_cast<char>(n + 3))
+#define OSCPP_TAG_INFO_16(n)                        \
+    OSCPP_TAG_INFO_4(n), OSCPP_TAG_INFO_4(n + 4),   \
+        OSCPP_TAG_INFO_4(n + 8), OSCPP_TAG_INFO_4(n + 12)
+#define OSCPP_TAG_INFO_64(n)                          \
+    OSCPP_TAG_INFO_16(n), OSCPP_TAG_INFO_16(n + 16),  \
+        OSCPP_TAG_INFO_16(n + 32), OSCPP_TAG_INFO_16(n + 48)
+
+template <typename T>
+const TagInfo TagTable<T>::kInfo[256] = {
+    OSCPP_TAG_INFO_64(0), OSCPP_TAG_INFO_64(64), OSCPP_TAG_INFO_64(128),
+    OSCPP_TAG_INFO_64(192)};
+
+#undef OSCPP_TAG_INFO_64
+#undef OSCPP_TAG_INFO_16
+#undef OSCPP_TAG_INFO_4
+
+//! Return the properties of a type tag.
+inline const TagInfo& tagInfo(char t)
+{
+    return TagTable<>::kInfo[static_cast<uint8_t>(t)];
+}
+
+//! Accumulate the kinds and payload sizes of a block of four tags.
+/*!
+ * Returns true if all four tags have a size that doesn't depend on the
+ * argument data, in which case their payload size is added to size.
+ */
+inline bool accumulateTags4(const char* tags, unsigned mask, size_t& size)
+{
+    const TagInfo& a = tagInfo(tags[0]);
+    const TagInfo& b = tagInfo(tags[1]);
+    const TagInfo& c = tagInfo(tags[2]);
+    const TagInfo& d = tagInfo(tags[3]);
+    if ((a.kind | b.kind | c.kind | d.kind) & ~mask)
+        return false;
+    size += a.size + b.size + c.size + d.size;
+    return true;
+}
+
+} // namespace detail
+
+//! Summary of a type tag string.
+struct TagSummary
+{
+    TagSummary()
+    : kinds(0)
+    , fixedSize(0)
+    , numArgs(0)
+    , maxDepth(0)
+    , balanced(true)
+    {}
+
+    //! Bitwise or of the detail::TagKind values of all tags.
+    unsigned kinds;
+    //! Total payload size of all fixed size arguments.
+    size_t fixedSize;
+    //! Number of arguments, not counting array markers.
+    size_t numArgs;
+    //! Maximum array nesting depth.
+    size_t maxDepth;
+    //! True if array markers are properly nested.
+    bool balanced;
+
+    //! True if all tags are known and arrays are properly nested.
+    bool isValid() const
+    {
+        return balanced && !(kinds & detail::kTagInvalid);
+    }
+
+    //! True if the argument data size is fixedSize, independent of the
+    //! argument values.
+    bool isFixedSize() const
+    {
+        return isValid() && !(kinds & ~detail::kTagSizeIndependent);
+    }
+
+    bool hasStrings() const
+    {
+        return (kinds & detail::kTagString) != 0;
+    }
+
+    bool hasBlobs() const
+    {
+        return (kinds & detail::kTagBlob) != 0;
+    }
+
+    bool hasArrays() const
+    {
+        return (kinds & detail::kTagArrayBegin) != 0;
+    }
+};
+
+//! Classify a type tag string (without the leading ',').
+/*!
+ * Runs of fixed size tags are processed in blocks of four with a single
+ * combined kind test per block.
+ */
+inline TagSummary summarizeTags(const char* tags, size_t length)
+{
+    TagSummary  result;
+    const char* end = tags + length;
+    size_t      depth = 0;
+    while (tags != end)
+    {
+        size_t fixedSize = 0;
+        while (end - tags >= 4 &&
+               detail::accumulateTags4(tags, detail::kTagFixed, fixedSize))
+        {
+            tags += 4;
+            result.numArgs += 4;
+            result.kinds |= detail::kTagFixed;
+        }
+        result.fixedSize += fixedSize;
+        if (tags == end)
+            break;
+
+        const detail::TagInfo& info = detail::tagInfo(*tags++);
+        result.kinds |= info.kind;
+        result.fixedSize += info.size;
+        if (info.kind == detail::kTagArrayBegin)
+        {
+            depth++;
+            if (depth > result.maxDepth)
+                result.maxDepth = depth;
+        }
+        else if (info.kind == detail::kTagArrayEnd)
+        {
+            if (depth == 0)
+                result.balanced = false;
+            else
+                depth--;
+        }
+        else
+        {
+            result.numArgs++;
+        }
+    }
+    if (depth != 0)
+        result.balanced = false;
+    return result;
+}
+
+} // namespace OSCPP
+
+#endif // OSCPP_TAGS_HPP_INCLUDED
@@ -0,0 +1,454 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_EDIT_HPP_INCLUDED
+#define OSCPP_EDIT_HPP_INCLUDED
+
+#include <oscpp/detail/tags.hpp>
+#include <oscpp/error.hpp>
+#include <oscpp/server.hpp>
+#include <oscpp/types.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace OSCPP { namespace Server {
+
+//! In-place editing of packets.
+/*!
+ * Changes message addresses and fixed-width arguments of a packet in
+ * its buffer, without decoding and encoding it again. An address whose
+ * padded length doesn't change is overwritten; otherwise the rest of
+ * the packet is moved once and the sizes of the enclosing bundles are
+ * adjusted.
+ *
+ * The editor indexes the messages of the packet on construction.
+ * Views returned by message() refer to the buffer and are invalidated
+ * by address changes.
+ */
+class Editor
+{
+public:
+    //! Constructor.
+    /*!
+     * \param data Packet buffer.
+     * \param size Packet size.
+     * \param capacity Buffer size, bounding the growth of the packet.
+     *
+     * \throw OSCPP::ParseError, OSCPP::UnderrunError malformed packet.
+     */
+    Editor(void* data, size_t size, size_t capacity)
+    : m_data(static_cast<char*>(data))
+    , m_size(size)
+    , m_capacity(capacity)
+    {
+        if (capacity < size)
+            throw std::invalid_argument("Capacity less than packet size");
+        const Packet packet = Packet::view(data, size);
+        if (packet.isBundle())
+            addBundle(packet, kNoSize);
+        else
+            addMessage(packet, kNoSize);
+    }
+
+    const void* data() const
+    {
+        return m_data;
+    }
+
+    //! Return the current packet size.
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    size_t numMessages() const
+    {
+        return m_messages.size();
+    }
+
+    //! Return a view of the message with the given index.
+    Message message(size_t index) const
+    {
+        const MessageEntry& entry = m_messages.at(index);
+        return Packet::view(m_data + entry.offset, entry.size);
+    }
+
+    //! Replace the address of a message.
+    /*!
+     * \throw std::invalid_argument address contains a NUL character.
+     * \throw OSCPP::OverflowError packet would exceed the capacity.
+     */
+    void setAddress(size_t index, const char* address, size_t length)
+    {
+        if (std::memchr(address, '\0', length) != nullptr)
+            throw std::invalid_argument("NUL character in address");
+        const MessageEntry& entry = m_messages.at(index);
+        m_changes.clear();
+        m_addresses.clear();
+        addChange(index, entry, address, length);
+        apply();
+    }
+
+    void setAddress(size_t index, const char* address)
+    {
+        setAddress(index, address, std::strlen(address));
+    }
+
+    //! Replace an address prefix in all messages.
+    /*!
+     * Returns the number of messages changed. The rest of the packet is
+     * moved in a single pass for all messages.
+     *
+     * \throw OSCPP::OverflowError packet would exceed the capacity;
+     * the packet is left unchanged.
+     */
+    size_t replacePrefix(const std::string& from, const std::string& to)
+    {
+        m_changes.clear();
+        m_addresses.clear();
+        for (size_t i = 0; i < m_messages.size(); i++)
+        {
+            const MessageEntry& entry = m_messages[i];
+            const char*         address = m_data + entry.offset;
+            const size_t        length = std::strlen(address);
+            if (length < from.size() ||
+                std::memcmp(address, from.data(), from.size()) != 0)
+                continue;
+            m_address.assign(to);
+            m_address.append(address + from.size(), length - from.size());
+            addChange(i, entry, m_address.data(), m_address.size());
+        }
+        apply();
+        return m_changes.size();
+    }
+
+    //! \name Argument patching
+    /*!
+     * Replace the value of the argument at position index in the type
+     * tag string of a message, where array markers count as arguments.
+     * Booleans are changed by rewriting the type tag.
+     *
+     * \throw OSCPP::ParseError argument type doesn't match.
+     * \throw std::out_of_range invalid message or argument index.
+     */
+    //@{
+    void setInt32(size_t message, size_t index, int32_t value)
+    {
+        uint32_t x;
+        std::memcpy(&x, &value, 4);
+        put32(locate(message, index, 'i'), x);
+    }
+
+    void setFloat32(size_t message, size_t index, float value)
+    {
+        uint32_t x;
+        std::memcpy(&x, &value, 4);
+        put32(locate(message, index, 'f'), x);
+    }
+
+    void setCharacter(size_t message, size_t index, char value)
+    {
+        put32(locate(message, index, 'c'), static_cast<unsigned char>(value));
+    }
+
+    void setRgba(size_t message, size_t index, const Rgba& value)
+    {
+        put32(locate(message, index, 'r'), value.value());
+    }
+
+    void setMidi(size_t message, size_t index, const Midi& value)
+    {
+        put32(locate(message, index, 'm'), value.value());
+    }
+
+    void setInt64(size_t message, size_t index, int64_t value)
+    {
+        put64(locate(message, index, 'h'), static_cast<uint64_t>(value));
+    }
+
+    void setTimeTag(size_t message, size_t index, uint64_t value)
+    {
+        put64(locate(message, index, 't'), value);
+    }
+
+    void setFloat64(size_t message, size_t index, double value)
+    {
+        uint64_t x;
+        std::memcpy(&x, &value, 8);
+        put64(locate(message, index, 'd'), x);
+    }
+
+    void setBoolean(size_t message, size_t index, bool value)
+    {
+        char* tag;
+        locate(message, index, 'T', &tag);
+        *tag = value ? 'T' : 'F';
+    }
+    //@}
+
+private:
+    static const size_t kNoSize = static_cast<size_t>(-1);
+
+    struct MessageEntry
+    {
+        size_t offset;    // Start of the message
+        size_t size;      // Size of the message
+        size_t sizeField; // Offset of the size prefix or kNoSize
+    };
+
+    struct BundleEntry
+    {
+        size_t begin;     // Start of the bundle
+        size_t end;       // End of the bundle
+        size_t sizeField; // Offset of the size prefix or kNoSize
+    };
+
+    // Address change, in order of message offsets.
+    struct Change
+    {
+        size_t    message; // Message index
+        size_t    offset;  // Message offset before the change
+        size_t    oldSize; // Old padded address size
+        size_t    newSize; // New padded address size
+        size_t    address; // New padded address in m_addresses
+        ptrdiff_t shift;   // Total size change up to this one
+    };
+
+    size_t offset(const void* ptr) const
+    {
+        return static_cast<size_t>(static_cast<const char*>(ptr) - m_data);
+    }
+
+    void addMessage(const Packet& packet, size_t sizeField)
+    {
+        // Validate address and type tags
+        const Message message(packet);
+        m_messages.push_back(
+            MessageEntry{offset(packet.data()), packet.size(), sizeField});
+    }
+
+    void addBundle(const Packet& packet, size_t sizeField)
+    {
+        const size_t begin = offset(packet.data());
+        m_bundles.push_back(
+            BundleEntry{begin, begin + packet.size(), sizeField});
+        PacketStream elements(Bundle(packet).packets());
+        while (!elements.atEnd())
+        {
+            const Packet element = elements.next();
+            const size_t elementSizeField = offset(element.data()) - 4;
+            if (element.isBundle())
+                addBundle(element, elementSizeField);
+            else
+                addMessage(element, elementSizeField);
+        }
+    }
+
+    void addChange(size_t index, const MessageEntry& entry,
+                   const char* address, size_t length)
+    {
+        const size_t oldSize = align(std::strlen(m_data + entry.offset) + 1);
+        const size_t newSize = align(length + 1);
+        const ptrdiff_t shift =
+            (m_changes.empty() ? 0 : m_changes.back().shift) +
+            static_cast<ptrdiff_t>(newSize) - static_cast<ptrdiff_t>(oldSize);
+        m_changes.push_back(Change{index, entry.offset, oldSize, newSize,
+                                   m_addresses.size(), shift});
+        m_addresses.append(address, length);
+        m_addresses.append(newSize - length, '\0');
+    }
+
+    // Return the total size change before the original offset pos.
+    ptrdiff_t shiftAt(size_t pos) const
+    {
+        size_t lo = 0;
+        size_t hi = m_changes.size();
+        while (lo < hi)
+        {
+            const size_t mid = (lo + hi) / 2;
+            if (m_changes[mid].offset < pos)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo == 0 ? 0 : m_changes[lo - 1].shift;
+    }
+
+    static size_t add(size_t x, ptrdiff_t delta)
+    {
+        return static_cast<size_t>(static_cast<ptrdiff_t>(x) + delta);
+    }
+
+    void addToSize(size_t sizeField, ptrdiff_t delta)
+    {
+        if (sizeField == kNoSize || delta == 0)
+            return;
+        uint32_t x;
+        std::memcpy(&x, m_data + sizeField, 4);
+        x = convert32<NetworkByteOrder>(x);
+        put32(m_data + sizeField, static_cast<uint32_t>(add(x, delta)));
+    }
+
+    // Write the changed addresses, moving each part of the packet
+    // between them once, and update size prefixes and the index. The
+    // changes must either all grow or all shrink (or keep) addresses;
+    // growing parts are moved back to front, shrinking ones front to
+    // back.
+    void apply()
+    {
+        const size_t n = m_changes.size();
+        if (n == 0)
+            return;
+        const ptrdiff_t total = m_changes.back().shift;
+        const bool      grow = total > 0;
+        if (total > 0 && static_cast<size_t>(total) > m_capacity - m_size)
+            throw OverflowError(static_cast<size_t>(total) -
+                                (m_capacity - m_size));
+        for (size_t i = 0; i < n; i++)
+        {
+            const size_t   k = grow ? n - 1 - i : i;
+            const Change&  c = m_changes[k];
+            const ptrdiff_t before = k == 0 ? 0 : m_changes[k - 1].shift;
+            const size_t    begin = c.offset + c.oldSize;
+            const size_t    end = k + 1 < n ? m_changes[k + 1].offset : m_size;
+            if (grow)
+            {
+                std::memmove(m_data + add(begin, c.shift), m_data + begin,
+                             end - begin);
+                std::memcpy(m_data + add(c.offset, before),
+                            m_addresses.data() + c.address, c.newSize);
+            }
+            else
+            {
+                std::memcpy(m_data + add(c.offset, before),
+                            m_addresses.data() + c.address, c.newSize);
+                std::memmove(m_data + add(begin, c.shift), m_data + begin,
+                             end - begin);
+            }
+        }
+        m_size = add(m_size, total);
+
+        for (BundleEntry& bundle : m_bundles)
+        {
+            const ptrdiff_t shift = shiftAt(bundle.begin);
+            const ptrdiff_t inside = shiftAt(bundle.end) - shift;
+            bundle.begin = add(bundle.begin, shift);
+            bundle.end = add(bundle.end, shift + inside);
+            if (bundle.sizeField != kNoSize)
+            {
+                bundle.sizeField = add(bundle.sizeField, shift);
+                addToSize(bundle.sizeField, inside);
+            }
+        }
+        size_t k = 0;
+        for (size_t i = 0; i < m_messages.size(); i++)
+        {
+            MessageEntry&   message = m_messages[i];
+            const ptrdiff_t shift = shiftAt(message.offset);
+            message.offset = add(message.offset, shift);
+            if (message.sizeField != kNoSize)
+                message.sizeField = add(message.sizeField, shift);
+            if (k < n && m_changes[k].message == i)
+            {
+                const Change&   c = m_changes[k++];
+                const ptrdiff_t delta = static_cast<ptrdiff_t>(c.newSize) -
+                                        static_cast<ptrdiff_t>(c.oldSize);
+                message.size = add(message.size, delta);
+                addToSize(message.sizeField, delta);
+            }
+        }
+    }
+
+    // Return the position of the value of an argument of type t and
+    // optionally of its type tag; 'T' matches both booleans.
+    char* locate(size_t message, size_t index, char t,
+                 char** tagPos = nullptr)
+    {
+        ReadStream tags, args;
+        std::tie(tags, args) = this->message(message).args().state();
+        if (index >= tags.consumable())
+            throw std::out_of_range("Invalid argument index");
+        for (size_t i = 0; i < index; i++)
+        {
+            const detail::TagInfo& info = detail::tagInfo(tags.getChar());
+            if (info.kind == detail::kTagFixed)
+            {
+                args.skip(info.size);
+            }
+            else if (info.kind == detail::kTagString)
+            {
+                args.getString();
+            }
+            else if (info.kind == detail::kTagBlob)
+            {
+                const int32_t size = args.getInt32();
+                if (size < 0)
+                    throw ParseError("Invalid blob size is less than zero");
+                args.skip(align(static_cast<size_t>(size)));
+            }
+            else if (info.kind == detail::kTagInvalid)
+            {
+                throw ParseError("Invalid type tag");
+            }
+        }
+        const char tag = tags.peekChar();
+        if (tag != t && !(t == 'T' && tag == 'F'))
+            throw ParseError("Argument type mismatch");
+        args.checkReadable(detail::tagInfo(tag).size);
+        if (tagPos != nullptr)
+            *tagPos = m_data + offset(tags.pos());
+        return m_data + offset(args.pos());
+    }
+
+    static void put32(char* pos, uint32_t x)
+    {
+        const uint32_t be = convert32<NetworkByteOrder>(x);
+        std::memcpy(pos, &be, 4);
+    }
+
+    static void put64(char* pos, uint64_t x)
+    {
+        const uint64_t be = convert64<NetworkByteOrder>(x);
+        std::memcpy(pos, &be, 8);
+    }
+
+    char*                     m_data;
+    size_t                    m_size;
+    size_t                    m_capacity;
+    std::vector<MessageEntry> m_messages;
+    std::vector<BundleEntry>  m_bundles;
+    std::vector<Change>       m_changes;
+    std::string               m_addresses; // Padded new addresses
+    std::string               m_address;
+};
+
+}} // namespace OSCPP::Server
+
+#endif // OSCPP_EDIT_HPP_INCLUDED
@@ -25,6 +25,8 @@
 #ifndef OSCPP_ERROR_HPP_INCLUDED
 #define OSCPP_ERROR_HPP_INCLUDED
 
+#include <oscpp/stats.hpp>
+
 #include <exception>
 #include <string>
 
@@ -54,7 +56,9 @@ class UnderrunError : public Error
 public:
     UnderrunError()
     : Error(std::string("Buffer underrun"))
-    {}
+    {
+        Stats::count(Stats::kUnderrunErrors);
+    }
 };
 
 class OverflowError : public Error
@@ -63,7 +67,9 @@ public:
     OverflowError(size_t bytes)
     : Error(std::string("Buffer overflow"))
     , m_bytes(bytes)
-    {}
+    {
+        Stats::count(Stats::kOverflowErrors);
+    }
 
     size_t numBytes() const
     {
@@ -79,7 +85,9 @@ class ParseError : public Error
 public:
     ParseError(const std::string& what = "Parse error")
     : Error(what)
-    {}
+    {
+        Stats::count(Stats::kParseErrors);
+    }
 };
 
 } // namespace OSCPP
@@ -0,0 +1,389 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_EXECUTOR_HPP_INCLUDED
+#define OSCPP_EXECUTOR_HPP_INCLUDED
+
+#include <oscpp/server.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace OSCPP { namespace Server {
+
+//! Ordering guarantees for parallel bundle dispatch.
+enum class Affinity
+{
+    //! Messages may be handled in any order and on any thread.
+    None,
+    //! Messages whose addresses share a prefix are handled one after the
+    //! other, in bundle order.
+    AddressPrefix
+};
+
+//! Parallel bundle dispatch.
+/*!
+ * Partitions the messages of a bundle across a pool of worker threads and
+ * calls a handler for each message. Every worker owns a task queue that
+ * is filled before dispatch starts; idle workers steal tasks from the
+ * back of other queues, so unevenly expensive handlers still balance.
+ *
+ * With Affinity::AddressPrefix, messages are grouped by a hash of the
+ * first `prefixDepth` address components (the whole address if zero) and
+ * every group forms a single task, which preserves the relative order of
+ * messages with the same prefix.
+ *
+ * Nested bundles are flattened depth-first; their time tags are ignored.
+ *
+ * The executor allocates its threads and bookkeeping on construction and
+ * reuses the internal buffers between calls; dispatch() must not be
+ * called concurrently from multiple threads.
+ */
+class BundleExecutor
+{
+public:
+    typedef std::function<void(const Message&)> Handler;
+
+    //! Constructor.
+    /*!
+     * \param numThreads total number of threads handling messages,
+     * including the thread calling dispatch().
+     * \param affinity ordering guarantee for messages.
+     * \param prefixDepth number of address components used for grouping
+     * messages with Affinity::AddressPrefix; zero means the whole address.
+     */
+    BundleExecutor(size_t numThreads, Affinity affinity = Affinity::None,
+                   size_t prefixDepth = 0)
+    : m_affinity(affinity)
+    , m_prefixDepth(prefixDepth)
+    , m_queues(std::max<size_t>(1, numThreads))
+    , m_handler(nullptr)
+    , m_failed(false)
+    , m_generation(0)
+    , m_finished(0)
+    , m_stop(false)
+    {
+        for (size_t i = 1; i < m_queues.size(); i++)
+        {
+            m_threads.emplace_back(&BundleExecutor::run, this, i);
+        }
+    }
+
+    BundleExecutor(const BundleExecutor&) = delete;
+    BundleExecutor& operator=(const BundleExecutor&) = delete;
+
+    ~BundleExecutor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto& thread : m_threads)
+            thread.join();
+    }
+
+    size_t numThreads() const
+    {
+        return m_queues.size();
+    }
+
+    Affinity affinity() const
+    {
+        return m_affinity;
+    }
+
+    //! Dispatch all messages contained in a bundle.
+    /*!
+     * Blocks until the handler has been called for every message. If a
+     * handler throws, the remaining messages are skipped and the first
+     * exception is rethrown in the calling thread.
+     *
+     * \throw OSCPP::UnderrunError stream buffer underrun.
+     * \throw OSCPP::ParseError error while parsing input stream.
+     */
+    void dispatch(const Bundle& bundle, const Handler& handler)
+    {
+        m_messages.clear();
+        collect(bundle);
+        execute(handler);
+    }
+
+    //! Dispatch a packet, which may be a single message.
+    void dispatch(const Packet& packet, const Handler& handler)
+    {
+        m_messages.clear();
+        collect(packet);
+        execute(handler);
+    }
+
+private:
+    struct Task
+    {
+        size_t begin;
+        size_t end;
+    };
+
+    // Per-thread task queue; the owner takes tasks from the front in
+    // partition order, thieves from the back. Padded to keep queues on
+    // separate cache lines.
+    struct Queue
+    {
+        std::mutex        mutex;
+        std::vector<Task> tasks;
+        size_t            head = 0;
+        char              padding[64];
+    };
+
+    void collect(const Packet& packet)
+    {
+        if (packet.isBundle())
+            collect(Bundle(packet));
+        else
+            m_messages.push_back(packet);
+    }
+
+    void collect(const Bundle& bundle)
+    {
+        PacketStream packets(bundle.packets());
+        while (!packets.atEnd())
+            collect(packets.next());
+    }
+
+    uint32_t prefixHash(const char* address) const
+    {
+        // FNV-1a over the address up to the requested component
+        uint32_t h = 2166136261u;
+        size_t   n = 0;
+        for (const char* p = address; *p != '\0'; p++)
+        {
+            if (*p == '/' && p != address && m_prefixDepth > 0 &&
+                ++n == m_prefixDepth)
+                break;
+            h = (h ^ static_cast<uint8_t>(*p)) * 16777619u;
+        }
+        return h;
+    }
+
+    // Partition messages into tasks and distribute them round-robin.
+    void partition()
+    {
+        const size_t kMinChunkSize = 16;
+        const size_t kChunksPerThread = 8;
+        const size_t kGroupsPerThread = 4;
+
+        const size_t numMessages = m_messages.size();
+        const size_t numQueues = m_queues.size();
+
+        for (auto& q : m_queues)
+        {
+            q.tasks.clear();
+            q.head = 0;
+        }
+
+        size_t numTasks = 0;
+        if (m_affinity == Affinity::AddressPrefix)
+        {
+            // Stable counting sort of message indices by group
+            const size_t numGroups = numQueues * kGroupsPerThread;
+            m_groups.resize(numMessages);
+            m_offsets.assign(numGroups + 1, 0);
+            for (size_t i = 0; i < numMessages; i++)
+            {
+                m_groups[i] = prefixHash(m_messages[i].address()) % numGroups;
+                m_offsets[m_groups[i] + 1]++;
+            }
+            for (size_t g = 0; g < numGroups; g++)
+                m_offsets[g + 1] += m_offsets[g];
+            m_order.resize(numMessages);
+            m_cursor.assign(m_offsets.begin(), m_offsets.end() - 1);
+            for (size_t i = 0; i < numMessages; i++)
+                m_order[m_cursor[m_groups[i]]++] = i;
+            for (size_t g = 0; g < numGroups; g++)
+            {
+                if (m_offsets[g] < m_offsets[g + 1])
+                {
+                    m_queues[numTasks++ % numQueues].tasks.push_back(
+                        Task{m_offsets[g], m_offsets[g + 1]});
+                }
+            }
+        }
+        else
+        {
+            m_order.resize(numMessages);
+            for (size_t i = 0; i < numMessages; i++)
+                m_order[i] = i;
+            const size_t chunkSize = std::max(
+                kMinChunkSize,
+                (numMessages + numQueues * kChunksPerThread - 1) /
+                    (numQueues * kChunksPerThread));
+            for (size_t i = 0; i < numMessages; i += chunkSize)
+            {
+                m_queues[numTasks++ % numQueues].tasks.push_back(
+                    Task{i, std::min(numMessages, i + chunkSize)});
+            }
+        }
+    }
+
+    void execute(const Handler& handler)
+    {
+        if (m_messages.empty())
+            return;
+
+        m_handler = &handler;
+        m_failed.store(false);
+        m_error = nullptr;
+        partition();
+
+        if (m_threads.empty())
+        {
+            work(0);
+        }
+        else
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_generation++;
+                m_finished = 0;
+            }
+            m_wake.notify_all();
+            work(0);
+            // Once every worker has drained the queues all tasks are done
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_done.wait(lock,
+                        [this] { return m_finished == m_threads.size(); });
+        }
+
+        m_handler = nullptr;
+        if (m_error)
+            std::rethrow_exception(m_error);
+    }
+
+    bool pop(size_t index, Task& task)
+    {
+        Queue&                      q = m_queues[index];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.size() > q.head)
+        {
+            task = q.tasks[q.head++];
+            return true;
+        }
+        return false;
+    }
+
+    bool steal(size_t index, Task& task)
+    {
+        for (size_t i = 1; i < m_queues.size(); i++)
+        {
+            Queue& q = m_queues[(index + i) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.tasks.size() > q.head)
+            {
+                task = q.tasks.back();
+                q.tasks.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Process tasks until all queues are empty. Tasks never spawn new
+    // tasks, so an idle worker can go back to sleep immediately.
+    void work(size_t index)
+    {
+        Task task;
+        while (pop(index, task) || steal(index, task))
+        {
+            if (!m_failed.load(std::memory_order_relaxed))
+            {
+                try
+                {
+                    for (size_t i = task.begin; i < task.end; i++)
+                        (*m_handler)(m_messages[m_order[i]]);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (!m_error)
+                        m_error = std::current_exception();
+                    m_failed.store(true);
+                }
+            }
+        }
+    }
+
+    void run(size_t index)
+    {
+        uint64_t generation = 0;
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [&] {
+                    return m_stop || m_generation != generation;
+                });
+                if (m_stop)
+                    return;
+                generation = m_generation;
+            }
+            work(index);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (++m_finished == m_threads.size())
+                    m_done.notify_one();
+            }
+        }
+    }
+
+private:
+    Affinity                 m_affinity;
+    size_t                   m_prefixDepth;
+    std::vector<Queue>       m_queues;
+    std::vector<std::thread> m_threads;
+    std::vector<Message>     m_messages;
+    std::vector<size_t>      m_order;
+    std::vector<size_t>      m_groups;
+    std::vector<size_t>      m_offsets;
+    std::vector<size_t>      m_cursor;
+    const Handler*           m_handler;
+    std::atomic<bool>        m_failed;
+    std::exception_ptr       m_error;
+    std::mutex               m_mutex;
+    std::condition_variable  m_wake;
+    std::condition_variable  m_done;
+    uint64_t                 m_generation;
+    size_t                   m_finished;
+    bool                     m_stop;
+};
+
+}} // namespace OSCPP::Server
+
+#endif // OSCPP_EXECUTOR_HPP_INCLUDED
@@ -0,0 +1,386 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_FANOUT_HPP_INCLUDED
+#define OSCPP_FANOUT_HPP_INCLUDED
+
+#include <oscpp/client.hpp>
+#include <oscpp/router.hpp>
+
+#if !defined(__unix__) && !defined(__APPLE__)
+#    error "oscpp/fanout.hpp requires POSIX sockets"
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#    define OSCPP_FANOUT_HAVE_SENDMMSG 1
+#endif
+
+namespace OSCPP { namespace Client {
+
+//! Sending the same datagram to many UDP destinations.
+/*!
+ * Owns a datagram socket and a list of destinations. send() passes a
+ * single buffer, or a list of fragments as produced by Server::Router,
+ * to all destinations with as few system calls as possible: on Linux
+ * with sendmmsg, sending up to kBatchSize datagrams per call, elsewhere
+ * with one sendmsg per destination. Nothing is allocated or copied per
+ * datagram.
+ *
+ * A failed send to one destination doesn't affect the others; errors
+ * are counted per destination and sending continues with the next one.
+ * To reach a multicast group, add the group address as a destination
+ * and configure the multicast socket options. Further options (e.g. a
+ * non-blocking socket or a larger send buffer) can be set on fd().
+ */
+class FanOut
+{
+public:
+    //! Maximum number of datagrams passed to a single sendmmsg call.
+    static const size_t kBatchSize = 64;
+
+    //! Per-destination counters.
+    struct Stats
+    {
+        uint64_t numSent = 0;   //!< Datagrams accepted by the kernel
+        uint64_t numErrors = 0; //!< Failed sends
+        int      lastError = 0; //!< errno of the most recent failure
+    };
+
+    //! Create a datagram socket.
+    /*!
+     * \param family AF_INET or AF_INET6.
+     *
+     * \throw std::system_error the socket couldn't be created.
+     */
+    explicit FanOut(int family = AF_INET)
+    : m_family(family)
+    , m_socket(::socket(family, SOCK_DGRAM, 0))
+    {
+        if (m_socket < 0)
+            throw lastError("Couldn't create socket");
+#if defined(OSCPP_FANOUT_HAVE_SENDMMSG)
+        m_headers.resize(kBatchSize);
+#endif
+    }
+
+    ~FanOut()
+    {
+        ::close(m_socket);
+    }
+
+    FanOut(const FanOut&) = delete;
+    FanOut& operator=(const FanOut&) = delete;
+
+    //! Socket file descriptor.
+    int fd() const
+    {
+        return m_socket;
+    }
+
+    //! \name Destinations
+    //@{
+
+    //! Add a destination by socket address; returns its index.
+    /*!
+     * \throw std::invalid_argument address of the wrong family.
+     */
+    size_t addDestination(const sockaddr* address, socklen_t length)
+    {
+        if (address->sa_family != m_family ||
+            length > static_cast<socklen_t>(sizeof(sockaddr_storage)))
+            throw std::invalid_argument("Invalid destination address");
+        Destination d;
+        std::memset(&d.address, 0, sizeof(d.address));
+        std::memcpy(&d.address, address, length);
+        d.length = length;
+        m_destinations.push_back(d);
+        return m_destinations.size() - 1;
+    }
+
+    //! Add a destination by host name or address and port; returns its
+    //! index.
+    /*!
+     * \throw std::invalid_argument host couldn't be resolved.
+     */
+    size_t addDestination(const std::string& host, uint16_t port)
+    {
+        addrinfo hints = addrinfo();
+        hints.ai_family = m_family;
+        hints.ai_socktype = SOCK_DGRAM;
+        hints.ai_flags = AI_NUMERICSERV;
+        const std::string service = std::to_string(port);
+        addrinfo*         result = nullptr;
+        const int         err =
+            getaddrinfo(host.c_str(), service.c_str(), &hints, &result);
+        if (err != 0)
+            throw std::invalid_argument(host + ": " + gai_strerror(err));
+        try
+        {
+            const size_t index =
+                addDestination(result->ai_addr, result->ai_addrlen);
+            freeaddrinfo(result);
+            return index;
+        }
+        catch (...)
+        {
+            freeaddrinfo(result);
+            throw;
+        }
+    }
+
+    //! Remove all destinations.
+    void clearDestinations()
+    {
+        m_destinations.clear();
+    }
+
+    size_t numDestinations() const
+    {
+        return m_destinations.size();
+    }
+
+    const Stats& stats(size_t destination) const
+    {
+        return m_destinations[destination].stats;
+    }
+
+    //@}
+
+    //! \name Multicast options
+    //@{
+
+    //! Set the number of router hops multicast datagrams may take.
+    /*!
+     * \throw std::system_error the option couldn't be set.
+     */
+    void setMulticastTtl(unsigned ttl)
+    {
+        if (m_family == AF_INET6)
+        {
+            const int hops = static_cast<int>(ttl);
+            setOption(IPPROTO_IPV6, IPV6_MULTICAST_HOPS, &hops, sizeof(hops));
+        }
+        else
+        {
+            const unsigned char value = static_cast<unsigned char>(ttl);
+            setOption(IPPROTO_IP, IP_MULTICAST_TTL, &value, sizeof(value));
+        }
+    }
+
+    //! Enable or disable delivery of multicast datagrams to the local
+    //! host.
+    /*!
+     * \throw std::system_error the option couldn't be set.
+     */
+    void setMulticastLoop(bool loop)
+    {
+        if (m_family == AF_INET6)
+        {
+            const unsigned value = loop ? 1 : 0;
+            setOption(IPPROTO_IPV6, IPV6_MULTICAST_LOOP, &value,
+                      sizeof(value));
+        }
+        else
+        {
+            const unsigned char value = loop ? 1 : 0;
+            setOption(IPPROTO_IP, IP_MULTICAST_LOOP, &value, sizeof(value));
+        }
+    }
+
+    //! Select the interface multicast datagrams are sent from.
+    /*!
+     * \param interface Local address of the interface for IPv4 sockets,
+     * interface name for IPv6 sockets.
+     *
+     * \throw std::invalid_argument unknown interface.
+     * \throw std::system_error the option couldn't be set.
+     */
+    void setMulticastInterface(const std::string& interface)
+    {
+        if (m_family == AF_INET6)
+        {
+            const unsigned index = if_nametoindex(interface.c_str());
+            if (index == 0)
+                throw std::invalid_argument("Unknown interface " + interface);
+            setOption(IPPROTO_IPV6, IPV6_MULTICAST_IF, &index, sizeof(index));
+        }
+        else
+        {
+            in_addr address;
+            if (inet_pton(AF_INET, interface.c_str(), &address) != 1)
+                throw std::invalid_argument("Invalid interface address " +
+                                            interface);
+            setOption(IPPROTO_IP, IP_MULTICAST_IF, &address,
+                      sizeof(address));
+        }
+    }
+
+    //@}
+
+    //! \name Sending
+    //@{
+
+    //! Send a datagram made of fragments to all destinations.
+    /*!
+     * Returns the number of destinations the datagram was sent to;
+     * failures are recorded in the destinations' stats.
+     */
+    size_t send(const Server::Fragment* fragments, size_t numFragments)
+    {
+        // Fragment has the same layout as iovec
+        static_assert(sizeof(Server::Fragment) == sizeof(iovec) &&
+                          offsetof(Server::Fragment, data) ==
+                              offsetof(iovec, iov_base) &&
+                          offsetof(Server::Fragment, size) ==
+                              offsetof(iovec, iov_len),
+                      "Fragment must be layout compatible with iovec");
+        iovec* iov =
+            reinterpret_cast<iovec*>(const_cast<Server::Fragment*>(fragments));
+        const size_t n = m_destinations.size();
+        size_t       numSent = 0;
+#if defined(OSCPP_FANOUT_HAVE_SENDMMSG)
+        size_t begin = 0;
+        while (begin < n)
+        {
+            const size_t count = std::min(size_t(kBatchSize), n - begin);
+            for (size_t i = 0; i < count; i++)
+                initHeader(m_headers[i].msg_hdr, m_destinations[begin + i],
+                           iov, numFragments);
+            const int result = ::sendmmsg(m_socket, m_headers.data(),
+                                          static_cast<unsigned>(count), 0);
+            if (result < 0)
+            {
+                // The first datagram failed; skip its destination
+                if (errno != EINTR)
+                    fail(m_destinations[begin++]);
+                continue;
+            }
+            for (int i = 0; i < result; i++)
+                m_destinations[begin + i].stats.numSent++;
+            numSent += static_cast<size_t>(result);
+            begin += static_cast<size_t>(result);
+        }
+#else
+        for (size_t i = 0; i < n; i++)
+        {
+            msghdr header;
+            initHeader(header, m_destinations[i], iov, numFragments);
+            ssize_t result;
+            do
+                result = ::sendmsg(m_socket, &header, 0);
+            while (result < 0 && errno == EINTR);
+            if (result < 0)
+            {
+                fail(m_destinations[i]);
+            }
+            else
+            {
+                m_destinations[i].stats.numSent++;
+                numSent++;
+            }
+        }
+#endif
+        return numSent;
+    }
+
+    //! Send a buffer to all destinations.
+    size_t send(const void* data, size_t size)
+    {
+        const Server::Fragment fragment{data, size};
+        return send(&fragment, 1);
+    }
+
+    //! Send the contents of a packet to all destinations.
+    size_t send(const Packet& packet)
+    {
+        return send(packet.data(), packet.size());
+    }
+
+    //@}
+
+private:
+    struct Destination
+    {
+        sockaddr_storage address;
+        socklen_t        length;
+        Stats            stats;
+    };
+
+    static std::system_error lastError(const std::string& what)
+    {
+        return std::system_error(errno, std::system_category(), what);
+    }
+
+    void setOption(int level, int name, const void* value, socklen_t size)
+    {
+        if (::setsockopt(m_socket, level, name, value, size) != 0)
+            throw lastError("Couldn't set socket option");
+    }
+
+    static void initHeader(msghdr& header, Destination& destination,
+                           iovec* iov, size_t numFragments)
+    {
+        std::memset(&header, 0, sizeof(header));
+        header.msg_name = &destination.address;
+        header.msg_namelen = destination.length;
+        header.msg_iov = iov;
+        header.msg_iovlen =
+            static_cast<decltype(header.msg_iovlen)>(numFragments);
+    }
+
+    static void fail(Destination& destination)
+    {
+        destination.stats.numErrors++;
+        destination.stats.lastError = errno;
+    }
+
+    int                      m_family;
+    int                      m_socket;
+    std::vector<Destination> m_destinations;
+#if defined(OSCPP_FANOUT_HAVE_SENDMMSG)
+    std::vector<mmsghdr> m_headers;
+#endif
+};
+
+}} // namespace OSCPP::Client
+
+#endif // OSCPP_FANOUT_HPP_INCLUDED
@@ -0,0 +1,687 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_FILTER_HPP_INCLUDED
+#define OSCPP_FILTER_HPP_INCLUDED
+
+#include <oscpp/detail/number.hpp>
+#include <oscpp/detail/tags.hpp>
+#include <oscpp/error.hpp>
+#include <oscpp/server.hpp>
+#include <oscpp/types.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <vector>
+
+//! \file
+//! Message filter expressions.
+/*!
+ * A filter expression combines tests on a message with `&&`, `||`, `!`
+ * and parentheses:
+ *
+ *     /meter/{left,right} && arg[0] > 0.1
+ *     /synth/[1-4]/freq || (argc == 0 && sample(10))
+ *
+ * The tests are
+ *
+ * - an OSC address pattern starting with '/', where '?' matches any
+ *   character, '*' any sequence of characters, '[a-z]' and '[!a-z]' a
+ *   character in or not in a set and '{foo,bar}' any of the given
+ *   strings. Wildcards don't match '/'. A pattern ends at white space,
+ *   ')', '&' or '|'.
+ * - `arg[N] OP LITERAL`, comparing the argument at position N in the
+ *   type tag string with a number or a double-quoted string, where OP
+ *   is one of `==`, `!=`, `<`, `<=`, `>` or `>=`. Numbers compare with
+ *   int32, int64, float32 and float64 arguments, strings with string
+ *   and symbol arguments; the test is false for a missing argument or
+ *   one of another type.
+ * - `argc OP N`, comparing the number of type tags.
+ * - `sample(N)`, true for the first and then every Nth evaluation.
+ * - `true` and `false`.
+ */
+
+namespace OSCPP { namespace Server {
+
+//! Compiled message filter.
+/*!
+ * The expression is compiled into a list of tests, each of which names
+ * the test to continue with when it succeeds or fails, so that
+ * evaluating a message runs every test on its path at most once and
+ * needs no stack. Arguments are compared in the packet buffer, without
+ * constructing values or strings.
+ *
+ * A filter is not thread safe, because sample() tests count the
+ * messages they see.
+ */
+class Filter
+{
+public:
+    //! Maximum nesting depth of parentheses and negations.
+    static const size_t kMaxDepth = 64;
+
+    //! Construct a filter that accepts every message.
+    Filter()
+    : m_entry(kAccept)
+    {}
+
+    //! Compile a filter expression.
+    /*!
+     * \throw OSCPP::ParseError invalid expression.
+     */
+    explicit Filter(const std::string& expression)
+    {
+        std::vector<Node> nodes;
+        const size_t      root = Parser(expression, nodes).parse();
+        m_entry = compile(nodes, root, kAccept, kReject);
+    }
+
+    //! Return true if the filter accepts msg.
+    /*!
+     * \throw OSCPP::ParseError, OSCPP::UnderrunError malformed
+     * arguments.
+     */
+    bool operator()(const Message& msg)
+    {
+        size_t pc = m_entry;
+        while (pc < kAccept)
+        {
+            Test& test = m_tests[pc];
+            pc = evaluate(test, msg) ? test.onTrue : test.onFalse;
+        }
+        return pc == kAccept;
+    }
+
+    //! Call f(msg) for every message in packet accepted by the filter.
+    /*!
+     * Walks nested bundles and returns the number of accepted messages.
+     *
+     * \throw OSCPP::ParseError, OSCPP::UnderrunError malformed packet.
+     */
+    template <typename F> size_t apply(const Packet& packet, F&& f)
+    {
+        if (packet.isMessage())
+        {
+            const Message msg(packet);
+            if (!(*this)(msg))
+                return 0;
+            f(msg);
+            return 1;
+        }
+        size_t       n = 0;
+        PacketStream elements(Bundle(packet).packets());
+        while (!elements.atEnd())
+            n += apply(elements.next(), f);
+        return n;
+    }
+
+    //! Return the number of compiled tests.
+    size_t size() const
+    {
+        return m_tests.size();
+    }
+
+private:
+    static const size_t kAccept = static_cast<size_t>(-2);
+    static const size_t kReject = static_cast<size_t>(-1);
+
+    enum Op
+    {
+        kAddress,
+        kArgNumber,
+        kArgString,
+        kArgCount,
+        kSample
+    };
+
+    enum Compare
+    {
+        kEq,
+        kNe,
+        kLt,
+        kLe,
+        kGt,
+        kGe
+    };
+
+    struct Test
+    {
+        Op          op;
+        Compare     compare;
+        size_t      index;    // Argument index, count or sample period
+        size_t      counter;  // Evaluations since the last sample
+        double      number;
+        float       number32; // number rounded to float
+        bool        integer;  // number is an int64 value
+        int64_t     number64;
+        std::string text;     // Address pattern or string
+        size_t      onTrue;
+        size_t      onFalse;
+    };
+
+    // Expression tree node; leaves hold a test.
+    struct Node
+    {
+        enum Kind
+        {
+            kTrue,
+            kFalse,
+            kNot,
+            kAnd,
+            kOr,
+            kLeaf
+        };
+        Kind   kind;
+        size_t left;
+        size_t right;
+        Test   test;
+    };
+
+    class Parser
+    {
+    public:
+        Parser(const std::string& text, std::vector<Node>& nodes)
+        : m_pos(text.data())
+        , m_end(text.data() + text.size())
+        , m_nodes(nodes)
+        {}
+
+        size_t parse()
+        {
+            const size_t root = parseOr(0);
+            skipSpace();
+            if (m_pos != m_end)
+                throw ParseError("Unexpected text after filter expression");
+            return root;
+        }
+
+    private:
+        static bool isSpace(char c)
+        {
+            return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+        }
+
+        void skipSpace()
+        {
+            while (m_pos != m_end && isSpace(*m_pos))
+                m_pos++;
+        }
+
+        // Skip white space and match a token.
+        bool match(const char* token)
+        {
+            skipSpace();
+            const size_t length = std::strlen(token);
+            if (static_cast<size_t>(m_end - m_pos) < length ||
+                std::memcmp(m_pos, token, length) != 0)
+                return false;
+            m_pos += length;
+            return true;
+        }
+
+        // Match a keyword that isn't followed by another letter.
+        bool matchKeyword(const char* keyword)
+        {
+            const char* pos = m_pos;
+            if (!match(keyword))
+                return false;
+            if (m_pos != m_end &&
+                ((*m_pos >= 'a' && *m_pos <= 'z') || *m_pos == '_'))
+            {
+                m_pos = pos;
+                return false;
+            }
+            return true;
+        }
+
+        void expect(const char* token)
+        {
+            if (!match(token))
+                throw ParseError(std::string("Expected '") + token +
+                                 "' in filter expression");
+        }
+
+        size_t add(Node::Kind kind, size_t left = 0, size_t right = 0)
+        {
+            m_nodes.push_back(Node{kind, left, right, Test()});
+            return m_nodes.size() - 1;
+        }
+
+        size_t parseOr(size_t depth)
+        {
+            size_t left = parseAnd(depth);
+            while (match("||"))
+                left = add(Node::kOr, left, parseAnd(depth));
+            return left;
+        }
+
+        size_t parseAnd(size_t depth)
+        {
+            size_t left = parseUnary(depth);
+            while (match("&&"))
+                left = add(Node::kAnd, left, parseUnary(depth));
+            return left;
+        }
+
+        size_t parseUnary(size_t depth)
+        {
+            if (depth > kMaxDepth)
+                throw ParseError("Filter expression nested too deeply");
+            if (match("!"))
+                return add(Node::kNot, parseUnary(depth + 1));
+            if (match("("))
+            {
+                const size_t node = parseOr(depth + 1);
+                expect(")");
+                return node;
+            }
+            if (matchKeyword("true"))
+                return add(Node::kTrue);
+            if (matchKeyword("false"))
+                return add(Node::kFalse);
+            Test test = Test();
+            if (m_pos != m_end && *m_pos == '/')
+            {
+                test.op = kAddress;
+                test.text = parsePattern();
+            }
+            else if (matchKeyword("argc"))
+            {
+                test.op = kArgCount;
+                test.compare = parseCompare();
+                test.index = parseCount();
+            }
+            else if (matchKeyword("arg"))
+            {
+                expect("[");
+                test.index = parseCount();
+                expect("]");
+                test.compare = parseCompare();
+                parseLiteral(test);
+            }
+            else if (matchKeyword("sample"))
+            {
+                test.op = kSample;
+                expect("(");
+                test.index = parseCount();
+                expect(")");
+                if (test.index == 0)
+                    throw ParseError("Sample period must be positive");
+            }
+            else
+            {
+                throw ParseError("Expected filter test");
+            }
+            const size_t node = add(Node::kLeaf);
+            m_nodes[node].test = std::move(test);
+            return node;
+        }
+
+        Compare parseCompare()
+        {
+            // Two character operators first
+            if (match("=="))
+                return kEq;
+            if (match("!="))
+                return kNe;
+            if (match("<="))
+                return kLe;
+            if (match(">="))
+                return kGe;
+            if (match("<"))
+                return kLt;
+            if (match(">"))
+                return kGt;
+            throw ParseError("Expected comparison operator");
+        }
+
+        size_t parseCount()
+        {
+            skipSpace();
+            return static_cast<size_t>(detail::toUInt64(
+                detail::parseDecimal(m_pos, m_end), SIZE_MAX));
+        }
+
+        void parseLiteral(Test& test)
+        {
+            skipSpace();
+            if (m_pos != m_end && *m_pos == '"')
+            {
+                test.op = kArgString;
+                for (m_pos++;; m_pos++)
+                {
+                    if (m_pos == m_end)
+                        throw ParseError("Unterminated string");
+                    if (*m_pos == '"')
+                        break;
+                    if (*m_pos == '\\' && ++m_pos == m_end)
+                        throw ParseError("Unterminated string");
+                    test.text += *m_pos;
+                }
+                m_pos++;
+                return;
+            }
+            test.op = kArgNumber;
+            const detail::Decimal n = detail::parseDecimal(m_pos, m_end);
+            test.number = detail::toDouble(n);
+            test.number32 = detail::toFloat(n);
+            test.integer = n.integer && n.exact &&
+                           n.mantissa <= static_cast<uint64_t>(INT64_MAX);
+            if (test.integer)
+            {
+                test.number64 = n.negative
+                                    ? -static_cast<int64_t>(n.mantissa)
+                                    : static_cast<int64_t>(n.mantissa);
+            }
+        }
+
+        std::string parsePattern()
+        {
+            const char* begin = m_pos;
+            size_t      brackets = 0;
+            size_t      braces = 0;
+            for (; m_pos != m_end; m_pos++)
+            {
+                const char c = *m_pos;
+                if (isSpace(c) || c == ')' || c == '&' || c == '|')
+                    break;
+                if (c == '[')
+                {
+                    if (brackets++ != 0)
+                        throw ParseError("Nested '[' in address pattern");
+                }
+                else if (c == ']')
+                {
+                    if (brackets-- == 0)
+                        throw ParseError("Unbalanced ']' in address pattern");
+                }
+                else if (c == '{')
+                {
+                    if (braces++ != 0)
+                        throw ParseError("Nested '{' in address pattern");
+                }
+                else if (c == '}')
+                {
+                    if (braces-- == 0)
+                        throw ParseError("Unbalanced '}' in address pattern");
+                }
+            }
+            if (brackets != 0 || braces != 0)
+                throw ParseError("Unterminated address pattern");
+            return std::string(begin, m_pos);
+        }
+
+        const char*        m_pos;
+        const char*        m_end;
+        std::vector<Node>& m_nodes;
+    };
+
+    // Compile the subtree at node with the given continuations and
+    // return its entry point. Tests are emitted from the end of the
+    // expression backwards, so that every continuation is known when
+    // a test is emitted.
+    size_t compile(const std::vector<Node>& nodes, size_t node,
+                   size_t onTrue, size_t onFalse)
+    {
+        const Node& n = nodes[node];
+        switch (n.kind)
+        {
+            case Node::kTrue:
+                return onTrue;
+            case Node::kFalse:
+                return onFalse;
+            case Node::kNot:
+                return compile(nodes, n.left, onFalse, onTrue);
+            case Node::kAnd:
+                return compile(nodes, n.left,
+                               compile(nodes, n.right, onTrue, onFalse),
+                               onFalse);
+            case Node::kOr:
+                return compile(nodes, n.left, onTrue,
+                               compile(nodes, n.right, onTrue, onFalse));
+            case Node::kLeaf:
+                break;
+        }
+        m_tests.push_back(n.test);
+        m_tests.back().onTrue = onTrue;
+        m_tests.back().onFalse = onFalse;
+        return m_tests.size() - 1;
+    }
+
+    template <typename T> static bool compare(Compare op, T a, T b)
+    {
+        switch (op)
+        {
+            case kEq:
+                return a == b;
+            case kNe:
+                return a != b;
+            case kLt:
+                return a < b;
+            case kLe:
+                return a <= b;
+            case kGt:
+                return a > b;
+            case kGe:
+                return a >= b;
+        }
+        return false;
+    }
+
+    // Match a NUL-terminated string against an address pattern.
+    static bool matchPattern(const char* p, const char* end, const char* s)
+    {
+        while (p != end)
+        {
+            switch (*p)
+            {
+                case '*':
+                    while (p != end && *p == '*')
+                        p++;
+                    if (p == end)
+                    {
+                        // Trailing '*' matches the rest of a segment
+                        while (*s != '\0' && *s != '/')
+                            s++;
+                        return *s == '\0';
+                    }
+                    for (;; s++)
+                    {
+                        if (matchPattern(p, end, s))
+                            return true;
+                        if (*s == '\0' || *s == '/')
+                            return false;
+                    }
+                case '?':
+                    if (*s == '\0' || *s == '/')
+                        return false;
+                    p++;
+                    s++;
+                    break;
+                case '[':
+                {
+                    if (*s == '\0' || *s == '/')
+                        return false;
+                    p++;
+                    const bool negate = *p == '!';
+                    if (negate)
+                        p++;
+                    bool found = false;
+                    for (; *p != ']'; p++)
+                    {
+                        if (p[1] == '-' && p[2] != ']')
+                        {
+                            found |= *s >= p[0] && *s <= p[2];
+                            p += 2;
+                        }
+                        else
+                        {
+                            found |= *s == *p;
+                        }
+                    }
+                    if (found == negate)
+                        return false;
+                    p++;
+                    s++;
+                    break;
+                }
+                case '{':
+                {
+                    const char* close =
+                        static_cast<const char*>(std::memchr(p, '}', end - p));
+                    for (const char* alt = p + 1;;)
+                    {
+                        const char* altEnd = alt;
+                        while (*altEnd != ',' && *altEnd != '}')
+                            altEnd++;
+                        const size_t length = static_cast<size_t>(altEnd - alt);
+                        if (std::strncmp(s, alt, length) == 0 &&
+                            matchPattern(close + 1, end, s + length))
+                            return true;
+                        if (altEnd == close)
+                            return false;
+                        alt = altEnd + 1;
+                    }
+                }
+                default:
+                    if (*p != *s)
+                        return false;
+                    p++;
+                    s++;
+            }
+        }
+        return *s == '\0';
+    }
+
+    // Position args at the argument with the given index and return its
+    // type tag, or '\0' if there is none.
+    static char seek(const Message& msg, size_t index, ReadStream& args)
+    {
+        ReadStream tags;
+        std::tie(tags, args) = msg.args().state();
+        if (index >= tags.consumable())
+            return '\0';
+        for (size_t i = 0; i < index; i++)
+        {
+            const detail::TagInfo& info = detail::tagInfo(tags.getChar());
+            if (info.kind == detail::kTagFixed)
+            {
+                args.skip(info.size);
+            }
+            else if (info.kind == detail::kTagString)
+            {
+                args.getString();
+            }
+            else if (info.kind == detail::kTagBlob)
+            {
+                const int32_t size = args.getInt32();
+                if (size < 0)
+                    throw ParseError("Invalid blob size is less than zero");
+                args.skip(align(static_cast<size_t>(size)));
+            }
+            else if (info.kind == detail::kTagInvalid)
+            {
+                throw ParseError("Invalid type tag");
+            }
+        }
+        return tags.peekChar();
+    }
+
+    static bool compareNumber(const Test& test, const Message& msg)
+    {
+        ReadStream args;
+        switch (seek(msg, test.index, args))
+        {
+            case 'i':
+                return compare<double>(test.compare, args.getInt32(),
+                                       test.number);
+            case 'f':
+                return compare(test.compare, args.getFloat32(),
+                               test.number32);
+            case 'h':
+            {
+                const int64_t x = static_cast<int64_t>(args.getUInt64());
+                return test.integer
+                           ? compare(test.compare, x, test.number64)
+                           : compare<double>(test.compare,
+                                             static_cast<double>(x),
+                                             test.number);
+            }
+            case 'd':
+                return compare(test.compare, args.getFloat64(), test.number);
+        }
+        return false;
+    }
+
+    static bool compareString(const Test& test, const Message& msg)
+    {
+        ReadStream args;
+        const char t = seek(msg, test.index, args);
+        if (t != 's' && t != 'S')
+            return false;
+        size_t       length;
+        const char*  s = args.getString(length);
+        const size_t n = std::min(length, test.text.size());
+        int          c = std::memcmp(s, test.text.data(), n);
+        if (c == 0)
+            c = length < test.text.size() ? -1 : length > n ? 1 : 0;
+        return compare(test.compare, c, 0);
+    }
+
+    static bool evaluate(Test& test, const Message& msg)
+    {
+        switch (test.op)
+        {
+            case kAddress:
+                return matchPattern(test.text.data(),
+                                    test.text.data() + test.text.size(),
+                                    msg.address());
+            case kArgNumber:
+                return compareNumber(test, msg);
+            case kArgString:
+                return compareString(test, msg);
+            case kArgCount:
+                return compare(test.compare, msg.args().size(), test.index);
+            case kSample:
+            {
+                const bool sampled = test.counter == 0;
+                if (++test.counter == test.index)
+                    test.counter = 0;
+                return sampled;
+            }
+        }
+        return false;
+    }
+
+    size_t            m_entry;
+    std::vector<Test> m_tests;
+};
+
+}} // namespace OSCPP::Server
+
+#endif // OSCPP_FILTER_HPP_INCLUDED
@@ -0,0 +1,603 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_FORMAT_HPP_INCLUDED
+#define OSCPP_FORMAT_HPP_INCLUDED
+
+#include <oscpp/detail/locale.hpp>
+#include <oscpp/detail/number.hpp>
+#include <oscpp/error.hpp>
+#include <oscpp/server.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+//! \file
+//! Compact text formatting of packets into character buffers.
+/*!
+ * Packets are formatted on a single line:
+ *
+ *     packet  := message | bundle
+ *     message := address (' ' arg)*
+ *     bundle  := '# ' time ' [' (' ' packet)* ' ]'
+ *     arg     := 'i:' int | 'h:' int | 't:' uint
+ *              | 'f:' float | 'd:' float
+ *              | 's:' string | 'S:' string | 'c:' string
+ *              | 'b:' hex | 'r:' hex8 | 'm:' hex8
+ *              | 'T' | 'F' | 'N' | 'I'
+ *              | '[' (' ' arg)* ' ]'
+ *
+ * e.g. `# 1 [ /synth/1 s:sine f:440 i:1 [ i:1 i:2 ] ]`. Floats are
+ * printed with the fewest digits that read back as the same value.
+ * Strings are printed as they are if they consist of printable ASCII
+ * characters other than `"`, `\`, `[` and `]` and don't start with `#`;
+ * otherwise they're quoted with `"` and the escapes `\"`, `\\`, `\n`,
+ * `\r`, `\t` and `\xHH`. Addresses are printed like strings if they
+ * start with `/` and quoted otherwise. Blobs are printed as pairs of
+ * lower case hex digits.
+ *
+ * parse() in oscpp/parse.hpp reads this form back into a packet.
+ */
+
+namespace OSCPP {
+
+namespace detail {
+
+template <typename T = void> struct FormatTables
+{
+    static const char   kDigitPairs[201];
+    static const char   kHexDigits[17];
+};
+
+template <typename T>
+const char FormatTables<T>::kDigitPairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233"
+    "34353637383940414243444546474849505152535455565758596061626364656667"
+    "6869707172737475767778798081828384858687888990919293949596979899";
+
+template <typename T>
+const char FormatTables<T>::kHexDigits[17] = "0123456789abcdef";
+
+//! Bounded output buffer for text formatting.
+class TextWriter
+{
+public:
+    TextWriter(char* buffer, size_t size)
+    : m_begin(buffer)
+    , m_pos(buffer)
+    , m_end(buffer + size)
+    {}
+
+    //! Return the number of characters written.
+    size_t size() const
+    {
+        return static_cast<size_t>(m_pos - m_begin);
+    }
+
+    //! Append n characters and return a pointer to them for the caller
+    //! to fill in.
+    char* extend(size_t n)
+    {
+        reserve(n);
+        char* result = m_pos;
+        m_pos += n;
+        return result;
+    }
+
+    void put(char c)
+    {
+        reserve(1);
+        *m_pos++ = c;
+    }
+
+    void put(const char* str, size_t length)
+    {
+        reserve(length);
+        std::memcpy(m_pos, str, length);
+        m_pos += length;
+    }
+
+    void put(const char* str)
+    {
+        put(str, std::strlen(str));
+    }
+
+    void putUInt(uint64_t x)
+    {
+        char  buffer[20];
+        char* p = buffer + sizeof(buffer);
+        while (x >= 100)
+        {
+            const size_t i = static_cast<size_t>(x % 100) * 2;
+            x /= 100;
+            p -= 2;
+            std::memcpy(p, FormatTables<>::kDigitPairs + i, 2);
+        }
+        if (x >= 10)
+        {
+            p -= 2;
+            std::memcpy(p, FormatTables<>::kDigitPairs + x * 2, 2);
+        }
+        else
+        {
+            *--p = static_cast<char>('0' + x);
+        }
+        put(p, static_cast<size_t>(buffer + sizeof(buffer) - p));
+    }
+
+    void putInt(int64_t x)
+    {
+        if (x < 0)
+        {
+            put('-');
+            putUInt(0 - static_cast<uint64_t>(x));
+        }
+        else
+        {
+            putUInt(static_cast<uint64_t>(x));
+        }
+    }
+
+    //! Write the lowest 2 * numBytes hex digits of x.
+    void putHex(uint32_t x, size_t numBytes)
+    {
+        reserve(2 * numBytes);
+        for (size_t i = 2 * numBytes; i > 0; i--)
+        {
+            m_pos[i - 1] = FormatTables<>::kHexDigits[x & 0xF];
+            x >>= 4;
+        }
+        m_pos += 2 * numBytes;
+    }
+
+    void putHexData(const void* data, size_t size)
+    {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        reserve(2 * size);
+        for (size_t i = 0; i < size; i++)
+        {
+            *m_pos++ = FormatTables<>::kHexDigits[p[i] >> 4];
+            *m_pos++ = FormatTables<>::kHexDigits[p[i] & 0xF];
+        }
+    }
+
+    //! Write the shortest decimal representation that reads back as x.
+    /*!
+     * The value and the midpoints to its neighbouring floats, which bound
+     * the decimals that read back as x, are scaled once to nine
+     * significant digits. Nine digits always identify a float; shorter
+     * candidates are obtained by rounding the scaled value and checked
+     * against the scaled bounds.
+     */
+    void putFloat(float x)
+    {
+        if (putSpecial(x))
+            return;
+        const float  a = std::fabs(x);
+        const double v = a;
+        uint32_t     bits;
+        std::memcpy(&bits, &a, 4);
+        const double below = fromBits(bits - 1);
+        const double above = a == std::numeric_limits<float>::max()
+                                 ? v + (v - below)
+                                 : fromBits(bits + 1);
+        const int    q = decimalExponent(bits) - 8;
+        const double v9 = scalePow10(v, -q);
+        const double lo9 = scalePow10((v + below) / 2, -q);
+        const double hi9 = scalePow10((v + above) / 2, -q);
+
+        // Bound for the rounding errors of the scaling; candidates closer
+        // to the bounds are checked exactly.
+        const double kMargin = 1e-4;
+        uint64_t     m = round(v9);
+        int          e = q;
+        // The exponent estimate may be one too small
+        const int d = m >= 1000000000u ? 10 : 9;
+        // Six significant digits resolve any two normal floats; subnormals
+        // have less precision.
+        for (int k = a < std::numeric_limits<float>::min() ? 1 : 6; k < d;
+             k++)
+        {
+            const double   p = pow10(d - k);
+            const uint64_t n = round(v9 / p);
+            const double   c = static_cast<double>(n);
+            const double   r = c * p;
+            if ((r - lo9 > kMargin && hi9 - r > kMargin) ||
+                (r - lo9 > -kMargin && hi9 - r > -kMargin &&
+                 static_cast<float>(scalePow10(c, q + d - k)) == a))
+            {
+                m = n;
+                e = q + d - k;
+                break;
+            }
+        }
+        int numDigits = 1;
+        while (numDigits < 19 &&
+               m >= static_cast<uint64_t>(pow10(numDigits)))
+            numDigits++;
+        const int e10 = e + numDigits - 1;
+        while (numDigits > 1 && m % 10 == 0)
+        {
+            m /= 10;
+            numDigits--;
+        }
+        if (x < 0)
+            put('-');
+        putDecimal(m, numDigits, e10);
+    }
+
+    //! Write a double with the fewest of 15 to 17 significant digits
+    //! that read back as x, with a decimal point in any locale.
+    void putDouble(double x)
+    {
+        if (putSpecial(x))
+            return;
+        char buffer[32];
+        int  n = 0;
+        for (int precision = 15; precision <= 17; precision++)
+        {
+            n = detail::formatDouble(buffer, sizeof(buffer), precision, x);
+            if (detail::strtodC(buffer, nullptr) == x)
+                break;
+        }
+        put(buffer, static_cast<size_t>(n));
+    }
+
+    //! Write a string, quoted if necessary.
+    void putString(const char* str, size_t length)
+    {
+        if (isBare(str, length))
+            put(str, length);
+        else
+            putQuoted(str, length);
+    }
+
+    //! Write a quoted string with escapes.
+    void putQuoted(const char* str, size_t length)
+    {
+        put('"');
+        for (size_t i = 0; i < length; i++)
+        {
+            const unsigned char c = static_cast<unsigned char>(str[i]);
+            switch (c)
+            {
+                case '"':
+                    put("\\\"", 2);
+                    break;
+                case '\\':
+                    put("\\\\", 2);
+                    break;
+                case '\n':
+                    put("\\n", 2);
+                    break;
+                case '\r':
+                    put("\\r", 2);
+                    break;
+                case '\t':
+                    put("\\t", 2);
+                    break;
+                default:
+                    if (c < 0x20 || c >= 0x7F)
+                    {
+                        put("\\x", 2);
+                        putHex(c, 1);
+                    }
+                    else
+                    {
+                        put(static_cast<char>(c));
+                    }
+            }
+        }
+        put('"');
+    }
+
+private:
+    void reserve(size_t n)
+    {
+        const size_t available = static_cast<size_t>(m_end - m_pos);
+        if (n > available)
+            throw OverflowError(n - available);
+    }
+
+    static bool isBare(const char* str, size_t length)
+    {
+        if (length == 0 || str[0] == '#')
+            return false;
+        for (size_t i = 0; i < length; i++)
+        {
+            const char c = str[i];
+            if (c <= ' ' || c >= 0x7F || c == '"' || c == '\\' || c == '[' ||
+                c == ']')
+                return false;
+        }
+        return true;
+    }
+
+    template <typename F> bool putSpecial(F x)
+    {
+        if (std::isnan(x))
+            put("nan", 3);
+        else if (std::isinf(x))
+            put(x < 0 ? "-inf" : "inf");
+        else if (x == 0)
+            put(std::signbit(x) ? "-0" : "0");
+        else
+            return false;
+        return true;
+    }
+
+    static float fromBits(uint32_t bits)
+    {
+        float x;
+        std::memcpy(&x, &bits, 4);
+        return x;
+    }
+
+    // Round a non-negative double below 2^52 half up.
+    static uint64_t round(double x)
+    {
+        return static_cast<uint64_t>(x + 0.5);
+    }
+
+    // Return floor(log10(a)) or one less for the bits of a positive float.
+    static int decimalExponent(uint32_t bits)
+    {
+        int e2 = static_cast<int>(bits >> 23) - 127;
+        if (e2 == -127)
+        {
+            // Subnormal
+            std::frexp(fromBits(bits), &e2);
+            e2--;
+        }
+        // floor(e2 * log10(2)) for all float exponents
+        const int n = e2 * 1233;
+        return n >= 0 ? n / 4096 : -((-n + 4095) / 4096);
+    }
+
+    // Write the digits of m, the first of which has decimal exponent e10,
+    // in fixed or exponential notation like printf's %g.
+    void putDecimal(uint64_t m, int numDigits, int e10)
+    {
+        char digits[20];
+        for (int i = numDigits; i > 0; i--)
+        {
+            digits[i - 1] = static_cast<char>('0' + m % 10);
+            m /= 10;
+        }
+        const size_t n = static_cast<size_t>(numDigits);
+        if (e10 < -4 || e10 >= 9)
+        {
+            put(digits[0]);
+            if (n > 1)
+            {
+                put('.');
+                put(digits + 1, n - 1);
+            }
+            put(e10 < 0 ? "e-" : "e+", 2);
+            const int e = e10 < 0 ? -e10 : e10;
+            if (e < 10)
+                put('0');
+            putUInt(static_cast<uint64_t>(e));
+        }
+        else if (e10 < 0)
+        {
+            put("0.", 2);
+            for (int i = -1; i > e10; i--)
+                put('0');
+            put(digits, n);
+        }
+        else
+        {
+            const size_t intDigits = static_cast<size_t>(e10) + 1;
+            if (n <= intDigits)
+            {
+                put(digits, n);
+                for (size_t i = n; i < intDigits; i++)
+                    put('0');
+            }
+            else
+            {
+                put(digits, intDigits);
+                put('.');
+                put(digits + intDigits, n - intDigits);
+            }
+        }
+    }
+
+    char* m_begin;
+    char* m_pos;
+    char* m_end;
+};
+
+inline void formatArgs(TextWriter& out, Server::ArgStream args)
+{
+    bool first = true;
+    while (!args.atEnd())
+    {
+        if (!first)
+            out.put(' ');
+        first = false;
+        const char t = args.tag();
+        switch (t)
+        {
+            case 'i':
+                out.put("i:", 2);
+                out.putInt(args.int32());
+                break;
+            case 'h':
+                out.put("h:", 2);
+                out.putInt(args.int64());
+                break;
+            case 't':
+                out.put("t:", 2);
+                out.putUInt(args.timeTag());
+                break;
+            case 'f':
+                out.put("f:", 2);
+                out.putFloat(args.float32());
+                break;
+            case 'd':
+                out.put("d:", 2);
+                out.putDouble(args.float64());
+                break;
+            case 's':
+            case 'S':
+            {
+                out.put(t);
+                out.put(':');
+                const char* str = args.string();
+                out.putString(str, std::strlen(str));
+                break;
+            }
+            case 'c':
+            {
+                out.put("c:", 2);
+                const char c = args.character();
+                out.putString(&c, 1);
+                break;
+            }
+            case 'b':
+            {
+                out.put("b:", 2);
+                const Blob b = args.blob();
+                out.putHexData(b.data(), b.size());
+                break;
+            }
+            case 'r':
+                out.put("r:", 2);
+                out.putHex(args.rgba().value(), 4);
+                break;
+            case 'm':
+                out.put("m:", 2);
+                out.putHex(args.midi().value(), 4);
+                break;
+            case 'T':
+            case 'F':
+                out.put(t);
+                args.boolean();
+                break;
+            case 'N':
+                out.put(t);
+                args.nil();
+                break;
+            case 'I':
+                out.put(t);
+                args.infinitum();
+                break;
+            case '[':
+            {
+                const Server::ArgStream array = args.array();
+                out.put('[');
+                if (!array.atEnd())
+                {
+                    out.put(' ');
+                    formatArgs(out, array);
+                }
+                out.put(" ]", 2);
+                break;
+            }
+            default:
+                // Throws for invalid tags
+                args.drop();
+        }
+    }
+}
+
+inline void formatMessage(TextWriter& out, const Server::Message& msg)
+{
+    // Addresses are quoted unless they start with '/', so that they can
+    // be told apart from arguments.
+    if (msg.address()[0] == '/')
+        out.putString(msg.address(), msg.addressLength());
+    else
+        out.putQuoted(msg.address(), msg.addressLength());
+    const Server::ArgStream args = msg.args();
+    if (!args.atEnd())
+    {
+        out.put(' ');
+        formatArgs(out, args);
+    }
+}
+
+inline void formatPacket(TextWriter& out, const Server::Packet& packet);
+
+inline void formatBundle(TextWriter& out, const Server::Bundle& bundle)
+{
+    out.put("# ", 2);
+    out.putUInt(bundle.time());
+    out.put(" [", 2);
+    Server::PacketStream packets(bundle.packets());
+    while (!packets.atEnd())
+    {
+        out.put(' ');
+        formatPacket(out, packets.next());
+    }
+    out.put(" ]", 2);
+}
+
+inline void formatPacket(TextWriter& out, const Server::Packet& packet)
+{
+    if (packet.isBundle())
+        formatBundle(out, packet);
+    else
+        formatMessage(out, packet);
+}
+
+} // namespace detail
+
+//! Format a packet into a buffer and return the number of characters
+//! written; no terminating NUL is appended.
+/*!
+ * \throw OSCPP::OverflowError buffer too small.
+ * \throw OSCPP::UnderrunError packet truncated.
+ * \throw OSCPP::ParseError malformed packet.
+ */
+inline size_t format(const Server::Packet& packet, char* buffer, size_t size)
+{
+    detail::TextWriter out(buffer, size);
+    detail::formatPacket(out, packet);
+    return out.size();
+}
+
+inline size_t format(const Server::Message& msg, char* buffer, size_t size)
+{
+    detail::TextWriter out(buffer, size);
+    detail::formatMessage(out, msg);
+    return out.size();
+}
+
+inline size_t format(const Server::Bundle& bundle, char* buffer, size_t size)
+{
+    detail::TextWriter out(buffer, size);
+    detail::formatBundle(out, bundle);
+    return out.size();
+}
+
+} // namespace OSCPP
+
+#endif // OSCPP_FORMAT_HPP_INCLUDED
@@ -0,0 +1,1024 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_JSON_HPP_INCLUDED
+#define OSCPP_JSON_HPP_INCLUDED
+
+#include <oscpp/client.hpp>
+#include <oscpp/detail/base64.hpp>
+#include <oscpp/detail/number.hpp>
+#include <oscpp/error.hpp>
+#include <oscpp/format.hpp>
+#include <oscpp/server.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <tuple>
+
+//! \file
+//! Streaming conversion between OSC packets and JSON.
+/*!
+ * Messages are represented as objects with the address, the type tag
+ * string without the leading ',' and an array with one value per type
+ * tag; arrays in the type tags correspond to nested JSON arrays:
+ *
+ *     {"address":"/n_set","types":"is[ff]","args":[1,"freq",[0.5,1]]}
+ *
+ * Bundles are represented as objects with the raw 64 bit time tag and an
+ * array of packets:
+ *
+ *     {"time":1,"packets":[{"address":"/a","types":"","args":[]}]}
+ *
+ * Argument values are encoded as follows:
+ *
+ *  i, h, t, r, m -- integer<br>
+ *  f, d          -- number, or one of the strings "nan", "inf" and "-inf"<br>
+ *  s, S          -- string<br>
+ *  c             -- string of one character<br>
+ *  b             -- Base64 encoded string<br>
+ *  T, F          -- true, false<br>
+ *  N, I          -- null
+ *
+ * When reading, keys may appear in any order and unknown keys are
+ * ignored. If "types" is missing, the type tags are inferred from the
+ * values: integers become i (h if they don't fit into 32 bits), other
+ * numbers f, strings s, booleans T or F, null N and arrays [ ].
+ */
+
+namespace OSCPP { namespace Json {
+
+namespace detail {
+
+typedef OSCPP::detail::TextWriter TextWriter;
+typedef OSCPP::detail::Decimal    Decimal;
+using OSCPP::detail::base64Decode;
+using OSCPP::detail::base64DecodedSize;
+using OSCPP::detail::base64Encode;
+using OSCPP::detail::base64EncodedSize;
+using OSCPP::detail::parseDecimal;
+using OSCPP::detail::toDouble;
+using OSCPP::detail::toFloat;
+using OSCPP::detail::toInt64;
+using OSCPP::detail::toUInt64;
+
+//! Maximum nesting depth of bundles and arrays.
+const size_t kMaxDepth = 64;
+
+inline void writeString(TextWriter& out, const char* str, size_t length)
+{
+    out.put('"');
+    const char* run = str;
+    const char* end = str + length;
+    for (const char* p = str; p != end; p++)
+    {
+        const unsigned char c = static_cast<unsigned char>(*p);
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+        out.put(run, static_cast<size_t>(p - run));
+        run = p + 1;
+        switch (c)
+        {
+            case '"':
+                out.put("\\\"", 2);
+                break;
+            case '\\':
+                out.put("\\\\", 2);
+                break;
+            case '\n':
+                out.put("\\n", 2);
+                break;
+            case '\r':
+                out.put("\\r", 2);
+                break;
+            case '\t':
+                out.put("\\t", 2);
+                break;
+            default:
+                out.put("\\u00", 4);
+                out.putHex(c, 1);
+        }
+    }
+    out.put(run, static_cast<size_t>(end - run));
+    out.put('"');
+}
+
+template <typename F> inline void writeNumber(TextWriter& out, F x)
+{
+    if (std::isnan(x))
+        out.put("\"nan\"", 5);
+    else if (std::isinf(x))
+        out.put(x < 0 ? "\"-inf\"" : "\"inf\"");
+    else if (sizeof(F) == sizeof(float))
+        out.putFloat(static_cast<float>(x));
+    else
+        out.putDouble(static_cast<double>(x));
+}
+
+inline void writeArgs(TextWriter& out, Server::ArgStream args)
+{
+    out.put('[');
+    bool first = true;
+    while (!args.atEnd())
+    {
+        if (!first)
+            out.put(',');
+        first = false;
+        switch (args.tag())
+        {
+            case 'i':
+                out.putInt(args.int32());
+                break;
+            case 'h':
+                out.putInt(args.int64());
+                break;
+            case 't':
+                out.putUInt(args.timeTag());
+                break;
+            case 'r':
+                out.putUInt(args.rgba().value());
+                break;
+            case 'm':
+                out.putUInt(args.midi().value());
+                break;
+            case 'f':
+                writeNumber(out, args.float32());
+                break;
+            case 'd':
+                writeNumber(out, args.float64());
+                break;
+            case 's':
+            case 'S':
+            {
+                const char* str = args.string();
+                writeString(out, str, std::strlen(str));
+                break;
+            }
+            case 'c':
+            {
+                const char c = args.character();
+                writeString(out, &c, 1);
+                break;
+            }
+            case 'b':
+            {
+                const Blob b = args.blob();
+                out.put('"');
+                base64Encode(b.data(), b.size(),
+                             out.extend(base64EncodedSize(b.size())));
+                out.put('"');
+                break;
+            }
+            case 'T':
+                args.boolean();
+                out.put("true", 4);
+                break;
+            case 'F':
+                args.boolean();
+                out.put("false", 5);
+                break;
+            case 'N':
+                args.nil();
+                out.put("null", 4);
+                break;
+            case 'I':
+                args.infinitum();
+                out.put("null", 4);
+                break;
+            case '[':
+                writeArgs(out, args.array());
+                break;
+            default:
+                // Throws for invalid tags
+                args.drop();
+        }
+    }
+    out.put(']');
+}
+
+// Write the type tags of an argument stream, including array markers.
+inline void writeTags(TextWriter& out, const Server::ArgStream& args)
+{
+    const ReadStream tags = std::get<0>(args.state());
+    writeString(out, tags.pos(), tags.consumable());
+}
+
+inline void writeMessage(TextWriter& out, const Server::Message& msg)
+{
+    out.put("{\"address\":", 11);
+    writeString(out, msg.address(), msg.addressLength());
+    const Server::ArgStream args = msg.args();
+    out.put(",\"types\":", 9);
+    writeTags(out, args);
+    out.put(",\"args\":", 8);
+    writeArgs(out, args);
+    out.put('}');
+}
+
+inline void writePacket(TextWriter& out, const Server::Packet& packet);
+
+inline void writeBundle(TextWriter& out, const Server::Bundle& bundle)
+{
+    out.put("{\"time\":", 8);
+    out.putUInt(bundle.time());
+    out.put(",\"packets\":[", 12);
+    Server::PacketStream packets(bundle.packets());
+    bool                 first = true;
+    while (!packets.atEnd())
+    {
+        if (!first)
+            out.put(',');
+        first = false;
+        writePacket(out, packets.next());
+    }
+    out.put("]}", 2);
+}
+
+inline void writePacket(TextWriter& out, const Server::Packet& packet)
+{
+    if (packet.isBundle())
+        writeBundle(out, packet);
+    else
+        writeMessage(out, packet);
+}
+
+} // namespace detail
+
+//! Write a packet as JSON into a buffer and return the number of
+//! characters written; no terminating NUL is appended.
+/*!
+ * \throw OSCPP::OverflowError buffer too small.
+ * \throw OSCPP::UnderrunError packet truncated.
+ * \throw OSCPP::ParseError malformed packet.
+ */
+inline size_t write(const Server::Packet& packet, char* buffer, size_t size)
+{
+    detail::TextWriter out(buffer, size);
+    detail::writePacket(out, packet);
+    return out.size();
+}
+
+inline size_t write(const Server::Message& msg, char* buffer, size_t size)
+{
+    detail::TextWriter out(buffer, size);
+    detail::writeMessage(out, msg);
+    return out.size();
+}
+
+inline size_t write(const Server::Bundle& bundle, char* buffer, size_t size)
+{
+    detail::TextWriter out(buffer, size);
+    detail::writeBundle(out, bundle);
+    return out.size();
+}
+
+//! JSON to packet conversion.
+/*!
+ * Parses JSON text in a single pass without building a document tree
+ * and writes the packet directly to a Client::Packet. Values of keys
+ * that arrive before the keys they depend on (e.g. "args" before
+ * "address") are skipped and parsed again afterwards. Strings without
+ * escape sequences are copied straight from the text; strings with
+ * escapes and blobs are decoded into scratch buffers that are reused
+ * across calls.
+ */
+class Reader
+{
+public:
+    Reader()
+    : m_pos(nullptr)
+    , m_end(nullptr)
+    {}
+
+    //! Read a packet from JSON text.
+    /*!
+     * Parses a single JSON object from the start of text, followed by
+     * optional white space, and returns the number of characters
+     * consumed, so that a sequence of objects can be read by repeated
+     * calls.
+     *
+     * \throw OSCPP::ParseError invalid JSON or packet structure.
+     * \throw OSCPP::OverflowError packet buffer too small.
+     */
+    size_t read(const char* text, size_t length, Client::Packet& packet)
+    {
+        m_pos = text;
+        m_end = text + length;
+        parsePacket(packet, 0);
+        skipSpace();
+        return static_cast<size_t>(m_pos - text);
+    }
+
+private:
+    struct Span
+    {
+        const char* data;
+        size_t      length;
+        bool        escaped;
+    };
+
+    void skipSpace()
+    {
+        while (m_pos != m_end &&
+               (*m_pos == ' ' || *m_pos == '\n' || *m_pos == '\r' ||
+                *m_pos == '\t'))
+            m_pos++;
+    }
+
+    char peek()
+    {
+        skipSpace();
+        if (m_pos == m_end)
+            throw ParseError("Unexpected end of JSON input");
+        return *m_pos;
+    }
+
+    void expect(char c)
+    {
+        if (peek() != c)
+            throw ParseError(std::string("Expected '") + c + "' in JSON input");
+        m_pos++;
+    }
+
+    // Consume a separator and return true if another element follows.
+    bool next(char close)
+    {
+        const char c = peek();
+        m_pos++;
+        if (c == ',')
+            return true;
+        if (c == close)
+            return false;
+        throw ParseError(std::string("Expected ',' or '") + close +
+                         "' in JSON input");
+    }
+
+    void expectLiteral(const char* literal, size_t length)
+    {
+        skipSpace();
+        if (static_cast<size_t>(m_end - m_pos) < length ||
+            std::memcmp(m_pos, literal, length) != 0)
+            throw ParseError(std::string("Expected ") + literal +
+                             " in JSON input");
+        m_pos += length;
+    }
+
+    static int hexValue(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    static unsigned parseHex4(const char* p)
+    {
+        unsigned x = 0;
+        for (size_t i = 0; i < 4; i++)
+        {
+            const int d = hexValue(p[i]);
+            if (d < 0)
+                throw ParseError("Invalid \\u escape in JSON string");
+            x = (x << 4) | static_cast<unsigned>(d);
+        }
+        return x;
+    }
+
+    // Skip characters that need no special treatment in a string, eight
+    // at a time while no word contains a quote, backslash or control
+    // character.
+    static const char* skipPlain(const char* p, const char* end)
+    {
+        const uint64_t kOnes = 0x0101010101010101ull;
+        const uint64_t kHighs = 0x8080808080808080ull;
+        while (end - p >= 8)
+        {
+            uint64_t x;
+            std::memcpy(&x, p, 8);
+            const uint64_t q = x ^ (kOnes * '"');
+            const uint64_t b = x ^ (kOnes * '\\');
+            if ((((x - kOnes * 0x20) & ~x) | ((q - kOnes) & ~q) |
+                 ((b - kOnes) & ~b)) &
+                kHighs)
+                break;
+            p += 8;
+        }
+        while (p != end && static_cast<unsigned char>(*p) >= 0x20 &&
+               *p != '"' && *p != '\\')
+            p++;
+        return p;
+    }
+
+    Span parseString()
+    {
+        expect('"');
+        Span span = {m_pos, 0, false};
+        for (;;)
+        {
+            m_pos = skipPlain(m_pos, m_end);
+            if (m_pos == m_end)
+                throw ParseError("Unterminated JSON string");
+            const char c = *m_pos;
+            if (c == '"')
+                break;
+            if (c != '\\')
+                throw ParseError("Control character in JSON string");
+            span.escaped = true;
+            if (m_end - m_pos < 2)
+                throw ParseError("Unterminated JSON string");
+            if (m_pos[1] == 'u')
+            {
+                if (m_end - m_pos < 6)
+                    throw ParseError("Unterminated JSON string");
+                parseHex4(m_pos + 2);
+                m_pos += 6;
+            }
+            else
+            {
+                m_pos += 2;
+            }
+        }
+        span.length = static_cast<size_t>(m_pos - span.data);
+        m_pos++;
+        return span;
+    }
+
+    static void putUtf8(std::string& out, unsigned code)
+    {
+        if (code < 0x80)
+        {
+            out += static_cast<char>(code);
+        }
+        else if (code < 0x800)
+        {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else if (code < 0x10000)
+        {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else
+        {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    // Return the contents of a string, decoding escapes into scratch if
+    // necessary.
+    static const char* decode(const Span& span, std::string& scratch,
+                              size_t& length)
+    {
+        if (!span.escaped)
+        {
+            length = span.length;
+            return span.data;
+        }
+        scratch.clear();
+        const char* p = span.data;
+        const char* end = span.data + span.length;
+        while (p != end)
+        {
+            if (*p != '\\')
+            {
+                scratch += *p++;
+                continue;
+            }
+            const char c = p[1];
+            p += 2;
+            switch (c)
+            {
+                case '"':
+                case '\\':
+                case '/':
+                    scratch += c;
+                    break;
+                case 'b':
+                    scratch += '\b';
+                    break;
+                case 'f':
+                    scratch += '\f';
+                    break;
+                case 'n':
+                    scratch += '\n';
+                    break;
+                case 'r':
+                    scratch += '\r';
+                    break;
+                case 't':
+                    scratch += '\t';
+                    break;
+                case 'u':
+                {
+                    unsigned code = parseHex4(p);
+                    p += 4;
+                    if (code >= 0xD800 && code < 0xDC00 && end - p >= 6 &&
+                        p[0] == '\\' && p[1] == 'u')
+                    {
+                        const unsigned low = parseHex4(p + 2);
+                        if (low >= 0xDC00 && low < 0xE000)
+                        {
+                            code = 0x10000 + ((code - 0xD800) << 10) +
+                                   (low - 0xDC00);
+                            p += 6;
+                        }
+                    }
+                    putUtf8(scratch, code);
+                    break;
+                }
+                default:
+                    throw ParseError("Invalid escape in JSON string");
+            }
+        }
+        length = scratch.size();
+        return scratch.data();
+    }
+
+    // Decode a string that becomes a NUL-terminated OSC string.
+    static const char* decodeOscString(const Span& span, std::string& scratch,
+                                       size_t& length)
+    {
+        const char* str = decode(span, scratch, length);
+        if (span.escaped && std::memchr(str, '\0', length) != nullptr)
+            throw ParseError("NUL character in string");
+        return str;
+    }
+
+    detail::Decimal parseNumber()
+    {
+        skipSpace();
+        return detail::parseDecimal(m_pos, m_end);
+    }
+
+    template <typename F>
+    F parseReal(F (*convert)(const detail::Decimal&))
+    {
+        if (peek() != '"')
+            return convert(parseNumber());
+        const Span s = parseString();
+        if (equals(s, "nan", 3))
+            return std::numeric_limits<F>::quiet_NaN();
+        if (equals(s, "inf", 3))
+            return std::numeric_limits<F>::infinity();
+        if (equals(s, "-inf", 4))
+            return -std::numeric_limits<F>::infinity();
+        throw ParseError("Expected number in JSON input");
+    }
+
+    static bool equals(const Span& span, const char* str, size_t length)
+    {
+        return span.length == length &&
+               std::memcmp(span.data, str, length) == 0;
+    }
+
+    void skipValue(size_t depth)
+    {
+        if (depth > detail::kMaxDepth)
+            throw ParseError("JSON input nested too deeply");
+        switch (peek())
+        {
+            case '"':
+                parseString();
+                break;
+            case '{':
+                m_pos++;
+                if (peek() == '}')
+                {
+                    m_pos++;
+                    break;
+                }
+                do
+                {
+                    parseString();
+                    expect(':');
+                    skipValue(depth + 1);
+                } while (next('}'));
+                break;
+            case '[':
+                m_pos++;
+                if (peek() == ']')
+                {
+                    m_pos++;
+                    break;
+                }
+                do
+                {
+                    skipValue(depth + 1);
+                } while (next(']'));
+                break;
+            case 't':
+                expectLiteral("true", 4);
+                break;
+            case 'f':
+                expectLiteral("false", 5);
+                break;
+            case 'n':
+                expectLiteral("null", 4);
+                break;
+            default:
+                parseNumber();
+        }
+    }
+
+    void parsePacket(Client::Packet& packet, size_t depth)
+    {
+        if (depth > detail::kMaxDepth)
+            throw ParseError("JSON input nested too deeply");
+        expect('{');
+        Span        address = {nullptr, 0, false};
+        Span        types = {nullptr, 0, false};
+        bool        hasAddress = false;
+        bool        hasTypes = false;
+        bool        hasTime = false;
+        uint64_t    time = 1;
+        const char* args = nullptr;
+        const char* packets = nullptr;
+        bool        done = false;
+        if (peek() != '}')
+        {
+            do
+            {
+                const Span key = parseString();
+                expect(':');
+                if (equals(key, "address", 7))
+                {
+                    address = parseString();
+                    hasAddress = true;
+                }
+                else if (equals(key, "types", 5))
+                {
+                    types = parseString();
+                    hasTypes = true;
+                }
+                else if (equals(key, "time", 4))
+                {
+                    time = detail::toUInt64(parseNumber(), UINT64_MAX);
+                    hasTime = true;
+                }
+                else if (equals(key, "args", 4))
+                {
+                    if (done || packets != nullptr)
+                        throw ParseError("Ambiguous packet in JSON input");
+                    if (hasAddress && hasTypes)
+                    {
+                        writeMessage(packet, address, &types, depth);
+                        done = true;
+                    }
+                    else
+                    {
+                        args = m_pos;
+                        skipValue(depth + 1);
+                    }
+                }
+                else if (equals(key, "packets", 7))
+                {
+                    if (done || args != nullptr || hasAddress)
+                        throw ParseError("Ambiguous packet in JSON input");
+                    if (hasTime)
+                    {
+                        writeBundle(packet, time, depth);
+                        done = true;
+                    }
+                    else
+                    {
+                        packets = m_pos;
+                        skipValue(depth + 1);
+                    }
+                }
+                else
+                {
+                    skipValue(depth + 1);
+                }
+            } while (next('}'));
+        }
+        else
+        {
+            m_pos++;
+        }
+        if (done)
+            return;
+
+        const char* end = m_pos;
+        if (hasAddress)
+        {
+            if (packets != nullptr)
+                throw ParseError("Ambiguous packet in JSON input");
+            m_pos = args;
+            writeMessage(packet, address, hasTypes ? &types : nullptr, depth);
+        }
+        else if (packets != nullptr)
+        {
+            if (args != nullptr)
+                throw ParseError("Ambiguous packet in JSON input");
+            m_pos = packets;
+            writeBundle(packet, time, depth);
+        }
+        else
+        {
+            throw ParseError("Expected message or bundle in JSON input");
+        }
+        m_pos = end;
+    }
+
+    // Write a bundle whose packets array starts at the current position.
+    void writeBundle(Client::Packet& packet, uint64_t time, size_t depth)
+    {
+        packet.openBundle(time);
+        expect('[');
+        if (peek() == ']')
+        {
+            m_pos++;
+        }
+        else
+        {
+            do
+            {
+                parsePacket(packet, depth + 1);
+            } while (next(']'));
+        }
+        packet.closeBundle();
+    }
+
+    // Write a message whose args array starts at the current position,
+    // or without arguments if the position is null.
+    void writeMessage(Client::Packet& packet, const Span& address,
+                      const Span* types, size_t depth)
+    {
+        size_t      addressLength;
+        const char* addressData =
+            decodeOscString(address, m_address, addressLength);
+        if (types != nullptr)
+        {
+            size_t      numTags;
+            const char* tags = decodeOscString(*types, m_types, numTags);
+            if (numTags > 0 && tags[0] == ',')
+            {
+                tags++;
+                numTags--;
+            }
+            packet.openMessage(addressData, addressLength, numTags);
+            const char* tagsEnd = tags + numTags;
+            if (m_pos != nullptr)
+            {
+                parseTypedArgs(packet, tags, tagsEnd, depth + 1);
+            }
+            if (tags != tagsEnd)
+                throw ParseError("Fewer arguments than type tags");
+        }
+        else if (m_pos != nullptr)
+        {
+            const char*  args = m_pos;
+            const size_t numTags = countTags(depth + 1);
+            m_pos = args;
+            packet.openMessage(addressData, addressLength, numTags);
+            parseArgs(packet, depth + 1);
+        }
+        else
+        {
+            packet.openMessage(addressData, addressLength, 0);
+        }
+        packet.closeMessage();
+    }
+
+    void parseTypedArgs(Client::Packet& packet, const char*& tag,
+                        const char* tagsEnd, size_t depth)
+    {
+        if (depth > detail::kMaxDepth)
+            throw ParseError("JSON input nested too deeply");
+        expect('[');
+        if (peek() == ']')
+        {
+            m_pos++;
+            return;
+        }
+        do
+        {
+            if (tag == tagsEnd || *tag == ']')
+                throw ParseError("More arguments than type tags");
+            const char t = *tag++;
+            if (t == '[')
+            {
+                packet.openArray();
+                parseTypedArgs(packet, tag, tagsEnd, depth + 1);
+                if (tag == tagsEnd || *tag != ']')
+                    throw ParseError("Fewer arguments than type tags");
+                tag++;
+                packet.closeArray();
+            }
+            else
+            {
+                parseTypedArg(packet, t);
+            }
+        } while (next(']'));
+    }
+
+    void parseTypedArg(Client::Packet& packet, char t)
+    {
+        switch (t)
+        {
+            case 'i':
+                packet.int32(static_cast<int32_t>(
+                    detail::toInt64(parseNumber(), INT32_MIN, INT32_MAX)));
+                break;
+            case 'h':
+                packet.int64(
+                    detail::toInt64(parseNumber(), INT64_MIN, INT64_MAX));
+                break;
+            case 't':
+                packet.timeTag(detail::toUInt64(parseNumber(), UINT64_MAX));
+                break;
+            case 'r':
+                packet.rgba(Rgba(static_cast<uint32_t>(
+                    detail::toUInt64(parseNumber(), UINT32_MAX))));
+                break;
+            case 'm':
+                packet.midi(Midi(static_cast<uint32_t>(
+                    detail::toUInt64(parseNumber(), UINT32_MAX))));
+                break;
+            case 'f':
+                packet.float32(parseReal<float>(detail::toFloat));
+                break;
+            case 'd':
+                packet.float64(parseReal<double>(detail::toDouble));
+                break;
+            case 's':
+            case 'S':
+            {
+                size_t      length;
+                const char* str =
+                    decodeOscString(parseString(), m_string, length);
+                if (t == 's')
+                    packet.string(str, length);
+                else
+                    packet.symbol(str, length);
+                break;
+            }
+            case 'c':
+            {
+                size_t      length;
+                const char* str = decode(parseString(), m_string, length);
+                if (length != 1)
+                    throw ParseError("Expected string of one character");
+                packet.character(str[0]);
+                break;
+            }
+            case 'b':
+            {
+                size_t      length;
+                const char* str = decode(parseString(), m_string, length);
+                m_blob.resize(detail::base64DecodedSize(length));
+                const size_t size =
+                    detail::base64Decode(str, length, &m_blob[0]);
+                packet.blob(Blob(m_blob.data(), size));
+                break;
+            }
+            case 'T':
+                expectLiteral("true", 4);
+                packet.boolean(true);
+                break;
+            case 'F':
+                expectLiteral("false", 5);
+                packet.boolean(false);
+                break;
+            case 'N':
+                expectLiteral("null", 4);
+                packet.nil();
+                break;
+            case 'I':
+                expectLiteral("null", 4);
+                packet.infinitum();
+                break;
+            default:
+                throw ParseError("Invalid type tag");
+        }
+    }
+
+    // Count the type tags of an args array without type string.
+    size_t countTags(size_t depth)
+    {
+        if (depth > detail::kMaxDepth)
+            throw ParseError("JSON input nested too deeply");
+        expect('[');
+        if (peek() == ']')
+        {
+            m_pos++;
+            return 0;
+        }
+        size_t n = 0;
+        do
+        {
+            if (peek() == '[')
+                n += 2 + countTags(depth + 1);
+            else if (peek() == '{')
+                throw ParseError("Unexpected object in message arguments");
+            else
+            {
+                skipValue(depth + 1);
+                n++;
+            }
+        } while (next(']'));
+        return n;
+    }
+
+    // Parse an args array without type string, inferring the tags.
+    void parseArgs(Client::Packet& packet, size_t depth)
+    {
+        if (depth > detail::kMaxDepth)
+            throw ParseError("JSON input nested too deeply");
+        expect('[');
+        if (peek() == ']')
+        {
+            m_pos++;
+            return;
+        }
+        do
+        {
+            switch (peek())
+            {
+                case '"':
+                    parseTypedArg(packet, 's');
+                    break;
+                case '[':
+                    packet.openArray();
+                    parseArgs(packet, depth + 1);
+                    packet.closeArray();
+                    break;
+                case 't':
+                    parseTypedArg(packet, 'T');
+                    break;
+                case 'f':
+                    parseTypedArg(packet, 'F');
+                    break;
+                case 'n':
+                    parseTypedArg(packet, 'N');
+                    break;
+                default:
+                {
+                    const detail::Decimal n = parseNumber();
+                    const bool            exact = n.integer && n.exact;
+                    const uint64_t        sign = n.negative ? 1 : 0;
+                    if (exact && n.mantissa <= uint64_t(INT32_MAX) + sign)
+                        packet.int32(static_cast<int32_t>(
+                            detail::toInt64(n, INT32_MIN, INT32_MAX)));
+                    else if (exact && n.mantissa <= uint64_t(INT64_MAX) + sign)
+                        packet.int64(detail::toInt64(n, INT64_MIN, INT64_MAX));
+                    else
+                        packet.float32(detail::toFloat(n));
+                }
+            }
+        } while (next(']'));
+    }
+
+    const char* m_pos;
+    const char* m_end;
+    std::string m_address;
+    std::string m_types;
+    std::string m_string;
+    std::string m_blob;
+};
+
+//! Read a packet from JSON text with a temporary Reader.
+/*!
+ * \sa Reader::read
+ */
+inline size_t read(const char* text, size_t length, Client::Packet& packet)
+{
+    Reader reader;
+    return reader.read(text, length, packet);
+}
+
+}} // namespace OSCPP::Json
+
+#endif // OSCPP_JSON_HPP_INCLUDED
@@ -0,0 +1,644 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_LATENCY_HPP_INCLUDED
+#define OSCPP_LATENCY_HPP_INCLUDED
+
+#include <oscpp/server.hpp>
+#include <oscpp/symbol.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#    include <intrin.h>
+#    define OSCPP_HAVE_RDTSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#    include <x86intrin.h>
+#    define OSCPP_HAVE_RDTSC 1
+#endif
+
+namespace OSCPP {
+
+namespace detail {
+
+// Index of the most significant set bit; v must not be zero.
+inline unsigned log2Floor(uint64_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 63u - static_cast<unsigned>(__builtin_clzll(v));
+#else
+    unsigned r = 0;
+    while (v >>= 1)
+        r++;
+    return r;
+#endif
+}
+
+} // namespace detail
+
+//! Log-bucketed histogram of non-negative integer values.
+/*!
+ * Values below 16 get a bucket each. Larger values are grouped by
+ * their most significant bit and each power-of-two range is split into
+ * 16 linear sub-buckets, which bounds the relative error of a
+ * reported value to 1/16. Values of 2^48 and above are counted in the
+ * last bucket.
+ */
+class Histogram
+{
+public:
+    static const unsigned kSubBucketBits = 4;
+    static const size_t   kSubBuckets = size_t(1) << kSubBucketBits;
+    static const unsigned kMaxExponent = 47;
+    static const size_t   kNumBuckets =
+        (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+    Histogram()
+    : m_counts(kNumBuckets)
+    , m_total(0)
+    {}
+
+    //! Return the index of the bucket counting value.
+    static size_t bucketIndex(uint64_t value)
+    {
+        if (value < kSubBuckets)
+            return static_cast<size_t>(value);
+        const unsigned e = detail::log2Floor(value);
+        if (e > kMaxExponent)
+            return kNumBuckets - 1;
+        const size_t sub = static_cast<size_t>(value >> (e - kSubBucketBits));
+        return (e - kSubBucketBits) * kSubBuckets + sub;
+    }
+
+    //! Return the smallest value counted in a bucket.
+    static uint64_t bucketLow(size_t index)
+    {
+        const size_t group = index / kSubBuckets;
+        const size_t sub = index % kSubBuckets;
+        return group == 0 ? sub : (kSubBuckets + sub) << (group - 1);
+    }
+
+    //! Return the largest value counted in a bucket.
+    static uint64_t bucketHigh(size_t index)
+    {
+        return index + 1 == kNumBuckets ? UINT64_MAX
+                                        : bucketLow(index + 1) - 1;
+    }
+
+    //! Count a value n times.
+    void record(uint64_t value, uint64_t n = 1)
+    {
+        m_counts[bucketIndex(value)] += n;
+        m_total += n;
+    }
+
+    //! Add the counts of another histogram.
+    void merge(const Histogram& other)
+    {
+        for (size_t i = 0; i < kNumBuckets; i++)
+            m_counts[i] += other.m_counts[i];
+        m_total += other.m_total;
+    }
+
+    //! Return the number of recorded values.
+    uint64_t count() const
+    {
+        return m_total;
+    }
+
+    //! Return the number of values counted in a bucket.
+    uint64_t bucketCount(size_t index) const
+    {
+        return m_counts[index];
+    }
+
+    //! Return the largest value of the bucket containing the value at
+    //! quantile q (between 0 and 1), or zero if the histogram is empty.
+    uint64_t valueAtQuantile(double q) const
+    {
+        if (m_total == 0)
+            return 0;
+        q = std::min(std::max(q, 0.), 1.);
+        uint64_t rank = static_cast<uint64_t>(q * m_total + 0.5);
+        rank = std::max<uint64_t>(rank, 1);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kNumBuckets; i++)
+        {
+            seen += m_counts[i];
+            if (seen >= rank)
+                return bucketHigh(i);
+        }
+        return bucketHigh(kNumBuckets - 1);
+    }
+
+    //! Return the lower bound of the smallest recorded value.
+    uint64_t min() const
+    {
+        for (size_t i = 0; i < kNumBuckets; i++)
+            if (m_counts[i] > 0)
+                return bucketLow(i);
+        return 0;
+    }
+
+    //! Return the upper bound of the largest recorded value.
+    uint64_t max() const
+    {
+        for (size_t i = kNumBuckets; i > 0; i--)
+            if (m_counts[i - 1] > 0)
+                return bucketHigh(i - 1);
+        return 0;
+    }
+
+    //! Return the mean, computed from bucket midpoints.
+    double mean() const
+    {
+        if (m_total == 0)
+            return 0;
+        double sum = 0;
+        for (size_t i = 0; i + 1 < kNumBuckets; i++)
+        {
+            if (m_counts[i] > 0)
+                sum += m_counts[i] * 0.5 *
+                       (double(bucketLow(i)) + double(bucketHigh(i)));
+        }
+        sum += m_counts[kNumBuckets - 1] *
+               double(bucketLow(kNumBuckets - 1));
+        return sum / m_total;
+    }
+
+private:
+    std::vector<uint64_t> m_counts;
+    uint64_t              m_total;
+};
+
+//! Low overhead clock for timing handlers.
+/*!
+ * Reads the time stamp counter on x86, which is assumed to be invariant
+ * (constant rate and synchronized across cores, true for processors of
+ * the last decade), and std::chrono::steady_clock elsewhere. Tick
+ * durations are converted to nanoseconds and back with fixed point
+ * factors that are calibrated against steady_clock on first use.
+ */
+class LatencyClock
+{
+public:
+    static uint64_t now()
+    {
+#if defined(OSCPP_HAVE_RDTSC)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch())
+                .count());
+#endif
+    }
+
+    //! Return nanoseconds per tick as a 32.32 fixed point number.
+    static uint64_t nanosecondsPerTick()
+    {
+        static const uint64_t factor = calibrate();
+        return factor;
+    }
+
+    //! Return ticks per nanosecond as a 32.32 fixed point number.
+    static uint64_t ticksPerNanosecond()
+    {
+        static const uint64_t factor = static_cast<uint64_t>(
+            18446744073709551616. / double(nanosecondsPerTick()));
+        return factor;
+    }
+
+    //! Convert a tick duration using a factor from nanosecondsPerTick().
+    static uint64_t toNanoseconds(uint64_t ticks, uint64_t factor)
+    {
+        return scale(ticks, factor);
+    }
+
+    //! Convert a duration in nanoseconds to ticks using a factor from
+    //! ticksPerNanosecond().
+    static uint64_t toTicks(uint64_t nanos, uint64_t factor)
+    {
+        return scale(nanos, factor);
+    }
+
+private:
+    static uint64_t scale(uint64_t value, uint64_t factor)
+    {
+        return (value >> 32) * factor +
+               (((value & 0xFFFFFFFFu) * factor) >> 32);
+    }
+
+    static uint64_t calibrate()
+    {
+#if defined(OSCPP_HAVE_RDTSC)
+        typedef std::chrono::steady_clock Clock;
+        const Clock::time_point start = Clock::now();
+        const uint64_t          startTicks = now();
+        Clock::time_point       end;
+        do
+        {
+            end = Clock::now();
+        } while (end - start < std::chrono::milliseconds(2));
+        const uint64_t ticks = now() - startTicks;
+        const double   nanos =
+            std::chrono::duration<double, std::nano>(end - start).count();
+        return ticks == 0 ? uint64_t(1) << 32
+                          : static_cast<uint64_t>(nanos / ticks * 4294967296.);
+#else
+        return uint64_t(1) << 32;
+#endif
+    }
+};
+
+//! Latency histograms of all addresses at one point in time.
+class LatencySnapshot
+{
+public:
+    struct Entry
+    {
+        std::string address;
+        Histogram   histogram;
+    };
+
+    LatencySnapshot()
+    : m_dropped(0)
+    {}
+
+    //! Return the histograms in the order addresses were first seen.
+    const std::vector<Entry>& entries() const
+    {
+        return m_entries;
+    }
+
+    //! Return the histogram of an address, or nullptr if it wasn't seen.
+    const Histogram* find(const std::string& address) const
+    {
+        for (const Entry& e : m_entries)
+            if (e.address == address)
+                return &e.histogram;
+        return nullptr;
+    }
+
+    //! Return a histogram of all addresses combined.
+    Histogram total() const
+    {
+        Histogram h;
+        for (const Entry& e : m_entries)
+            h.merge(e.histogram);
+        return h;
+    }
+
+    //! Return the number of measurements that weren't recorded because
+    //! the address table was full.
+    uint64_t dropped() const
+    {
+        return m_dropped;
+    }
+
+    //! Add the histograms of another snapshot, matching addresses by
+    //! name.
+    void merge(const LatencySnapshot& other)
+    {
+        for (const Entry& e : other.m_entries)
+            add(e.address, e.histogram);
+        m_dropped += other.m_dropped;
+    }
+
+    //* Add a histogram for an address.
+    void add(const std::string& address, const Histogram& histogram)
+    {
+        for (Entry& e : m_entries)
+        {
+            if (e.address == address)
+            {
+                e.histogram.merge(histogram);
+                return;
+            }
+        }
+        m_entries.push_back(Entry{address, histogram});
+    }
+
+    //* Add to the number of dropped measurements.
+    void addDropped(uint64_t n)
+    {
+        m_dropped += n;
+    }
+
+private:
+    std::vector<Entry> m_entries;
+    uint64_t           m_dropped;
+};
+
+//! Per-address handler latency recording.
+/*!
+ * Each recording thread creates a LatencyRecorder::Local handle and
+ * times its handlers with it:
+ *
+ *     LatencyRecorder::Local local(recorder);
+ *     ...
+ *     local.time(msg, handler);
+ *
+ * or with lap() after each handler when dispatching a batch of
+ * messages, which halves the number of clock reads.
+ *
+ * Addresses are interned in a ConcurrentSymbolTable and every thread
+ * keeps its own bucket counters per address, which are updated with
+ * plain relaxed stores. Durations are counted in clock ticks and only
+ * converted to nanoseconds by snapshot(), which can be called from any
+ * thread and sums the counters without stopping the recording threads.
+ *
+ * The per-message cost is that of the clock reads (one with lap(), two
+ * with time()) plus an address lookup and a counter increment. On x86
+ * the clock is the time stamp counter, whose cost varies from a few
+ * nanoseconds on bare metal to tens of nanoseconds in some virtual
+ * machines; measure with `oscpp_bench --filter latency`.
+ *
+ * Counter blocks of destroyed handles are reused by new handles. Handles
+ * must not outlive the recorder.
+ */
+class LatencyRecorder
+{
+    struct Buckets
+    {
+        std::atomic<uint64_t> counts[Histogram::kNumBuckets];
+    };
+
+    // Counters owned by a single Local handle.
+    struct ThreadBlock
+    {
+        ThreadBlock(size_t maxAddresses)
+        : histograms(new std::atomic<Buckets*>[maxAddresses])
+        , dropped(0)
+        , next(nullptr)
+        , inUse(true)
+        {
+            for (size_t i = 0; i < maxAddresses; i++)
+                histograms[i].store(nullptr, std::memory_order_relaxed);
+        }
+
+        std::unique_ptr<std::atomic<Buckets*>[]> histograms;
+        std::atomic<uint64_t>                    dropped;
+        ThreadBlock*                             next;
+        std::atomic<bool>                        inUse;
+        // Keep blocks of different threads off each other's cache lines.
+        char padding[64];
+    };
+
+public:
+    //! Constructor.
+    /*!
+     * At most maxAddresses distinct addresses are recorded; measurements
+     * of further addresses are counted as dropped.
+     */
+    explicit LatencyRecorder(size_t maxAddresses = 1024)
+    : m_addresses(maxAddresses)
+    , m_head(nullptr)
+    , m_factor(LatencyClock::nanosecondsPerTick())
+    , m_inverse(LatencyClock::ticksPerNanosecond())
+    {}
+
+    ~LatencyRecorder()
+    {
+        ThreadBlock* b = m_head.load(std::memory_order_acquire);
+        while (b != nullptr)
+        {
+            for (size_t i = 0; i < m_addresses.capacity(); i++)
+                delete b->histograms[i].load(std::memory_order_relaxed);
+            ThreadBlock* next = b->next;
+            delete b;
+            b = next;
+        }
+    }
+
+    LatencyRecorder(const LatencyRecorder&) = delete;
+    LatencyRecorder& operator=(const LatencyRecorder&) = delete;
+
+    //! Recording handle for a single thread.
+    class Local
+    {
+    public:
+        explicit Local(LatencyRecorder& recorder)
+        : m_recorder(recorder)
+        , m_block(recorder.acquire())
+        , m_inverse(recorder.m_inverse)
+        , m_last(0)
+        {}
+
+        ~Local()
+        {
+            m_block->inUse.store(false, std::memory_order_release);
+        }
+
+        Local(const Local&) = delete;
+        Local& operator=(const Local&) = delete;
+
+        //! Record a duration in nanoseconds for a message address.
+        void record(const Server::Message& msg, uint64_t nanos)
+        {
+            recordTicks(msg, LatencyClock::toTicks(nanos, m_inverse));
+        }
+
+        //! Record a duration in LatencyClock ticks for a message address.
+        void recordTicks(const Server::Message& msg, uint64_t ticks)
+        {
+            Symbol symbol = m_recorder.m_addresses.lookup(
+                msg.address(), msg.addressLength());
+            if (symbol == kNoSymbol)
+            {
+                symbol = m_recorder.intern(msg.address(), msg.addressLength());
+                if (symbol == kNoSymbol)
+                {
+                    increment(m_block->dropped);
+                    return;
+                }
+            }
+            Buckets* buckets =
+                m_block->histograms[symbol].load(std::memory_order_relaxed);
+            if (buckets == nullptr)
+                buckets = allocate(symbol);
+            increment(buckets->counts[Histogram::bucketIndex(ticks)]);
+        }
+
+        //! Call handler(msg) and record its duration.
+        /*!
+         * Nothing is recorded if the handler throws.
+         */
+        template <typename Handler>
+        void time(const Server::Message& msg, Handler&& handler)
+        {
+            const uint64_t start = LatencyClock::now();
+            handler(msg);
+            recordTicks(msg, LatencyClock::now() - start);
+        }
+
+        //! Start timing a sequence of handlers.
+        void start()
+        {
+            m_last = LatencyClock::now();
+        }
+
+        //! Record the time since the previous call to start() or lap().
+        /*!
+         * When handlers are called back to back, calling lap() after
+         * each of them needs a single clock read per message instead of
+         * the two needed by time(); the recorded durations then include
+         * the dispatch overhead between handlers.
+         */
+        void lap(const Server::Message& msg)
+        {
+            const uint64_t now = LatencyClock::now();
+            recordTicks(msg, now - m_last);
+            m_last = now;
+        }
+
+    private:
+        // Only the owning thread writes, so no read-modify-write is needed.
+        static void increment(std::atomic<uint64_t>& counter)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+        }
+
+        Buckets* allocate(Symbol symbol)
+        {
+            Buckets* buckets = new Buckets;
+            for (size_t i = 0; i < Histogram::kNumBuckets; i++)
+                buckets->counts[i].store(0, std::memory_order_relaxed);
+            m_block->histograms[symbol].store(buckets,
+                                              std::memory_order_release);
+            return buckets;
+        }
+
+        LatencyRecorder& m_recorder;
+        ThreadBlock*     m_block;
+        uint64_t         m_inverse;
+        uint64_t         m_last;
+    };
+
+    //! Return the number of distinct addresses recorded so far.
+    size_t numAddresses() const
+    {
+        return m_addresses.size();
+    }
+
+    //! Sum the histograms of all threads.
+    LatencySnapshot snapshot() const
+    {
+        LatencySnapshot result;
+        const size_t    numAddresses = m_addresses.size();
+        std::vector<Histogram> histograms(numAddresses);
+        for (const ThreadBlock* b = m_head.load(std::memory_order_acquire);
+             b != nullptr; b = b->next)
+        {
+            for (size_t a = 0; a < numAddresses; a++)
+            {
+                const Buckets* buckets =
+                    b->histograms[a].load(std::memory_order_acquire);
+                if (buckets == nullptr)
+                    continue;
+                for (size_t i = 0; i < Histogram::kNumBuckets; i++)
+                {
+                    const uint64_t n =
+                        buckets->counts[i].load(std::memory_order_relaxed);
+                    if (n > 0)
+                        histograms[a].record(toNanoseconds(i), n);
+                }
+            }
+            result.addDropped(b->dropped.load(std::memory_order_relaxed));
+        }
+        for (size_t a = 0; a < numAddresses; a++)
+        {
+            result.add(std::string(m_addresses.name(static_cast<Symbol>(a)),
+                                   m_addresses.length(static_cast<Symbol>(a))),
+                       histograms[a]);
+        }
+        return result;
+    }
+
+private:
+    // Convert a tick bucket to nanoseconds by its midpoint.
+    uint64_t toNanoseconds(size_t bucket) const
+    {
+        const uint64_t low = Histogram::bucketLow(bucket);
+        const uint64_t ticks = bucket + 1 == Histogram::kNumBuckets
+                                   ? low
+                                   : low + (Histogram::bucketHigh(bucket) -
+                                            low) / 2;
+        return LatencyClock::toNanoseconds(ticks, m_factor);
+    }
+
+    ThreadBlock* acquire()
+    {
+        for (ThreadBlock* b = m_head.load(std::memory_order_acquire);
+             b != nullptr; b = b->next)
+        {
+            bool expected = false;
+            if (b->inUse.compare_exchange_strong(expected, true,
+                                                 std::memory_order_acquire))
+                return b;
+        }
+        ThreadBlock* block = new ThreadBlock(m_addresses.capacity());
+        ThreadBlock* next = m_head.load(std::memory_order_relaxed);
+        do
+        {
+            block->next = next;
+        } while (!m_head.compare_exchange_weak(next, block,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed));
+        return block;
+    }
+
+    // Return kNoSymbol if the address table is full.
+    Symbol intern(const char* address, size_t length)
+    {
+        if (m_addresses.size() == m_addresses.capacity())
+            return m_addresses.lookup(address, length);
+        try
+        {
+            return m_addresses.intern(address, length);
+        }
+        catch (std::length_error&)
+        {
+            return m_addresses.lookup(address, length);
+        }
+    }
+
+    ConcurrentSymbolTable     m_addresses;
+    std::atomic<ThreadBlock*> m_head;
+    uint64_t                  m_factor;
+    uint64_t                  m_inverse;
+};
+
+} // namespace OSCPP
+
+#endif // OSCPP_LATENCY_HPP_INCLUDED
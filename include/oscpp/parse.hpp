@@ -0,0 +1,510 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_PARSE_HPP_INCLUDED
+#define OSCPP_PARSE_HPP_INCLUDED
+
+#include <oscpp/client.hpp>
+#include <oscpp/detail/number.hpp>
+#include <oscpp/error.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+
+//! \file
+//! Building packets from their compact text form.
+/*!
+ * Reads the single line form written by OSCPP::format(), e.g.
+ *
+ *     /n_set i:1 s:wobble f:31
+ *     # 1 [ /synth/1 s:sine f:440 [ i:1 i:2 ] /synth/2 T ]
+ *
+ * Tokens may be separated by any white space, so the multi-line output
+ * of the ostream operators in oscpp/print.hpp is accepted too, as long
+ * as it contains no blobs and no strings that would need quoting.
+ */
+
+namespace OSCPP {
+
+//! Text to packet conversion.
+/*!
+ * Parses text with a single scan per message and writes the packet
+ * directly to a Client::Packet. Since the number of type tags must be
+ * known when a message is opened, the argument tokens of a message are
+ * counted with a quick look ahead first. Unquoted strings are copied
+ * straight from the text; quoted strings with escapes and blobs are
+ * decoded into scratch buffers that are reused across calls, so that a
+ * parser doesn't allocate memory in steady state.
+ */
+class TextParser
+{
+public:
+    //! Maximum nesting depth of bundles and arrays.
+    static const size_t kMaxDepth = 64;
+
+    TextParser()
+    : m_pos(nullptr)
+    , m_end(nullptr)
+    {}
+
+    //! Parse a packet from text.
+    /*!
+     * Parses a single packet from the start of text, surrounded by
+     * optional white space, and returns the number of characters
+     * consumed, so that a sequence of packets can be read by repeated
+     * calls.
+     *
+     * \throw OSCPP::ParseError invalid text.
+     * \throw OSCPP::OverflowError packet buffer too small.
+     */
+    size_t parse(const char* text, size_t length, Client::Packet& packet)
+    {
+        m_pos = text;
+        m_end = text + length;
+        skipSpace();
+        parsePacket(packet, 0);
+        skipSpace();
+        return static_cast<size_t>(m_pos - text);
+    }
+
+private:
+    static bool isSpace(char c)
+    {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    // Characters that end an unquoted token.
+    static bool isDelimiter(char c)
+    {
+        return isSpace(c) || c == ']';
+    }
+
+    // Characters that start a packet.
+    static bool isPacketStart(char c)
+    {
+        return c == '/' || c == '"' || c == '#';
+    }
+
+    void skipSpace()
+    {
+        while (m_pos != m_end && isSpace(*m_pos))
+            m_pos++;
+    }
+
+    bool atDelimiter() const
+    {
+        return m_pos == m_end || isDelimiter(*m_pos);
+    }
+
+    void expectDelimiter()
+    {
+        if (!atDelimiter())
+            throw ParseError("Expected white space after token");
+    }
+
+    // Match a keyword followed by a delimiter.
+    bool match(const char* keyword, size_t length)
+    {
+        if (static_cast<size_t>(m_end - m_pos) < length ||
+            std::memcmp(m_pos, keyword, length) != 0 ||
+            (m_pos + length != m_end && !isDelimiter(m_pos[length])))
+            return false;
+        m_pos += length;
+        return true;
+    }
+
+    static int hexValue(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    // Skip a quoted string starting at p and return the position after
+    // the closing quote.
+    const char* skipQuoted(const char* p) const
+    {
+        for (p++; p != m_end; p++)
+        {
+            if (*p == '"')
+                return p + 1;
+            if (*p == '\\' && ++p == m_end)
+                break;
+        }
+        throw ParseError("Unterminated string");
+    }
+
+    // Parse a quoted or unquoted string. Returns a pointer into the text
+    // unless the string contains escapes, which are decoded into
+    // scratch.
+    const char* parseString(std::string& scratch, size_t& length)
+    {
+        if (m_pos == m_end || *m_pos != '"')
+        {
+            const char* begin = m_pos;
+            while (!atDelimiter())
+                m_pos++;
+            length = static_cast<size_t>(m_pos - begin);
+            return begin;
+        }
+        const char* begin = ++m_pos;
+        while (m_pos != m_end && *m_pos != '"' && *m_pos != '\\')
+            m_pos++;
+        if (m_pos != m_end && *m_pos == '"')
+        {
+            length = static_cast<size_t>(m_pos++ - begin);
+            return begin;
+        }
+        scratch.assign(begin, m_pos);
+        for (;;)
+        {
+            if (m_pos == m_end)
+                throw ParseError("Unterminated string");
+            const char c = *m_pos++;
+            if (c == '"')
+                break;
+            if (c != '\\')
+            {
+                scratch += c;
+                continue;
+            }
+            if (m_pos == m_end)
+                throw ParseError("Unterminated string");
+            const char e = *m_pos++;
+            switch (e)
+            {
+                case 'n':
+                    scratch += '\n';
+                    break;
+                case 'r':
+                    scratch += '\r';
+                    break;
+                case 't':
+                    scratch += '\t';
+                    break;
+                case 'x':
+                {
+                    const int hi = m_end - m_pos >= 2 ? hexValue(m_pos[0]) : -1;
+                    const int lo = hi >= 0 ? hexValue(m_pos[1]) : -1;
+                    if (lo < 0)
+                        throw ParseError("Invalid \\x escape in string");
+                    scratch += static_cast<char>((hi << 4) | lo);
+                    m_pos += 2;
+                    break;
+                }
+                default:
+                    scratch += e;
+            }
+        }
+        length = scratch.size();
+        return scratch.data();
+    }
+
+    // Parse a string that becomes a NUL-terminated OSC string.
+    const char* parseOscString(std::string& scratch, size_t& length)
+    {
+        const char* str = parseString(scratch, length);
+        if (std::memchr(str, '\0', length) != nullptr)
+            throw ParseError("NUL character in string");
+        return str;
+    }
+
+    uint32_t parseHex32()
+    {
+        uint32_t x = 0;
+        size_t   n = 0;
+        for (; !atDelimiter(); n++)
+        {
+            const int d = hexValue(*m_pos++);
+            if (d < 0 || n == 8)
+                throw ParseError("Invalid hexadecimal number");
+            x = (x << 4) | static_cast<uint32_t>(d);
+        }
+        if (n == 0)
+            throw ParseError("Invalid hexadecimal number");
+        return x;
+    }
+
+    void parseBlob(Client::Packet& packet)
+    {
+        const char* begin = m_pos;
+        while (!atDelimiter())
+            m_pos++;
+        const size_t length = static_cast<size_t>(m_pos - begin);
+        if (length % 2 != 0)
+            throw ParseError("Odd number of digits in blob");
+        m_blob.resize(length / 2);
+        for (size_t i = 0; i < length / 2; i++)
+        {
+            const int hi = hexValue(begin[2 * i]);
+            const int lo = hexValue(begin[2 * i + 1]);
+            if ((hi | lo) < 0)
+                throw ParseError("Invalid digit in blob");
+            m_blob[i] = static_cast<char>((hi << 4) | lo);
+        }
+        packet.blob(Blob(m_blob.data(), m_blob.size()));
+    }
+
+    detail::Decimal parseNumber()
+    {
+        const detail::Decimal n = detail::parseDecimal(m_pos, m_end);
+        expectDelimiter();
+        return n;
+    }
+
+    template <typename F>
+    F parseReal(F (*convert)(const detail::Decimal&))
+    {
+        if (match("nan", 3))
+            return std::numeric_limits<F>::quiet_NaN();
+        if (match("inf", 3))
+            return std::numeric_limits<F>::infinity();
+        if (match("-inf", 4))
+            return -std::numeric_limits<F>::infinity();
+        return convert(parseNumber());
+    }
+
+    void parsePacket(Client::Packet& packet, size_t depth)
+    {
+        if (depth > kMaxDepth)
+            throw ParseError("Text nested too deeply");
+        if (m_pos == m_end || !isPacketStart(*m_pos))
+            throw ParseError("Expected message or bundle");
+        if (*m_pos == '#')
+            parseBundle(packet, depth);
+        else
+            parseMessage(packet, depth);
+    }
+
+    void parseBundle(Client::Packet& packet, size_t depth)
+    {
+        m_pos++;
+        skipSpace();
+        const uint64_t time = detail::toUInt64(parseNumber(), UINT64_MAX);
+        skipSpace();
+        if (m_pos == m_end || *m_pos != '[')
+            throw ParseError("Expected '[' after bundle time");
+        m_pos++;
+        packet.openBundle(time);
+        for (;;)
+        {
+            skipSpace();
+            if (m_pos == m_end)
+                throw ParseError("Unterminated bundle");
+            if (*m_pos == ']')
+                break;
+            parsePacket(packet, depth + 1);
+        }
+        m_pos++;
+        packet.closeBundle();
+    }
+
+    void parseMessage(Client::Packet& packet, size_t depth)
+    {
+        size_t      addressLength;
+        const char* address = parseOscString(m_address, addressLength);
+        expectDelimiter();
+        packet.openMessage(address, addressLength, countTags());
+        parseArgs(packet, depth + 1, false);
+        packet.closeMessage();
+    }
+
+    // Count the type tags of the message arguments that follow.
+    size_t countTags() const
+    {
+        const char* p = m_pos;
+        size_t      n = 0;
+        size_t      depth = 0;
+        for (;;)
+        {
+            while (p != m_end && isSpace(*p))
+                p++;
+            if (p == m_end || (depth == 0 && isPacketStart(*p)))
+                break;
+            if (*p == ']')
+            {
+                if (depth == 0)
+                    break;
+                depth--;
+                n++;
+                p++;
+                continue;
+            }
+            n++;
+            if (*p == '[')
+            {
+                depth++;
+                p++;
+                continue;
+            }
+            if (m_end - p > 2 && p[1] == ':' && p[2] == '"')
+                p = skipQuoted(p + 2);
+            while (p != m_end && !isDelimiter(*p))
+                p++;
+        }
+        return n;
+    }
+
+    // Parse arguments up to the end of the message or, inside an array,
+    // up to and including the closing bracket.
+    void parseArgs(Client::Packet& packet, size_t depth, bool inArray)
+    {
+        if (depth > kMaxDepth)
+            throw ParseError("Text nested too deeply");
+        for (;;)
+        {
+            skipSpace();
+            if (m_pos == m_end)
+            {
+                if (inArray)
+                    throw ParseError("Unterminated array");
+                return;
+            }
+            const char c = *m_pos;
+            if (c == ']')
+            {
+                if (inArray)
+                    m_pos++;
+                return;
+            }
+            if (!inArray && isPacketStart(c))
+                return;
+            if (c == '[')
+            {
+                m_pos++;
+                packet.openArray();
+                parseArgs(packet, depth + 1, true);
+                packet.closeArray();
+                continue;
+            }
+            parseArg(packet);
+        }
+    }
+
+    void parseArg(Client::Packet& packet)
+    {
+        const char t = *m_pos;
+        if (m_end - m_pos == 1 || isDelimiter(m_pos[1]))
+        {
+            m_pos++;
+            switch (t)
+            {
+                case 'T':
+                    packet.boolean(true);
+                    return;
+                case 'F':
+                    packet.boolean(false);
+                    return;
+                case 'N':
+                    packet.nil();
+                    return;
+                case 'I':
+                    packet.infinitum();
+                    return;
+            }
+            throw ParseError("Invalid argument");
+        }
+        if (m_pos[1] != ':')
+            throw ParseError("Invalid argument");
+        m_pos += 2;
+        switch (t)
+        {
+            case 'i':
+                packet.int32(static_cast<int32_t>(
+                    detail::toInt64(parseNumber(), INT32_MIN, INT32_MAX)));
+                break;
+            case 'h':
+                packet.int64(
+                    detail::toInt64(parseNumber(), INT64_MIN, INT64_MAX));
+                break;
+            case 't':
+                packet.timeTag(detail::toUInt64(parseNumber(), UINT64_MAX));
+                break;
+            case 'f':
+                packet.float32(parseReal<float>(detail::toFloat));
+                break;
+            case 'd':
+                packet.float64(parseReal<double>(detail::toDouble));
+                break;
+            case 's':
+            case 'S':
+            {
+                size_t      length;
+                const char* str = parseOscString(m_string, length);
+                if (t == 's')
+                    packet.string(str, length);
+                else
+                    packet.symbol(str, length);
+                break;
+            }
+            case 'c':
+            {
+                size_t      length;
+                const char* str = parseString(m_string, length);
+                if (length != 1)
+                    throw ParseError("Expected string of one character");
+                packet.character(str[0]);
+                break;
+            }
+            case 'b':
+                parseBlob(packet);
+                break;
+            case 'r':
+                packet.rgba(Rgba(parseHex32()));
+                break;
+            case 'm':
+                packet.midi(Midi(parseHex32()));
+                break;
+            default:
+                throw ParseError("Invalid type tag");
+        }
+        expectDelimiter();
+    }
+
+    const char* m_pos;
+    const char* m_end;
+    std::string m_address;
+    std::string m_string;
+    std::string m_blob;
+};
+
+//! Parse a packet from text with a temporary TextParser.
+/*!
+ * \sa TextParser::parse
+ */
+inline size_t parse(const char* text, size_t length, Client::Packet& packet)
+{
+    TextParser parser;
+    return parser.parse(text, length, packet);
+}
+
+} // namespace OSCPP
+
+#endif // OSCPP_PARSE_HPP_INCLUDED
@@ -0,0 +1,741 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_PCAP_HPP_INCLUDED
+#define OSCPP_PCAP_HPP_INCLUDED
+
+#include <oscpp/client.hpp>
+#include <oscpp/detail/host.hpp>
+#include <oscpp/detail/mmap.hpp>
+#include <oscpp/error.hpp>
+#include <oscpp/server.hpp>
+#include <oscpp/util.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+//! \file
+//! Reading and writing OSC over UDP packet captures.
+/*!
+ * Pcap::Reader extracts UDP payloads from classic pcap and pcapng files
+ * in either byte order. Supported link types are Ethernet (with VLAN
+ * tags), Linux cooked capture (SLL and SLL2), raw IPv4/IPv6 and BSD
+ * loopback; IP fragments are skipped. A capture that ends with a
+ * partial record or block is reported as a parse error when the reader
+ * reaches it. Pcap::Writer writes classic pcap files with synthesized
+ * Ethernet, IPv4 and UDP headers.
+ */
+
+namespace OSCPP { namespace Pcap {
+
+//! Link layer header types.
+enum LinkType
+{
+    kLinkNull = 0,
+    kLinkEthernet = 1,
+    //! DLT_RAW as written by most BSDs instead of kLinkRaw.
+    kLinkRawBsd = 12,
+    //! DLT_RAW as written by OpenBSD instead of kLinkRaw.
+    kLinkRawOpenBsd = 14,
+    kLinkRaw = 101,
+    kLinkLoop = 108,
+    kLinkLinuxSll = 113,
+    kLinkIPv4 = 228,
+    kLinkIPv6 = 229,
+    kLinkLinuxSll2 = 276
+};
+
+namespace detail {
+
+inline uint16_t loadBE16(const char* p)
+{
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<uint16_t>((u[0] << 8) | u[1]);
+}
+
+inline uint16_t load16(const char* p, bool swap)
+{
+    uint16_t x;
+    std::memcpy(&x, p, 2);
+    return swap ? static_cast<uint16_t>((x >> 8) | (x << 8)) : x;
+}
+
+inline uint32_t load32(const char* p, bool swap)
+{
+    uint32_t x;
+    std::memcpy(&x, p, 4);
+    return swap ? bswap32(x) : x;
+}
+
+inline void storeBE16(char* p, uint16_t x)
+{
+    p[0] = static_cast<char>(x >> 8);
+    p[1] = static_cast<char>(x);
+}
+
+inline void storeBE32(char* p, uint32_t x)
+{
+    storeBE16(p, static_cast<uint16_t>(x >> 16));
+    storeBE16(p + 2, static_cast<uint16_t>(x));
+}
+
+// Convert a timestamp in units of 1/unitsPerSecond seconds.
+inline uint64_t toNanoseconds(uint64_t ts, uint64_t unitsPerSecond)
+{
+    if (unitsPerSecond == 1000000000)
+        return ts;
+    const uint64_t secs = ts / unitsPerSecond;
+    const uint64_t frac = ts % unitsPerSecond;
+    const uint64_t nanos =
+        unitsPerSecond <= 1000000000
+            ? frac * 1000000000 / unitsPerSecond
+            : static_cast<uint64_t>(double(frac) * 1e9 / unitsPerSecond);
+    return secs * 1000000000 + nanos;
+}
+
+} // namespace detail
+
+//! A UDP datagram extracted from a capture.
+struct Datagram
+{
+    //! Capture time in nanoseconds since the Unix epoch.
+    uint64_t time;
+    //! IP version, 4 or 6.
+    int ipVersion;
+    //! Source and destination addresses, 4 or 16 bytes in network byte
+    //! order, pointing into the capture.
+    const unsigned char* srcAddress;
+    const unsigned char* dstAddress;
+    uint16_t             srcPort;
+    uint16_t             dstPort;
+    //! UDP payload.
+    Server::Packet packet;
+};
+
+//! Capture file contents in memory.
+struct Buffer
+{
+    const void* data;
+    size_t      size;
+};
+
+//! Capture reader counters.
+struct ReaderStats
+{
+    uint64_t frames = 0;    //!< Captured frames seen
+    uint64_t datagrams = 0; //!< UDP datagrams returned
+    uint64_t skipped = 0;   //!< Frames that aren't UDP or don't match
+    uint64_t fragments = 0; //!< IP fragments skipped
+    uint64_t truncated = 0; //!< Datagrams cut off by the snapshot length
+    uint64_t copied = 0;    //!< Unaligned payloads copied
+};
+
+//! Memory mapped capture file reader.
+/*!
+ * Payloads that are 4-byte aligned in the capture are returned as
+ * Server::Packet views without copying. Payloads of Ethernet frames
+ * usually start at an offset of 2 modulo 4, which the server parser
+ * doesn't accept; these are copied into a buffer that is reused by
+ * each call to next(), so a packet of a datagram is only valid until
+ * the next call when ReaderStats::copied is incremented.
+ */
+class Reader
+{
+public:
+    //! Map a capture file.
+    /*!
+     * Only datagrams with a source or destination port contained in
+     * ports are returned, or all datagrams if ports is empty.
+     *
+     * \throw std::system_error the file couldn't be mapped.
+     * \throw OSCPP::ParseError not a pcap or pcapng file, or malformed
+     * before the first matching datagram.
+     */
+    explicit Reader(const std::string& path,
+                    std::vector<uint16_t> ports = std::vector<uint16_t>())
+    : m_file(path)
+    , m_data(m_file.data())
+    , m_size(m_file.size())
+    , m_ports(std::move(ports))
+    {
+        init();
+    }
+
+    //! Read a capture from memory, which must outlive the reader.
+    explicit Reader(const Buffer&         buffer,
+                    std::vector<uint16_t> ports = std::vector<uint16_t>())
+    : m_data(static_cast<const char*>(buffer.data))
+    , m_size(buffer.size)
+    , m_ports(std::move(ports))
+    {
+        init();
+    }
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    //! Return true if no more matching datagrams are left.
+    bool atEnd() const
+    {
+        return m_current.payload == nullptr;
+    }
+
+    //! Return the next matching datagram.
+    /*!
+     * \throw OSCPP::UnderrunError no datagrams left.
+     * \throw OSCPP::ParseError malformed capture file.
+     */
+    Datagram next()
+    {
+        if (atEnd())
+            throw UnderrunError();
+        Datagram d;
+        d.time = m_current.time;
+        d.ipVersion = m_current.ipVersion;
+        d.srcAddress = m_current.srcAddress;
+        d.dstAddress = m_current.dstAddress;
+        d.srcPort = m_current.srcPort;
+        d.dstPort = m_current.dstPort;
+        const char*  payload = m_current.payload;
+        const size_t size = m_current.size;
+        if (!isAligned(payload, kAlignment))
+        {
+            m_scratch.resize((size + 3) / 4);
+            if (size > 0)
+                std::memcpy(m_scratch.data(), payload, size);
+            payload = reinterpret_cast<const char*>(m_scratch.data());
+            m_stats.copied++;
+        }
+        d.packet = Server::Packet(payload, size);
+        m_stats.datagrams++;
+        findNext();
+        return d;
+    }
+
+    const ReaderStats& stats() const
+    {
+        return m_stats;
+    }
+
+private:
+    struct Interface
+    {
+        int      linkType;
+        uint64_t unitsPerSecond;
+    };
+
+    struct Found
+    {
+        const char*          payload = nullptr;
+        size_t               size = 0;
+        uint64_t             time = 0;
+        int                  ipVersion = 0;
+        const unsigned char* srcAddress = nullptr;
+        const unsigned char* dstAddress = nullptr;
+        uint16_t             srcPort = 0;
+        uint16_t             dstPort = 0;
+    };
+
+    static const uint32_t kPcapMagicMicros = 0xA1B2C3D4;
+    static const uint32_t kPcapMagicNanos = 0xA1B23C4D;
+    static const uint32_t kSectionHeaderBlock = 0x0A0D0D0A;
+    static const uint32_t kByteOrderMagic = 0x1A2B3C4D;
+
+    void init()
+    {
+        if (m_size < 4)
+            throw ParseError("Not a capture file");
+        const uint32_t magic = detail::load32(m_data, false);
+        if (magic == kSectionHeaderBlock)
+        {
+            m_pcapng = true;
+            m_pos = 0;
+        }
+        else
+        {
+            m_pcapng = false;
+            if (m_size < 24)
+                throw ParseError("Truncated pcap header");
+            if (magic == kPcapMagicMicros || magic == kPcapMagicNanos)
+                m_swap = false;
+            else if (bswap32(magic) == kPcapMagicMicros ||
+                     bswap32(magic) == kPcapMagicNanos)
+                m_swap = true;
+            else
+                throw ParseError("Not a capture file");
+            const uint32_t m = m_swap ? bswap32(magic) : magic;
+            m_interfaces.push_back(
+                Interface{static_cast<int>(detail::load32(m_data + 20, m_swap) &
+                                           0xFFFF),
+                          m == kPcapMagicNanos ? 1000000000u : 1000000u});
+            m_pos = 24;
+        }
+        findNext();
+    }
+
+    // Advance to the next matching datagram, or set m_current.payload to
+    // nullptr at the end of the capture.
+    void findNext()
+    {
+        m_current = Found();
+        while (m_pos < m_size)
+        {
+            if (m_pcapng ? nextBlock() : nextRecord())
+                return;
+        }
+    }
+
+    bool nextRecord()
+    {
+        if (m_size - m_pos < 16)
+            throw ParseError("Truncated pcap record header");
+        const char*    h = m_data + m_pos;
+        const uint32_t secs = detail::load32(h, m_swap);
+        const uint32_t frac = detail::load32(h + 4, m_swap);
+        const uint32_t length = detail::load32(h + 8, m_swap);
+        if (length > m_size - m_pos - 16)
+            throw ParseError("Truncated pcap record");
+        m_pos += 16 + length;
+        const Interface& iface = m_interfaces[0];
+        const uint64_t   time =
+            uint64_t(secs) * 1000000000u +
+            uint64_t(frac) * (1000000000u / iface.unitsPerSecond);
+        return frame(h + 16, length, iface.linkType, time);
+    }
+
+    bool nextBlock()
+    {
+        if (m_size - m_pos < 12)
+            throw ParseError("Truncated pcapng block header");
+        const char*    b = m_data + m_pos;
+        const uint32_t type = detail::load32(b, m_swap);
+        if (type == kSectionHeaderBlock)
+        {
+            const uint32_t bom = detail::load32(b + 8, false);
+            if (bom == kByteOrderMagic)
+                m_swap = false;
+            else if (bswap32(bom) == kByteOrderMagic)
+                m_swap = true;
+            else
+                throw ParseError("Invalid pcapng byte order magic");
+            m_interfaces.clear();
+        }
+        const uint32_t length = detail::load32(b + 4, m_swap);
+        if (length < 12 || !isAligned(length))
+            throw ParseError("Invalid pcapng block length");
+        if (length > m_size - m_pos)
+            throw ParseError("Truncated pcapng block");
+        m_pos += length;
+        const char*  body = b + 8;
+        const size_t bodySize = length - 12;
+
+        if (type == 1 && bodySize >= 8)
+        {
+            // Interface description block
+            Interface iface{detail::load16(body, m_swap), 1000000};
+            parseInterfaceOptions(body + 8, bodySize - 8, iface);
+            m_interfaces.push_back(iface);
+        }
+        else if (type == 6 && bodySize >= 20)
+        {
+            // Enhanced packet block
+            const uint32_t id = detail::load32(body, m_swap);
+            const uint64_t ts =
+                (uint64_t(detail::load32(body + 4, m_swap)) << 32) |
+                detail::load32(body + 8, m_swap);
+            const uint32_t captured = detail::load32(body + 12, m_swap);
+            if (id >= m_interfaces.size() || captured > bodySize - 20)
+                throw ParseError("Invalid pcapng enhanced packet block");
+            const Interface& iface = m_interfaces[id];
+            return frame(body + 20, captured, iface.linkType,
+                         detail::toNanoseconds(ts, iface.unitsPerSecond));
+        }
+        else if (type == 3 && bodySize >= 4 && !m_interfaces.empty())
+        {
+            // Simple packet block, no timestamp
+            const uint32_t original = detail::load32(body, m_swap);
+            return frame(body + 4, std::min<size_t>(original, bodySize - 4),
+                         m_interfaces[0].linkType, 0);
+        }
+        return false;
+    }
+
+    void parseInterfaceOptions(const char* p, size_t size, Interface& iface)
+    {
+        while (size >= 4)
+        {
+            const uint16_t code = detail::load16(p, m_swap);
+            const uint16_t length = detail::load16(p + 2, m_swap);
+            if (code == 0 || align(length) > size - 4)
+                break;
+            if (code == 9 && length >= 1)
+            {
+                // if_tsresol
+                const unsigned char v = static_cast<unsigned char>(p[4]);
+                const unsigned      e = v & 0x7F;
+                uint64_t            units = 1;
+                if (v & 0x80)
+                    units = e < 64 ? uint64_t(1) << e : 0;
+                else
+                    for (unsigned i = 0; i < e && i < 19; i++)
+                        units *= 10;
+                if (units > 0)
+                    iface.unitsPerSecond = units;
+            }
+            p += 4 + align(length);
+            size -= 4 + align(length);
+        }
+    }
+
+    // Decode a captured frame and return true if it's a matching UDP
+    // datagram.
+    bool frame(const char* p, size_t length, int linkType, uint64_t time)
+    {
+        m_stats.frames++;
+        int ipVersion = 0;
+        switch (linkType)
+        {
+            case kLinkEthernet:
+            {
+                if (length < 14)
+                    break;
+                size_t   offset = 12;
+                uint16_t etherType = detail::loadBE16(p + offset);
+                while ((etherType == 0x8100 || etherType == 0x88A8 ||
+                        etherType == 0x9100) &&
+                       length >= offset + 6)
+                {
+                    offset += 4;
+                    etherType = detail::loadBE16(p + offset);
+                }
+                offset += 2;
+                ipVersion = etherType == 0x0800 ? 4
+                                                : (etherType == 0x86DD ? 6 : 0);
+                p += offset;
+                length -= offset;
+                break;
+            }
+            case kLinkLinuxSll:
+            case kLinkLinuxSll2:
+            {
+                const size_t header = linkType == kLinkLinuxSll ? 16 : 20;
+                if (length < header)
+                    break;
+                const uint16_t protocol = detail::loadBE16(
+                    p + (linkType == kLinkLinuxSll ? 14 : 0));
+                ipVersion = protocol == 0x0800 ? 4
+                                               : (protocol == 0x86DD ? 6 : 0);
+                p += header;
+                length -= header;
+                break;
+            }
+            case kLinkNull:
+            case kLinkLoop:
+            {
+                if (length < 4)
+                    break;
+                // Address family in either byte order
+                uint32_t family = detail::load32(p, false);
+                if (family > 0xFFFF)
+                    family = bswap32(family);
+                ipVersion = family == 2 ? 4
+                                        : (family == 24 || family == 28 ||
+                                                   family == 30
+                                               ? 6
+                                               : 0);
+                p += 4;
+                length -= 4;
+                break;
+            }
+            case kLinkRaw:
+            case kLinkRawBsd:
+            case kLinkRawOpenBsd:
+            case kLinkIPv4:
+            case kLinkIPv6:
+                if (length > 0)
+                    ipVersion = static_cast<unsigned char>(p[0]) >> 4;
+                break;
+        }
+        if (ipVersion == 4)
+            return ipv4(p, length, time);
+        if (ipVersion == 6)
+            return ipv6(p, length, time);
+        m_stats.skipped++;
+        return false;
+    }
+
+    bool ipv4(const char* p, size_t length, uint64_t time)
+    {
+        if (length < 20)
+            return skip();
+        const size_t headerLength =
+            (static_cast<unsigned char>(p[0]) & 0xF) * 4;
+        const size_t totalLength = detail::loadBE16(p + 2);
+        if (headerLength < 20 || headerLength > length || p[9] != 17)
+            return skip();
+        if (detail::loadBE16(p + 6) & 0x3FFF)
+        {
+            // More fragments flag or non-zero fragment offset
+            m_stats.fragments++;
+            return false;
+        }
+        const size_t ipLength = std::max(headerLength,
+                                         std::min(totalLength, length));
+        return udp(p + headerLength, ipLength - headerLength, 4,
+                   reinterpret_cast<const unsigned char*>(p + 12),
+                   reinterpret_cast<const unsigned char*>(p + 16), time);
+    }
+
+    bool ipv6(const char* p, size_t length, uint64_t time)
+    {
+        if (length < 40)
+            return skip();
+        const size_t payloadLength = detail::loadBE16(p + 4);
+        unsigned     next = static_cast<unsigned char>(p[6]);
+        size_t       offset = 40;
+        const size_t end = std::min(length, 40 + payloadLength);
+        // Skip extension headers
+        while (next == 0 || next == 43 || next == 60 || next == 44)
+        {
+            if (end < offset + 8)
+                return skip();
+            if (next == 44)
+            {
+                m_stats.fragments++;
+                return false;
+            }
+            const size_t extLength =
+                (static_cast<unsigned char>(p[offset + 1]) + 1) * 8;
+            next = static_cast<unsigned char>(p[offset]);
+            offset += extLength;
+        }
+        if (next != 17 || offset > end)
+            return skip();
+        return udp(p + offset, end - offset, 6,
+                   reinterpret_cast<const unsigned char*>(p + 8),
+                   reinterpret_cast<const unsigned char*>(p + 24), time);
+    }
+
+    bool udp(const char* p, size_t length, int ipVersion,
+             const unsigned char* src, const unsigned char* dst,
+             uint64_t time)
+    {
+        if (length < 8)
+            return skip();
+        const uint16_t srcPort = detail::loadBE16(p);
+        const uint16_t dstPort = detail::loadBE16(p + 2);
+        const size_t   udpLength = detail::loadBE16(p + 4);
+        if (!m_ports.empty() &&
+            std::find(m_ports.begin(), m_ports.end(), srcPort) ==
+                m_ports.end() &&
+            std::find(m_ports.begin(), m_ports.end(), dstPort) ==
+                m_ports.end())
+        {
+            return skip();
+        }
+        if (udpLength < 8)
+            return skip();
+        if (udpLength > length)
+        {
+            m_stats.truncated++;
+            return false;
+        }
+        m_current.payload = p + 8;
+        m_current.size = udpLength - 8;
+        m_current.time = time;
+        m_current.ipVersion = ipVersion;
+        m_current.srcAddress = src;
+        m_current.dstAddress = dst;
+        m_current.srcPort = srcPort;
+        m_current.dstPort = dstPort;
+        return true;
+    }
+
+    bool skip()
+    {
+        m_stats.skipped++;
+        return false;
+    }
+
+    OSCPP::detail::MappedFile m_file;
+    const char*               m_data;
+    size_t                    m_size;
+    size_t                    m_pos = 0;
+    bool                      m_pcapng = false;
+    bool                      m_swap = false;
+    std::vector<Interface>    m_interfaces;
+    std::vector<uint16_t>     m_ports;
+    Found                     m_current;
+    std::vector<uint32_t>     m_scratch;
+    ReaderStats               m_stats;
+};
+
+//! UDP endpoint of synthesized packets.
+struct Endpoint
+{
+    //! IPv4 address in host byte order.
+    uint32_t address;
+    uint16_t port;
+};
+
+//! Capture file writer.
+/*!
+ * Writes a classic pcap file with nanosecond timestamps and Ethernet
+ * link type. Every packet is wrapped in Ethernet, IPv4 and UDP headers
+ * between two endpoints; the UDP checksum is left at zero, which IPv4
+ * permits.
+ */
+class Writer
+{
+public:
+    //! Create a capture file.
+    /*!
+     * \throw std::system_error the file couldn't be created.
+     */
+    explicit Writer(const std::string& path,
+                    Endpoint           src = Endpoint{0x7F000001, 57110},
+                    Endpoint           dst = Endpoint{0x7F000001, 57120})
+    : m_path(path)
+    , m_src(src)
+    , m_dst(dst)
+    , m_id(0)
+    {
+        m_file = std::fopen(path.c_str(), "wb");
+        if (m_file == nullptr)
+            throw error("Couldn't create");
+        uint32_t header[6] = {kMagicNanos, 0, 0, 0, 65535, kLinkEthernet};
+        // Version 2.4, stored as two 16 bit integers
+        const uint16_t version[2] = {2, 4};
+        std::memcpy(&header[1], version, 4);
+        write(header, sizeof(header));
+    }
+
+    ~Writer()
+    {
+        if (m_file != nullptr)
+            std::fclose(m_file);
+    }
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    //! Write a packet captured at time (nanoseconds since the epoch).
+    /*!
+     * \throw std::invalid_argument packet too large for a UDP datagram.
+     * \throw std::system_error write error.
+     */
+    void write(uint64_t time, const void* data, size_t size)
+    {
+        if (size > 65535 - 28)
+            throw std::invalid_argument("Packet too large for UDP");
+
+        const size_t frameSize = 14 + 20 + 8 + size;
+        uint32_t     record[4] = {
+            static_cast<uint32_t>(time / 1000000000),
+            static_cast<uint32_t>(time % 1000000000),
+            static_cast<uint32_t>(frameSize), static_cast<uint32_t>(frameSize)};
+        write(record, sizeof(record));
+
+        char h[42];
+        std::memset(h, 0, sizeof(h));
+        // Ethernet: locally administered MAC addresses
+        h[0] = 0x02;
+        h[5] = 0x02;
+        h[6] = 0x02;
+        h[11] = 0x01;
+        detail::storeBE16(h + 12, 0x0800);
+        // IPv4
+        char* ip = h + 14;
+        ip[0] = 0x45;
+        detail::storeBE16(ip + 2, static_cast<uint16_t>(20 + 8 + size));
+        detail::storeBE16(ip + 4, m_id++);
+        detail::storeBE16(ip + 6, 0x4000);
+        ip[8] = 64;
+        ip[9] = 17;
+        detail::storeBE32(ip + 12, m_src.address);
+        detail::storeBE32(ip + 16, m_dst.address);
+        detail::storeBE16(ip + 10, checksum(ip, 20));
+        // UDP
+        char* udp = ip + 20;
+        detail::storeBE16(udp, m_src.port);
+        detail::storeBE16(udp + 2, m_dst.port);
+        detail::storeBE16(udp + 4, static_cast<uint16_t>(8 + size));
+        write(h, sizeof(h));
+        write(data, size);
+    }
+
+    //! Write a packet built with Client::Packet.
+    void write(uint64_t time, const Client::Packet& packet)
+    {
+        write(time, packet.data(), packet.size());
+    }
+
+    void flush()
+    {
+        if (std::fflush(m_file) != 0)
+            throw error("Couldn't flush");
+    }
+
+private:
+    static const uint32_t kMagicNanos = 0xA1B23C4D;
+
+    static uint16_t checksum(const char* p, size_t size)
+    {
+        uint32_t sum = 0;
+        for (size_t i = 0; i + 1 < size; i += 2)
+            sum += detail::loadBE16(p + i);
+        while (sum >> 16)
+            sum = (sum & 0xFFFF) + (sum >> 16);
+        return static_cast<uint16_t>(~sum);
+    }
+
+    std::system_error error(const std::string& what) const
+    {
+        return std::system_error(errno, std::system_category(),
+                                 what + " " + m_path);
+    }
+
+    void write(const void* data, size_t size)
+    {
+        if (size > 0 && std::fwrite(data, 1, size, m_file) != size)
+            throw error("Couldn't write");
+    }
+
+    std::string m_path;
+    Endpoint    m_src;
+    Endpoint    m_dst;
+    std::FILE*  m_file;
+    uint16_t    m_id;
+};
+
+}} // namespace OSCPP::Pcap
+
+#endif // OSCPP_PCAP_HPP_INCLUDED
@@ -28,6 +28,7 @@
 #include <oscpp/client.hpp>
 #include <oscpp/server.hpp>
 
+#include <iomanip>
 #include <ostream>
 
 namespace OSCPP { namespace detail {
@@ -63,12 +64,27 @@ private:
 
 inline std::ostream& operator<<(std::ostream& out, const Indent& indent)
 {
-    size_t n = indent;
-    while (n-- > 0)
-        out << ' ';
+    static const char kSpaces[] = "                                ";
+    const size_t      kChunk = sizeof(kSpaces) - 1;
+    size_t            n = indent;
+    while (n > 0)
+    {
+        const size_t k = n < kChunk ? n : kChunk;
+        out.write(kSpaces, static_cast<std::streamsize>(k));
+        n -= k;
+    }
     return out;
 }
 
+inline void printHex32(std::ostream& out, uint32_t x)
+{
+    const std::ios::fmtflags flags(out.flags());
+    const char               fill = out.fill('0');
+    out << std::hex << std::setw(8) << x;
+    out.fill(fill);
+    out.flags(flags);
+}
+
 inline void printArgs(std::ostream& out, Server::ArgStream args)
 {
     while (!args.atEnd())
@@ -79,15 +95,51 @@ inline void printArgs(std::ostream& out, Server::ArgStream args)
             case 'i':
                 out << "i:" << args.int32();
                 break;
+            case 'h':
+                out << "h:" << args.int64();
+                break;
+            case 't':
+                out << "t:" << args.timeTag();
+                break;
             case 'f':
                 out << "f:" << args.float32();
                 break;
+            case 'd':
+                out << "d:" << args.float64();
+                break;
             case 's':
                 out << "s:" << args.string();
                 break;
             case 'b':
                 out << "b:" << args.blob().size();
                 break;
+            case 'S':
+                out << "S:" << args.symbol();
+                break;
+            case 'T':
+            case 'F':
+                out << t;
+                args.boolean();
+                break;
+            case 'N':
+                out << t;
+                args.nil();
+                break;
+            case 'I':
+                out << t;
+                args.infinitum();
+                break;
+            case 'c':
+                out << "c:" << args.character();
+                break;
+            case 'r':
+                out << "r:";
+                printHex32(out, args.rgba().value());
+                break;
+            case 'm':
+                out << "m:";
+                printHex32(out, args.midi().value());
+                break;
             case '[':
                 out << "[ ";
                 printArgs(out, args.array());
@@ -175,7 +227,7 @@ namespace OSCPP { namespace Client {
 
 inline std::ostream& operator<<(std::ostream& out, const Packet& packet)
 {
-    return out << Server::Packet(packet.data(), packet.size());
+    return out << Server::Packet::view(packet.data(), packet.size());
 }
 
 }} // namespace OSCPP::Client
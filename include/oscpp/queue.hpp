@@ -0,0 +1,422 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_QUEUE_HPP_INCLUDED
+#define OSCPP_QUEUE_HPP_INCLUDED
+
+#include <oscpp/client.hpp>
+#include <oscpp/error.hpp>
+#include <oscpp/symbol.hpp>
+#include <oscpp/util.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <condition_variable>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace OSCPP { namespace Client {
+
+//! What a full SendQueue does with another packet.
+enum class DropPolicy
+{
+    //! Drop the oldest queued packet to make room.
+    DropOldest,
+    //! Drop the new packet.
+    DropNewest,
+    //! Replace a queued message with the same address in place, keeping
+    //! its position; otherwise drop the oldest queued packet when full.
+    CoalesceByAddress
+};
+
+//! Bounded outbound packet queue between packet builders and a socket.
+/*!
+ * Packets are built directly into one of a fixed number of slots
+ * allocated on construction, so that queueing never allocates and
+ * builders never wait for the socket. Any number of threads may call
+ * push(); a single thread at a time calls drain() to hand queued
+ * packets to a sink, e.g. a non-blocking socket. Neither packets nor
+ * the sink are called while holding the queue's lock, so builders are
+ * only blocked for the short time it takes to take a free slot and to
+ * enqueue or dequeue a packet.
+ *
+ * There is one slot more than the capacity. When several threads build
+ * packets at the same time while the queue is full, a builder may have
+ * to wait until another one has finished and its packet has been
+ * queued or dropped, which frees a slot.
+ *
+ * When the queue is full, new packets are dropped or replace older ones
+ * according to the DropPolicy. With DropPolicy::CoalesceByAddress,
+ * single messages replace a queued message with the same address, so a
+ * slow receiver gets the latest value of every address instead of a
+ * backlog; finding it scans the queue, which is cheap for queues of up
+ * to a few thousand packets. Bundles are never coalesced.
+ *
+ * Watermarks let builders react before packets are dropped: the queue
+ * becomes congested() when its depth reaches the high watermark, and
+ * stays congested until it has been drained down to the low watermark.
+ */
+class SendQueue
+{
+public:
+    //! Constructor.
+    /*!
+     * \param capacity Maximum number of queued packets.
+     * \param maxPacketSize Maximum packet size in bytes.
+     * \param policy Behaviour when the queue is full.
+     * \param highWatermark Depth at which the queue becomes congested;
+     * zero means capacity.
+     * \param lowWatermark Depth at which a congested queue becomes
+     * uncongested again.
+     *
+     * \throw std::invalid_argument zero capacity or invalid watermarks.
+     */
+    SendQueue(size_t capacity, size_t maxPacketSize,
+              DropPolicy policy = DropPolicy::DropOldest,
+              size_t highWatermark = 0, size_t lowWatermark = 0)
+    : m_capacity(capacity)
+    , m_slotWords(align(maxPacketSize) / 4)
+    , m_policy(policy)
+    , m_highWatermark(highWatermark > 0 ? highWatermark : capacity)
+    , m_lowWatermark(lowWatermark)
+    , m_data(new uint32_t[(capacity + 1) * m_slotWords])
+    , m_slots(capacity + 1)
+    , m_ring(capacity)
+    , m_head(0)
+    , m_depth(0)
+    , m_sending(false)
+    , m_congested(false)
+    {
+        if (capacity == 0 || m_highWatermark > capacity ||
+            m_lowWatermark >= m_highWatermark)
+            throw std::invalid_argument("Invalid send queue watermarks");
+        // One slot more than the capacity, for building a packet
+        m_free.reserve(capacity + 1);
+        for (size_t i = capacity + 1; i > 0; i--)
+            m_free.push_back(static_cast<uint32_t>(i - 1));
+    }
+
+    SendQueue(const SendQueue&) = delete;
+    SendQueue& operator=(const SendQueue&) = delete;
+
+    //! Queue a packet built in place.
+    /*!
+     * Calls build(packet), which has to write a message or bundle into
+     * the packet, without holding the queue's lock. Returns false if the
+     * packet was dropped because the queue is full and the policy is
+     * DropPolicy::DropNewest.
+     *
+     * \throw OSCPP::OverflowError packet larger than maxPacketSize;
+     * nothing is queued.
+     */
+    template <typename Builder> bool push(Builder build)
+    {
+        const uint32_t slot = acquire();
+        Packet         packet(slotData(slot), 4 * m_slotWords);
+        try
+        {
+            build(packet);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            release(slot);
+            throw;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return commit(slot, packet.size());
+    }
+
+    //! Queue a copy of an encoded packet.
+    /*!
+     * \throw OSCPP::OverflowError packet larger than maxPacketSize.
+     */
+    bool push(const void* data, size_t size)
+    {
+        if (size > 4 * m_slotWords)
+            throw OverflowError(size - 4 * m_slotWords);
+        const uint32_t slot = acquire();
+        std::memcpy(slotData(slot), data, size);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return commit(slot, size);
+    }
+
+    //! Pass queued packets to a sink, oldest first.
+    /*!
+     * Calls sink(const void* data, size_t size) for up to maxPackets
+     * packets. The sink returns true if the packet has been sent, or
+     * false if it couldn't be sent now (e.g. because a non-blocking
+     * socket would block); in that case the packet stays at the head of
+     * the queue and drain() returns. Exceptions thrown by the sink
+     * likewise leave the packet queued. Returns the number of packets
+     * sent. Must not be called concurrently with itself.
+     */
+    template <typename Sink>
+    size_t drain(Sink sink,
+                 size_t maxPackets = std::numeric_limits<size_t>::max())
+    {
+        size_t n = 0;
+        while (n < maxPackets)
+        {
+            uint32_t slot;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_depth == 0)
+                    break;
+                // The head slot is left alone by push() while sending
+                slot = m_ring[m_head];
+                m_sending = true;
+            }
+            bool sent = false;
+            try
+            {
+                sent = sink(static_cast<const void*>(slotData(slot)),
+                            static_cast<size_t>(m_slots[slot].size));
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_sending = false;
+                throw;
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_sending = false;
+            if (!sent)
+                break;
+            popFront();
+            m_numSent++;
+            n++;
+        }
+        return n;
+    }
+
+    //! \name State and counters
+    //@{
+
+    //! Number of queued packets.
+    size_t depth() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_depth;
+    }
+
+    size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+    //! True between reaching the high and the low watermark.
+    bool congested() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_congested;
+    }
+
+    //! Number of packets queued.
+    uint64_t numQueued() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_numQueued;
+    }
+
+    //! Number of packets passed to the sink successfully.
+    uint64_t numSent() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_numSent;
+    }
+
+    //! Number of packets dropped because the queue was full.
+    uint64_t numDropped() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_numDropped;
+    }
+
+    //! Number of queued messages replaced by newer ones.
+    uint64_t numCoalesced() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_numCoalesced;
+    }
+
+    //! Number of times the queue became congested.
+    uint64_t numCongestions() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_numCongestions;
+    }
+
+    //@}
+
+private:
+    struct Slot
+    {
+        uint32_t size;
+        uint32_t hash;          // Address hash, if a message
+        uint32_t addressLength; // Zero for bundles
+    };
+
+    char* slotData(uint32_t slot) const
+    {
+        return reinterpret_cast<char*>(m_data.get() + slot * m_slotWords);
+    }
+
+    size_t ringIndex(size_t position) const
+    {
+        const size_t i = m_head + position;
+        return i < m_capacity ? i : i - m_capacity;
+    }
+
+    // Take a free slot for building a packet, waiting for other builders
+    // to queue or drop theirs if there is none.
+    uint32_t acquire()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_free.empty())
+        {
+            m_numWaiting++;
+            m_slotFreed.wait(lock, [&] { return !m_free.empty(); });
+            m_numWaiting--;
+        }
+        const uint32_t slot = m_free.back();
+        m_free.pop_back();
+        return slot;
+    }
+
+    // Return a slot to the free list; called with the lock held.
+    void release(uint32_t slot)
+    {
+        m_free.push_back(slot);
+        if (m_numWaiting > 0)
+            m_slotFreed.notify_one();
+    }
+
+    // Enqueue the packet built in slot, which has been acquired.
+    bool commit(uint32_t slot, size_t size)
+    {
+        Slot&       s = m_slots[slot];
+        const char* data = slotData(slot);
+        s.size = static_cast<uint32_t>(size);
+        s.addressLength = 0;
+        if (m_policy == DropPolicy::CoalesceByAddress && size > 0 &&
+            data[0] == '/')
+        {
+            const void* end = std::memchr(data, '\0', size);
+            s.addressLength = static_cast<uint32_t>(
+                end != nullptr ? static_cast<const char*>(end) - data : size);
+            s.hash = detail::hashString(data, s.addressLength);
+            // Skip the head while it is being sent
+            for (size_t i = m_sending ? 1 : 0; i < m_depth; i++)
+            {
+                uint32_t&   queued = m_ring[ringIndex(i)];
+                const Slot& q = m_slots[queued];
+                if (q.hash == s.hash && q.addressLength == s.addressLength &&
+                    detail::equalBytes(slotData(queued), data,
+                                       s.addressLength))
+                {
+                    release(queued);
+                    queued = slot;
+                    m_numCoalesced++;
+                    m_numQueued++;
+                    return true;
+                }
+            }
+        }
+
+        if (m_depth == m_capacity)
+        {
+            // The packet being sent can't be dropped
+            m_numDropped++;
+            if (m_policy == DropPolicy::DropNewest ||
+                (m_sending && m_depth == 1))
+            {
+                release(slot);
+                return false;
+            }
+            dropOldest();
+        }
+        m_ring[ringIndex(m_depth)] = slot;
+        m_depth++;
+        m_numQueued++;
+        if (!m_congested && m_depth >= m_highWatermark)
+        {
+            m_congested = true;
+            m_numCongestions++;
+        }
+        return true;
+    }
+
+    // Drop the oldest packet that isn't being sent.
+    void dropOldest()
+    {
+        if (m_sending)
+        {
+            // Move the head into the place of the second oldest packet
+            const size_t second = ringIndex(1);
+            std::swap(m_ring[second], m_ring[m_head]);
+        }
+        popFront();
+    }
+
+    void popFront()
+    {
+        release(m_ring[m_head]);
+        m_head = ringIndex(1);
+        m_depth--;
+        if (m_congested && m_depth <= m_lowWatermark)
+            m_congested = false;
+    }
+
+    size_t                      m_capacity;
+    size_t                      m_slotWords;
+    DropPolicy                  m_policy;
+    size_t                      m_highWatermark;
+    size_t                      m_lowWatermark;
+    std::unique_ptr<uint32_t[]> m_data;
+    std::vector<Slot>           m_slots;
+    std::vector<uint32_t>       m_free;
+    std::vector<uint32_t>       m_ring;
+    size_t                      m_head;
+    size_t                      m_depth;
+    bool                        m_sending;
+    bool                        m_congested;
+    size_t                      m_numWaiting = 0;
+    mutable std::mutex          m_mutex;
+    std::condition_variable     m_slotFreed;
+    uint64_t                    m_numQueued = 0;
+    uint64_t                    m_numSent = 0;
+    uint64_t                    m_numDropped = 0;
+    uint64_t                    m_numCoalesced = 0;
+    uint64_t                    m_numCongestions = 0;
+};
+
+}} // namespace OSCPP::Client
+
+#endif // OSCPP_QUEUE_HPP_INCLUDED
@@ -0,0 +1,838 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_RECORDING_HPP_INCLUDED
+#define OSCPP_RECORDING_HPP_INCLUDED
+
+#include <oscpp/detail/mmap.hpp>
+#include <oscpp/detail/stream.hpp>
+#include <oscpp/error.hpp>
+#include <oscpp/server.hpp>
+#include <oscpp/util.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <unordered_set>
+#include <vector>
+
+//! \file
+//! Session recording.
+/*!
+ * A recording is a sequence of segment files named
+ * `<prefix>-<index>.osclog`, with six digit indices starting at zero.
+ * A segment starts with a 16 byte header
+ *
+ *     "OSCPPLOG"       magic
+ *     uint32           format version (1)
+ *     uint32           segment index
+ *
+ * followed by records
+ *
+ *     uint64           receive time in nanoseconds since the Unix epoch
+ *     int32            packet size in bytes
+ *     char[size]       packet data, zero padded to a multiple of 4
+ *
+ * with all integers in network byte order. Records are only appended,
+ * so a recording can be read while it's being written; a partially
+ * written record at the end of a segment is ignored by readers.
+ *
+ * When a segment is complete, the recorder writes an index file
+ * `<prefix>-<index>.oscidx` next to it:
+ *
+ *     "OSCPPIDX"       magic
+ *     uint32           format version (1)
+ *     uint32           segment index
+ *     uint64           time of the first record
+ *     uint64           time of the last record
+ *     uint32           number of records
+ *     uint32           number of time index entries
+ *     uint32           number of 32 bit words in the address filter
+ *     uint32           number of address filter hash functions
+ *     entries          uint64 time and uint32 file offset of a record,
+ *                      one for every 64 KiB of segment data
+ *     uint32[]         bloom filter of all message addresses
+ *
+ * The address filter has a power of two number of bits; bit b is bit
+ * b % 32 of word b / 32. An address sets the bits (h + i * h2) mod the
+ * number of bits for i in [0, number of hash functions), where h is the
+ * 32 bit FNV-1a hash of the address bytes followed by the MurmurHash3
+ * finalizer and h2 = (h rotated right by 17) * 0x85EBCA6B | 1, both
+ * computed modulo 2^32.
+ *
+ * Seeking by time assumes that receive times don't decrease within a
+ * recording.
+ */
+
+namespace OSCPP { namespace Recording {
+
+static const char     kMagic[8] = {'O', 'S', 'C', 'P', 'P', 'L', 'O', 'G'};
+static const char     kIndexMagic[8] = {'O', 'S', 'C', 'P', 'P', 'I', 'D', 'X'};
+static const uint32_t kVersion = 1;
+static const size_t   kSegmentHeaderSize = 16;
+static const size_t   kRecordHeaderSize = 12;
+static const size_t   kIndexHeaderSize = 48;
+static const size_t   kIndexEntrySize = 12;
+static const size_t   kIndexInterval = 64 << 10;
+
+//! Return the path of a segment file.
+inline std::string segmentPath(const std::string& prefix, size_t index)
+{
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), "-%06zu.osclog", index);
+    return prefix + suffix;
+}
+
+//! Return the path of a segment index file.
+inline std::string indexPath(const std::string& prefix, size_t index)
+{
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), "-%06zu.oscidx", index);
+    return prefix + suffix;
+}
+
+//! Return the current time in nanoseconds since the Unix epoch.
+inline uint64_t now()
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count());
+}
+
+//! A recorded packet.
+struct Record
+{
+    //! Receive time in nanoseconds since the Unix epoch.
+    uint64_t time;
+    //! Packet view into the mapped segment.
+    Server::Packet packet;
+};
+
+//! Stream of records in a segment.
+class RecordStream
+{
+public:
+    RecordStream() = default;
+
+    RecordStream(const ReadStream& stream)
+    : m_stream(stream)
+    {}
+
+    //! Return true if no complete record is left.
+    bool atEnd() const
+    {
+        if (m_stream.consumable() < kRecordHeaderSize)
+            return true;
+        ReadStream header(m_stream);
+        header.skip(8);
+        const int32_t size = header.getInt32();
+        return size >= 0 &&
+               align(static_cast<size_t>(size)) > header.consumable();
+    }
+
+    //! Return the time of the next record without consuming it.
+    /*!
+     * \throw OSCPP::UnderrunError stream buffer underrun.
+     */
+    uint64_t peekTime() const
+    {
+        return ReadStream(m_stream).getUInt64();
+    }
+
+    //! Return the next record.
+    /*!
+     * \throw OSCPP::UnderrunError stream buffer underrun.
+     * \throw OSCPP::ParseError negative packet size.
+     */
+    Record next()
+    {
+        Record record;
+        record.time = m_stream.getUInt64();
+        const int32_t size = m_stream.getInt32();
+        if (size < 0)
+            throw ParseError("Invalid record size");
+        record.packet = Server::Packet(
+            ReadStream(m_stream, static_cast<size_t>(size)));
+        m_stream.skip(align(static_cast<size_t>(size)));
+        return record;
+    }
+
+    //! Return the offset of the next record from the start of the
+    //! segment data passed to the constructor.
+    size_t offset() const
+    {
+        return m_stream.consumed();
+    }
+
+private:
+    ReadStream m_stream;
+};
+
+//! Memory mapped segment file.
+class Segment
+{
+public:
+    //! Map a segment and check its header.
+    /*!
+     * \throw std::system_error the file couldn't be mapped.
+     * \throw OSCPP::ParseError invalid segment header.
+     */
+    explicit Segment(const std::string& path)
+    : m_file(path)
+    {
+        if (m_file.size() < kSegmentHeaderSize ||
+            std::memcmp(m_file.data(), kMagic, sizeof(kMagic)) != 0)
+        {
+            throw ParseError("Invalid segment header in " + path);
+        }
+        ReadStream header(m_file.data() + sizeof(kMagic),
+                          kSegmentHeaderSize - sizeof(kMagic));
+        if (header.getUInt32() != kVersion)
+            throw ParseError("Unsupported segment version in " + path);
+        m_index = header.getUInt32();
+    }
+
+    //! Return the segment index stored in the header.
+    uint32_t index() const
+    {
+        return m_index;
+    }
+
+    //! Return the mapped file contents including the header.
+    const char* data() const
+    {
+        return m_file.data();
+    }
+
+    size_t size() const
+    {
+        return m_file.size();
+    }
+
+    //! Return a stream of the records starting at a file offset, which
+    //! has to be the offset of a record, e.g. from SegmentIndex::seek().
+    RecordStream records(size_t offset = kSegmentHeaderSize) const
+    {
+        offset = std::min(std::max(offset, kSegmentHeaderSize), m_file.size());
+        return RecordStream(
+            ReadStream(m_file.data() + offset, m_file.size() - offset));
+    }
+
+private:
+    detail::MappedFile m_file;
+    uint32_t           m_index;
+};
+
+//! Time index and address filter of a segment.
+class SegmentIndex
+{
+public:
+    struct Entry
+    {
+        uint64_t time;
+        uint32_t offset;
+    };
+
+    //! Bits per address in the filter, for a false positive rate of
+    //! about one percent.
+    static const size_t kBitsPerAddress = 10;
+    static const uint32_t kNumHashes = 7;
+    //! Largest number of hash functions accepted in index files.
+    static const uint32_t kMaxHashes = 32;
+
+    SegmentIndex()
+    : m_firstTime(0)
+    , m_lastTime(0)
+    , m_numRecords(0)
+    , m_numHashes(kNumHashes)
+    , m_nextEntry(0)
+    {}
+
+    //! Add a record at a file offset.
+    /*!
+     * The addresses of all messages in the packet are added to the
+     * filter; malformed packets only contribute their time. The filter
+     * is built by finish().
+     */
+    void add(const Record& record, size_t offset)
+    {
+        if (m_numRecords == 0)
+            m_firstTime = record.time;
+        m_lastTime = record.time;
+        m_numRecords++;
+        if (offset >= m_nextEntry)
+        {
+            m_entries.push_back(
+                Entry{record.time, static_cast<uint32_t>(offset)});
+            m_nextEntry = offset - offset % kIndexInterval + kIndexInterval;
+        }
+        try
+        {
+            addAddresses(record.packet);
+        }
+        catch (Error&)
+        {
+        }
+    }
+
+    //! Build the address filter from the addresses added so far.
+    void finish()
+    {
+        size_t numBits = 64;
+        while (numBits < m_hashes.size() * kBitsPerAddress)
+            numBits *= 2;
+        m_filter.assign(numBits / 32, 0);
+        for (uint32_t h : m_hashes)
+        {
+            for (uint32_t i = 0; i < m_numHashes; i++)
+            {
+                const uint32_t bit = probe(h, i, numBits);
+                m_filter[bit / 32] |= uint32_t(1) << (bit % 32);
+            }
+        }
+        m_hashes.clear();
+    }
+
+    uint64_t firstTime() const
+    {
+        return m_firstTime;
+    }
+
+    uint64_t lastTime() const
+    {
+        return m_lastTime;
+    }
+
+    size_t numRecords() const
+    {
+        return m_numRecords;
+    }
+
+    const std::vector<Entry>& entries() const
+    {
+        return m_entries;
+    }
+
+    //! Return false if no message in the segment has the address.
+    bool mayContain(const char* address, size_t length) const
+    {
+        if (m_filter.empty())
+            return false;
+        const size_t   numBits = m_filter.size() * 32;
+        const uint32_t h = hash(address, length);
+        for (uint32_t i = 0; i < m_numHashes; i++)
+        {
+            const uint32_t bit = probe(h, i, numBits);
+            if (!(m_filter[bit / 32] & (uint32_t(1) << (bit % 32))))
+                return false;
+        }
+        return true;
+    }
+
+    bool mayContain(const char* address) const
+    {
+        return mayContain(address, std::strlen(address));
+    }
+
+    //! Return the file offset of the last indexed record with a time not
+    //! greater than time, from which records can be scanned to find the
+    //! first record at or after time.
+    size_t seek(uint64_t time) const
+    {
+        auto it = std::upper_bound(
+            m_entries.begin(), m_entries.end(), time,
+            [](uint64_t t, const Entry& e) { return t < e.time; });
+        return it == m_entries.begin() ? kSegmentHeaderSize
+                                       : (it - 1)->offset;
+    }
+
+    //! Index a segment by scanning all of its records.
+    static SegmentIndex build(const Segment& segment)
+    {
+        SegmentIndex index;
+        RecordStream records = segment.records();
+        while (!records.atEnd())
+        {
+            const size_t offset = kSegmentHeaderSize + records.offset();
+            index.add(records.next(), offset);
+        }
+        index.finish();
+        return index;
+    }
+
+    //! Write the index of segment segmentIndex to a file.
+    /*!
+     * \throw std::system_error write error.
+     */
+    void write(const std::string& path, size_t segmentIndex) const
+    {
+        std::vector<char> buffer(kIndexHeaderSize +
+                                 m_entries.size() * kIndexEntrySize +
+                                 m_filter.size() * 4);
+        WriteStream stream(buffer.data(), buffer.size());
+        stream.putData(kIndexMagic, sizeof(kIndexMagic));
+        stream.putUInt32(kVersion);
+        stream.putUInt32(static_cast<uint32_t>(segmentIndex));
+        stream.putUInt64(m_firstTime);
+        stream.putUInt64(m_lastTime);
+        stream.putUInt32(static_cast<uint32_t>(m_numRecords));
+        stream.putUInt32(static_cast<uint32_t>(m_entries.size()));
+        stream.putUInt32(static_cast<uint32_t>(m_filter.size()));
+        stream.putUInt32(m_numHashes);
+        for (const Entry& e : m_entries)
+        {
+            stream.putUInt64(e.time);
+            stream.putUInt32(e.offset);
+        }
+        for (uint32_t w : m_filter)
+            stream.putUInt32(w);
+
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr)
+            throw std::system_error(errno, std::system_category(),
+                                    "Couldn't create " + path);
+        const bool ok =
+            std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+        if (std::fclose(file) != 0 || !ok)
+            throw std::system_error(errno, std::system_category(),
+                                    "Couldn't write " + path);
+    }
+
+    //! Read an index file.
+    /*!
+     * \throw std::system_error the file couldn't be mapped.
+     * \throw OSCPP::ParseError invalid index file.
+     * \throw OSCPP::UnderrunError truncated index file.
+     */
+    static SegmentIndex read(const std::string& path)
+    {
+        const detail::MappedFile file(path);
+        if (file.size() < kIndexHeaderSize ||
+            std::memcmp(file.data(), kIndexMagic, sizeof(kIndexMagic)) != 0)
+        {
+            throw ParseError("Invalid index header in " + path);
+        }
+        ReadStream stream(file.data() + sizeof(kIndexMagic),
+                          file.size() - sizeof(kIndexMagic));
+        if (stream.getUInt32() != kVersion)
+            throw ParseError("Unsupported index version in " + path);
+        stream.skip(4);
+        SegmentIndex index;
+        index.m_firstTime = stream.getUInt64();
+        index.m_lastTime = stream.getUInt64();
+        index.m_numRecords = stream.getUInt32();
+        const size_t numEntries = stream.getUInt32();
+        const size_t numWords = stream.getUInt32();
+        index.m_numHashes = stream.getUInt32();
+        if (numWords == 0 || (numWords & (numWords - 1)) != 0 ||
+            index.m_numHashes == 0 || index.m_numHashes > kMaxHashes)
+            throw ParseError("Invalid address filter in " + path);
+        if (numEntries > stream.consumable() / kIndexEntrySize ||
+            numWords > stream.consumable() / 4 ||
+            numEntries * kIndexEntrySize + numWords * 4 != stream.consumable())
+            throw ParseError("Invalid index size in " + path);
+        index.m_entries.resize(numEntries);
+        for (Entry& e : index.m_entries)
+        {
+            e.time = stream.getUInt64();
+            e.offset = stream.getUInt32();
+        }
+        index.m_filter.resize(numWords);
+        for (uint32_t& w : index.m_filter)
+            w = stream.getUInt32();
+        return index;
+    }
+
+private:
+    // Address hash stored in index files; unlike detail::hashString it
+    // doesn't depend on the byte order or the library version.
+    static uint32_t hash(const char* address, size_t length)
+    {
+        uint32_t h = 2166136261u;
+        for (size_t i = 0; i < length; i++)
+            h = (h ^ static_cast<uint8_t>(address[i])) * 16777619u;
+        h ^= h >> 16;
+        h *= 0x85EBCA6Bu;
+        h ^= h >> 13;
+        h *= 0xC2B2AE35u;
+        return h ^ (h >> 16);
+    }
+
+    // Double hashing with a second hash derived from the first.
+    static uint32_t probe(uint32_t h, uint32_t i, size_t numBits)
+    {
+        const uint32_t h2 = ((h >> 17) | (h << 15)) * 0x85EBCA6Bu | 1;
+        return (h + i * h2) & static_cast<uint32_t>(numBits - 1);
+    }
+
+    void addAddresses(const Server::Packet& packet)
+    {
+        if (packet.isBundle())
+        {
+            Server::PacketStream packets(Server::Bundle(packet).packets());
+            while (!packets.atEnd())
+                addAddresses(packets.next());
+        }
+        else if (packet.isMessage())
+        {
+            const Server::Message msg(packet);
+            m_hashes.insert(hash(msg.address(), msg.addressLength()));
+        }
+    }
+
+    uint64_t                     m_firstTime;
+    uint64_t                     m_lastTime;
+    size_t                       m_numRecords;
+    uint32_t                     m_numHashes;
+    std::vector<Entry>           m_entries;
+    std::vector<uint32_t>        m_filter;
+    std::unordered_set<uint32_t> m_hashes;
+    size_t                       m_nextEntry;
+};
+
+//! Append-only recording of packets.
+/*!
+ * Segments are written with buffered stdio; flush() makes the records
+ * appended so far visible to readers. A new segment is started when a
+ * record would grow the current segment beyond the maximum segment
+ * size, and the index of the completed segment is written. Recording
+ * always starts a new segment after the last existing one, so a
+ * recording can be continued across runs.
+ */
+class Recorder
+{
+public:
+    //! Constructor.
+    /*!
+     * \throw std::invalid_argument maxSegmentSize is larger than 4 GiB,
+     * the largest size record offsets in index files can address.
+     * \throw std::system_error the first segment couldn't be created.
+     */
+    Recorder(const std::string& prefix, size_t maxSegmentSize = 64 << 20)
+    : m_prefix(prefix)
+    , m_maxSegmentSize(maxSegmentSize)
+    , m_file(nullptr)
+    , m_index(0)
+    , m_segmentSize(0)
+    {
+        if (uint64_t(maxSegmentSize) > (uint64_t(1) << 32))
+            throw std::invalid_argument("Maximum segment size too large");
+        while (detail::MappedFile::exists(segmentPath(m_prefix, m_index)))
+            m_index++;
+        open();
+    }
+
+    //! Close the current segment and write its index.
+    ~Recorder()
+    {
+        try
+        {
+            close();
+        }
+        catch (std::exception&)
+        {
+        }
+    }
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    //! Return the index of the segment currently being written.
+    size_t segmentIndex() const
+    {
+        return m_index;
+    }
+
+    //! Append a packet received at time (see Recording::now()).
+    /*!
+     * \throw std::invalid_argument packet size doesn't fit into int32.
+     * \throw std::system_error write error.
+     */
+    void append(uint64_t time, const void* data, size_t size)
+    {
+        if (size > static_cast<size_t>(std::numeric_limits<int32_t>::max()) -
+                       4)
+            throw std::invalid_argument("Packet too large for recording");
+
+        const size_t recordSize = kRecordHeaderSize + align(size);
+        if (m_segmentSize > kSegmentHeaderSize &&
+            m_segmentSize + recordSize > m_maxSegmentSize)
+        {
+            close();
+            m_index++;
+            open();
+        }
+
+        char        header[kRecordHeaderSize];
+        WriteStream stream(header, sizeof(header));
+        stream.putUInt64(time);
+        stream.putInt32(static_cast<int32_t>(size));
+        const char padding[4] = {0, 0, 0, 0};
+        write(header, sizeof(header));
+        write(data, size);
+        write(padding, align(size) - size);
+
+        m_segmentIndex.add(Record{time, Server::Packet::view(data, size)},
+                           m_segmentSize);
+        m_segmentSize += recordSize;
+    }
+
+    //! Append a packet received now.
+    void append(const void* data, size_t size)
+    {
+        append(now(), data, size);
+    }
+
+    //! Write buffered records to the segment file.
+    void flush()
+    {
+        if (std::fflush(m_file) != 0)
+            throw error("Couldn't flush");
+    }
+
+private:
+    std::system_error error(const std::string& what) const
+    {
+        return std::system_error(errno, std::system_category(),
+                                 what + " " + segmentPath(m_prefix, m_index));
+    }
+
+    void write(const void* data, size_t size)
+    {
+        if (size > 0 && std::fwrite(data, 1, size, m_file) != size)
+            throw error("Couldn't write");
+    }
+
+    void open()
+    {
+        m_file = std::fopen(segmentPath(m_prefix, m_index).c_str(), "wb");
+        if (m_file == nullptr)
+            throw error("Couldn't create");
+        char        header[kSegmentHeaderSize];
+        WriteStream stream(header, sizeof(header));
+        stream.putData(kMagic, sizeof(kMagic));
+        stream.putUInt32(kVersion);
+        stream.putUInt32(static_cast<uint32_t>(m_index));
+        write(header, sizeof(header));
+        m_segmentSize = kSegmentHeaderSize;
+        m_segmentIndex = SegmentIndex();
+    }
+
+    void close()
+    {
+        if (m_file == nullptr)
+            return;
+        const int result = std::fclose(m_file);
+        m_file = nullptr;
+        if (result != 0)
+            throw error("Couldn't close");
+        m_segmentIndex.finish();
+        m_segmentIndex.write(indexPath(m_prefix, m_index), m_index);
+    }
+
+    std::string  m_prefix;
+    size_t       m_maxSegmentSize;
+    std::FILE*   m_file;
+    size_t       m_index;
+    size_t       m_segmentSize;
+    SegmentIndex m_segmentIndex;
+};
+
+//! Reader for all segments of a recording.
+/*!
+ * Segment indexes are read from their index files, or built by scanning
+ * the segment if the index is missing, e.g. because the segment is
+ * still being written. Packets are views into the mapped segments and
+ * remain valid for the lifetime of the reader.
+ */
+class Reader
+{
+public:
+    //! Map all segments of a recording and load their indexes.
+    /*!
+     * \throw std::system_error a segment couldn't be mapped.
+     * \throw OSCPP::ParseError invalid segment header or index file.
+     */
+    explicit Reader(const std::string& prefix)
+    {
+        for (size_t i = 0; detail::MappedFile::exists(segmentPath(prefix, i));
+             i++)
+        {
+            m_segments.emplace_back(segmentPath(prefix, i));
+            const std::string index = indexPath(prefix, i);
+            m_indexes.push_back(detail::MappedFile::exists(index)
+                                    ? SegmentIndex::read(index)
+                                    : SegmentIndex::build(m_segments.back()));
+        }
+    }
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    size_t numSegments() const
+    {
+        return m_segments.size();
+    }
+
+    const Segment& segment(size_t i) const
+    {
+        return m_segments[i];
+    }
+
+    const SegmentIndex& index(size_t i) const
+    {
+        return m_indexes[i];
+    }
+
+    //! Stream of records from a sequence of segments.
+    /*!
+     * Yields the records of the selected segments in order, skipping
+     * records before the begin time and ending at the first record at or
+     * after the end time.
+     */
+    class Cursor
+    {
+    public:
+        Cursor(const Reader& reader, std::vector<size_t> segments,
+               uint64_t begin = 0,
+               uint64_t end = std::numeric_limits<uint64_t>::max())
+        : m_reader(&reader)
+        , m_segments(std::move(segments))
+        , m_next(0)
+        , m_begin(begin)
+        , m_end(end)
+        {
+            advance();
+        }
+
+        bool atEnd() const
+        {
+            return m_records.atEnd() || m_records.peekTime() >= m_end;
+        }
+
+        //! Return the next record.
+        /*!
+         * \throw OSCPP::UnderrunError no records left.
+         * \throw OSCPP::ParseError negative packet size.
+         */
+        Record next()
+        {
+            if (atEnd())
+                throw UnderrunError();
+            const Record record = m_records.next();
+            advance();
+            return record;
+        }
+
+    private:
+        // Move to the next record at or after the begin time.
+        void advance()
+        {
+            for (;;)
+            {
+                while (!m_records.atEnd())
+                {
+                    if (m_records.peekTime() >= m_begin)
+                        return;
+                    m_records.next();
+                }
+                if (m_next == m_segments.size())
+                    return;
+                const size_t i = m_segments[m_next++];
+                m_records = m_reader->segment(i).records(
+                    m_reader->index(i).seek(m_begin));
+            }
+        }
+
+        const Reader*       m_reader;
+        std::vector<size_t> m_segments;
+        size_t              m_next;
+        uint64_t            m_begin;
+        uint64_t            m_end;
+        RecordStream        m_records;
+    };
+
+    //! Return a stream of all records.
+    Cursor records() const
+    {
+        return range(0, std::numeric_limits<uint64_t>::max());
+    }
+
+    //! Return a stream of the records received in [begin, end).
+    /*!
+     * Only segments overlapping the time range are read and the first one
+     * is entered at the closest index entry.
+     */
+    Cursor range(uint64_t begin, uint64_t end) const
+    {
+        return Cursor(*this, select(begin, end, nullptr, 0), begin, end);
+    }
+
+    //! Return a stream of the records received in [begin, end) from
+    //! segments that may contain messages with an address.
+    /*!
+     * Segments whose address filter excludes the address are skipped
+     * without being read. The records returned still have to be checked
+     * for the address.
+     */
+    Cursor range(uint64_t begin, uint64_t end, const char* address) const
+    {
+        return Cursor(*this,
+                      select(begin, end, address, std::strlen(address)),
+                      begin, end);
+    }
+
+private:
+    std::vector<size_t> select(uint64_t begin, uint64_t end,
+                               const char* address, size_t length) const
+    {
+        std::vector<size_t> result;
+        for (size_t i = 0; i < m_segments.size(); i++)
+        {
+            const SegmentIndex& index = m_indexes[i];
+            if (index.numRecords() > 0 && index.lastTime() >= begin &&
+                index.firstTime() < end &&
+                (address == nullptr || index.mayContain(address, length)))
+            {
+                result.push_back(i);
+            }
+        }
+        return result;
+    }
+
+    std::vector<Segment>      m_segments;
+    std::vector<SegmentIndex> m_indexes;
+};
+
+}} // namespace OSCPP::Recording
+
+#endif // OSCPP_RECORDING_HPP_INCLUDED
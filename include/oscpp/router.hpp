@@ -0,0 +1,285 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_ROUTER_HPP_INCLUDED
+#define OSCPP_ROUTER_HPP_INCLUDED
+
+#include <oscpp/error.hpp>
+#include <oscpp/server.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace OSCPP { namespace Server {
+
+//! Contiguous piece of a datagram.
+/*!
+ * Has the same members as struct iovec on POSIX systems, so that a
+ * list of fragments can be sent with a single call to writev or
+ * sendmsg.
+ */
+struct Fragment
+{
+    const void* data;
+    size_t      size;
+};
+
+//! Forwarding of messages to backends by address prefix.
+/*!
+ * Routes the messages of a packet to the backends whose address
+ * prefixes match, without decoding or copying message data: every
+ * backend receives a list of fragments pointing into the original
+ * packet, so that the cost of forwarding a message doesn't depend on
+ * its arguments.
+ *
+ * A packet whose messages are all routed to a backend is forwarded
+ * as a single fragment. Otherwise the backend receives a bundle made
+ * of the original bundle header, followed by the routed elements with
+ * their original size prefixes. Only nested bundles of which some
+ * elements are dropped need new size prefixes; these are kept in the
+ * router and valid until the next call to route(). Bundles without
+ * routed messages are dropped unless the whole packet is forwarded. Up
+ * to 64 backends are supported.
+ */
+class Router
+{
+public:
+    static const size_t kMaxBackends = 64;
+
+    //! Constructor.
+    /*!
+     * \throw std::invalid_argument more than kMaxBackends backends.
+     */
+    explicit Router(size_t numBackends)
+    : m_numBackends(numBackends)
+    {
+        if (numBackends > kMaxBackends)
+            throw std::invalid_argument("Too many router backends");
+    }
+
+    size_t numBackends() const
+    {
+        return m_numBackends;
+    }
+
+    //! Forward messages whose address starts with prefix to backend.
+    /*!
+     * Messages matching several routes are forwarded to each of their
+     * backends once; the empty prefix matches every message.
+     *
+     * \throw std::out_of_range invalid backend.
+     */
+    void addRoute(const std::string& prefix, size_t backend)
+    {
+        if (backend >= m_numBackends)
+            throw std::out_of_range("Invalid router backend");
+        m_routes.push_back(Route{prefix, uint64_t(1) << backend});
+    }
+
+    //! Route a packet.
+    /*!
+     * Calls emit(backend, fragments, numFragments, size) for every
+     * backend receiving any messages from packet, where size is the
+     * total size of the fragments. The fragments are valid until the
+     * next call to route().
+     *
+     * \throw OSCPP::ParseError, OSCPP::UnderrunError malformed packet.
+     */
+    template <typename Emit> void route(const Packet& packet, Emit emit)
+    {
+        m_nodes.clear();
+        const char* data = static_cast<const char*>(packet.data());
+        if (packet.isBundle())
+        {
+            addBundle(data, packet.size());
+        }
+        else
+        {
+            m_nodes.push_back(
+                Node{data, packet.size(), 1, matchMessage(data, packet.size()),
+                     0});
+            m_nodes.back().complete = m_nodes.back().mask;
+        }
+        const Node& root = m_nodes.front();
+        // Bundles need at most one size prefix each
+        m_words.resize(m_nodes.size());
+        for (size_t b = 0; b < m_numBackends; b++)
+        {
+            const uint64_t bit = uint64_t(1) << b;
+            if ((root.mask & bit) == 0)
+                continue;
+            m_fragments.clear();
+            size_t size;
+            if (root.complete & bit)
+            {
+                append(root.data, root.size);
+                size = root.size;
+            }
+            else
+            {
+                size_t numWords = 0;
+                size = appendBundle(0, bit, numWords);
+            }
+            emit(b, m_fragments.data(), m_fragments.size(), size);
+        }
+    }
+
+private:
+    struct Route
+    {
+        std::string prefix;
+        uint64_t    mask;
+    };
+
+    // Packet element in pre-order. data and size refer to the element
+    // itself, not including its size prefix.
+    struct Node
+    {
+        const char* data;
+        size_t      size;
+        size_t      end;      // Index after the last node of the subtree
+        uint64_t    mask;     // Backends receiving some messages
+        uint64_t    complete; // Backends receiving all messages
+    };
+
+    uint64_t matchMessage(const char* data, size_t size) const
+    {
+        // Validate the address without looking at the arguments
+        ReadStream  stream(data, size);
+        size_t      length;
+        const char* address = stream.getString(length);
+        if (!Packet::isMessage(data, size))
+            throw ParseError("Invalid message");
+        uint64_t mask = 0;
+        for (const Route& route : m_routes)
+        {
+            if (route.prefix.size() <= length &&
+                std::memcmp(address, route.prefix.data(),
+                            route.prefix.size()) == 0)
+                mask |= route.mask;
+        }
+        return mask;
+    }
+
+    // Add the nodes of a bundle and its elements, returning its index.
+    size_t addBundle(const char* data, size_t size)
+    {
+        const size_t index = m_nodes.size();
+        m_nodes.push_back(Node{data, size, 0, 0, ~uint64_t(0)});
+        PacketStream elements(ReadStream(data + 16, size - 16));
+        uint64_t     mask = 0;
+        uint64_t     complete = ~uint64_t(0);
+        while (!elements.atEnd())
+        {
+            const Packet element = elements.next();
+            const char*  elementData =
+                static_cast<const char*>(element.data());
+            if (element.isBundle())
+            {
+                const Node& node =
+                    m_nodes[addBundle(elementData, element.size())];
+                mask |= node.mask;
+                complete &= node.complete;
+            }
+            else
+            {
+                const uint64_t m = matchMessage(elementData, element.size());
+                m_nodes.push_back(
+                    Node{elementData, element.size(), m_nodes.size() + 1, m,
+                         m});
+                mask |= m;
+                complete &= m;
+            }
+        }
+        Node& node = m_nodes[index];
+        node.end = m_nodes.size();
+        node.mask = mask;
+        node.complete = complete;
+        return index;
+    }
+
+    void append(const void* data, size_t size)
+    {
+        if (!m_fragments.empty())
+        {
+            Fragment& last = m_fragments.back();
+            if (static_cast<const char*>(last.data) + last.size == data)
+            {
+                last.size += size;
+                return;
+            }
+        }
+        m_fragments.push_back(Fragment{data, size});
+    }
+
+    // Append the header and routed elements of the bundle at index and
+    // return its size.
+    size_t appendBundle(size_t index, uint64_t bit, size_t& numWords)
+    {
+        const Node& bundle = m_nodes[index];
+        size_t      size = 16;
+        append(bundle.data, 16);
+        for (size_t i = index + 1; i < bundle.end; i = m_nodes[i].end)
+        {
+            const Node& node = m_nodes[i];
+            if ((node.mask & bit) == 0)
+                continue;
+            if (node.complete & bit)
+            {
+                // Element with its original size prefix
+                append(node.data - 4, node.size + 4);
+                size += node.size + 4;
+            }
+            else
+            {
+                char* word = m_words[numWords++].bytes;
+                append(word, 4);
+                const size_t n = appendBundle(i, bit, numWords);
+                const uint32_t be = convert32<NetworkByteOrder>(
+                    static_cast<uint32_t>(n));
+                std::memcpy(word, &be, 4);
+                size += n + 4;
+            }
+        }
+        return size;
+    }
+
+    struct Word
+    {
+        char bytes[4];
+    };
+
+    size_t                m_numBackends;
+    std::vector<Route>    m_routes;
+    std::vector<Node>     m_nodes;
+    std::vector<Fragment> m_fragments;
+    std::vector<Word>     m_words;
+};
+
+}} // namespace OSCPP::Server
+
+#endif // OSCPP_ROUTER_HPP_INCLUDED
@@ -26,6 +26,8 @@
 #define OSCPP_SERVER_HPP_INCLUDED
 
 #include <oscpp/detail/stream.hpp>
+#include <oscpp/detail/tags.hpp>
+#include <oscpp/stats.hpp>
 #include <oscpp/util.hpp>
 
 #include <algorithm>
@@ -44,7 +46,17 @@ namespace OSCPP { namespace Server {
  *  i       -- 32 bit signed integer number<br>
  *  f       -- 32 bit floating point number<br>
  *  s       -- NULL-terminated string padded to 4-byte boundary<br>
- *  b       -- 32-bit integer size followed by 4-byte aligned data
+ *  b       -- 32-bit integer size followed by 4-byte aligned data<br>
+ *  T, F    -- boolean true and false, no data<br>
+ *  N       -- nil, no data<br>
+ *  I       -- infinitum, no data<br>
+ *  c       -- ASCII character sent as 32 bits<br>
+ *  r       -- 32 bit RGBA color<br>
+ *  m       -- 4 byte MIDI message<br>
+ *  S       -- symbol, encoded like a string<br>
+ *  h       -- 64 bit signed integer number<br>
+ *  t       -- 64 bit OSC time tag<br>
+ *  d       -- 64 bit floating point number
  *
  * \sa getArgInt32
  * \sa getArgFloat32
@@ -109,6 +121,67 @@ public:
         drop(m_tags.getChar());
     }
 
+    //! Drop all remaining arguments.
+    /*!
+     * Arguments whose size doesn't depend on their data are skipped in
+     * blocks of four tags and their sizes accumulated, so the argument
+     * stream is only touched for strings and blobs. Array markers are
+     * not checked for proper nesting.
+     *
+     * \throw OSCPP::UnderrunError stream buffer underrun.
+     * \throw OSCPP::ParseError invalid type tag or blob size.
+     */
+    void dropAll()
+    {
+        const char* tags = m_tags.pos();
+        const char* end = m_tags.end();
+        size_t      fixedSize = 0;
+        while (tags != end)
+        {
+            while (end - tags >= 4 &&
+                   detail::accumulateTags4(
+                       tags, detail::kTagSizeIndependent, fixedSize))
+            {
+                tags += 4;
+            }
+            if (tags == end)
+                break;
+
+            const detail::TagInfo& info = detail::tagInfo(*tags++);
+            if (info.kind & detail::kTagSizeIndependent)
+            {
+                fixedSize += info.size;
+            }
+            else
+            {
+                m_args.skip(fixedSize);
+                fixedSize = 0;
+                dropAtom(info);
+            }
+        }
+        m_args.skip(fixedSize);
+        m_tags.skip(m_tags.consumable());
+    }
+
+    //! Return the size in bytes of the remaining argument data.
+    /*!
+     * \throw OSCPP::UnderrunError stream buffer underrun.
+     * \throw OSCPP::ParseError invalid type tag or blob size.
+     */
+    size_t measure() const
+    {
+        ArgStream rest(*this);
+        const char* begin = rest.m_args.pos();
+        rest.dropAll();
+        return static_cast<size_t>(rest.m_args.pos() - begin);
+    }
+
+    //* Return a summary of the remaining type tags.
+    TagSummary summary() const
+    {
+        return summarizeTags(m_tags.pos(), m_tags.consumable());
+    }
+
     //! Get next integer argument.
     /*!
      * Read next numerical argument from the input stream and convert it
@@ -156,13 +229,106 @@ public:
      */
     const char* string()
     {
-        if (m_tags.getChar() == 's')
+        const char t = m_tags.getChar();
+        if (t == 's' || t == 'S')
         {
             return m_args.getString();
         }
         throw ParseError("Cannot convert argument to string");
     }
 
+    //* Get next symbol argument.
+    //
+    // Strings are accepted in place of symbols and vice versa.
+    //
+    // @throw OSCPP::UnderrunError stream buffer underrun.
+    // @throw OSCPP::ParseError argument is not a symbol or string.
+    const char* symbol()
+    {
+        const char t = m_tags.getChar();
+        if (t == 'S' || t == 's')
+        {
+            return m_args.getString();
+        }
+        throw ParseError("Cannot convert argument to symbol");
+    }
+
+    //* Get next boolean argument (tag 'T' or 'F').
+    //
+    // @throw OSCPP::UnderrunError stream buffer underrun.
+    // @throw OSCPP::ParseError argument is not a boolean.
+    bool boolean()
+    {
+        const char t = m_tags.getChar();
+        if (t == 'T')
+            return true;
+        if (t == 'F')
+            return false;
+        throw ParseError("Cannot convert argument to boolean");
+    }
+
+    //* Consume next nil argument (tag 'N').
+    void nil()
+    {
+        if (m_tags.getChar() != 'N')
+            throw ParseError("Expected nil");
+    }
+
+    //* Consume next infinitum argument (tag 'I').
+    void infinitum()
+    {
+        if (m_tags.getChar() != 'I')
+            throw ParseError("Expected infinitum");
+    }
+
+    //* Get next character argument (tag 'c').
+    char character()
+    {
+        if (m_tags.getChar() == 'c')
+            return static_cast<char>(m_args.getInt32());
+        throw ParseError("Cannot convert argument to character");
+    }
+
+    //* Get next RGBA color argument (tag 'r').
+    Rgba rgba()
+    {
+        if (m_tags.getChar() == 'r')
+            return Rgba(m_args.getUInt32());
+        throw ParseError("Cannot convert argument to RGBA color");
+    }
+
+    //* Get next MIDI message argument (tag 'm').
+    Midi midi()
+    {
+        if (m_tags.getChar() == 'm')
+            return Midi(m_args.getUInt32());
+        throw ParseError("Cannot convert argument to MIDI message");
+    }
+
+    //* Get next 64 bit integer argument (tag 'h').
+    int64_t int64()
+    {
+        if (m_tags.getChar() == 'h')
+            return static_cast<int64_t>(m_args.getUInt64());
+        throw ParseError("Cannot convert argument to int64");
+    }
+
+    //* Get next time tag argument (tag 't').
+    uint64_t timeTag()
+    {
+        if (m_tags.getChar() == 't')
+            return m_args.getUInt64();
+        throw ParseError("Cannot convert argument to time tag");
+    }
+
+    //* Get next double argument (tag 'd').
+    double float64()
+    {
+        if (m_tags.getChar() == 'd')
+            return m_args.getFloat64();
+        throw ParseError("Cannot convert argument to double");
+    }
+
     //* Get next blob argument.
     //
     // @throw OSCPP::UnderrunError stream buffer underrun.
@@ -221,24 +387,17 @@ private:
             return Blob(data, static_cast<size_t>(size));
         }
     }
-    // Drop an atomic value of type t (type tag already consumed).
-    void dropAtom(char t)
+    // Drop a value described by info, which must not be an array marker.
+    void dropAtom(const detail::TagInfo& info)
     {
-        switch (t)
-        {
-            case 'i':
-                m_args.skip(4);
-                break;
-            case 'f':
-                m_args.skip(4);
-                break;
-            case 's':
-                m_args.getString();
-                break;
-            case 'b':
-                parseBlob();
-                break;
-        }
+        if (info.kind == detail::kTagFixed)
+            m_args.skip(info.size);
+        else if (info.kind == detail::kTagString)
+            m_args.getString();
+        else if (info.kind == detail::kTagBlob)
+            parseBlob();
+        else
+            throw ParseError("Invalid type tag");
     }
     // Drop a possibly nested array.
     void dropArray()
@@ -246,35 +405,38 @@ private:
         unsigned int level = 0;
         for (;;)
         {
-            char t = m_tags.getChar();
-            if (t == ']')
+            const detail::TagInfo& info = detail::tagInfo(m_tags.getChar());
+            if (info.kind == detail::kTagFixed)
+            {
+                m_args.skip(info.size);
+            }
+            else if (info.kind == detail::kTagArrayEnd)
             {
                 if (level == 0)
                     break;
                 else
                     level--;
             }
-            else if (t == '[')
+            else if (info.kind == detail::kTagArrayBegin)
             {
                 level++;
             }
             else
             {
-                dropAtom(t);
+                dropAtom(info);
             }
         }
     }
     // Drop the next argument of type t (type tag already consumed).
     void drop(char t)
     {
-        switch (t)
-        {
-            case '[':
-                dropArray();
-                break;
-            default:
-                dropAtom(t);
-        }
+        const detail::TagInfo& info = detail::tagInfo(t);
+        if (info.kind == detail::kTagFixed)
+            m_args.skip(info.size);
+        else if (info.kind == detail::kTagArrayBegin)
+            dropArray();
+        else
+            dropAtom(info);
     }
 
 private:
@@ -287,21 +449,39 @@ class Message
 public:
     Message(const char* address, const ReadStream& stream)
     : m_address(address)
+    , m_addressLength(kUnknownLength)
     , m_args(ArgStream(stream))
     {}
 
+    //* Construct message from a parsed address and argument stream.
+    Message(const char* address, size_t addressLength, const ArgStream& args)
+    : m_address(address)
+    , m_addressLength(addressLength)
+    , m_args(args)
+    {}
+
     const char* address() const
     {
         return m_address;
     }
 
+    //* Return the length of the address string without the terminator.
+    size_t addressLength() const
+    {
+        return m_addressLength == kUnknownLength ? strlen(m_address)
+                                                 : m_addressLength;
+    }
+
     ArgStream args() const
     {
         return m_args;
     }
 
 private:
+    static const size_t kUnknownLength = static_cast<size_t>(-1);
+
     const char* m_address;
+    size_t      m_addressLength;
     ArgStream   m_args;
 };
 
@@ -310,9 +490,10 @@ class PacketStream;
 class Bundle
 {
 public:
-    Bundle(uint64_t time, const ReadStream& stream)
+    Bundle(uint64_t time, const ReadStream& stream, size_t depth = 0)
     : m_time(time)
     , m_stream(stream)
+    , m_depth(static_cast<uint32_t>(depth))
     {}
 
     uint64_t time() const
@@ -320,11 +501,18 @@ public:
         return m_time;
     }
 
+    //* Return the nesting depth, zero for a top-level bundle.
+    size_t depth() const
+    {
+        return m_depth;
+    }
+
     inline PacketStream packets() const;
 
 private:
     uint64_t   m_time;
     ReadStream m_stream;
+    uint32_t   m_depth;
 };
 
 class Packet
@@ -332,21 +520,31 @@ class Packet
 public:
     Packet()
     : m_isBundle(false)
+    , m_depth(0)
     {}
 
-    Packet(const ReadStream& stream)
-    : m_stream(stream)
-    , m_isBundle(isBundle(stream))
-    {
-        // Skip over #bundle header
-        if (m_isBundle)
-            m_stream.skip(8);
-    }
+    //* Construct a packet from a stream.
+    //
+    // depth is the number of enclosing bundles; top-level packets are
+    // counted as parsed when OSCPP_ENABLE_STATS is defined.
+    Packet(const ReadStream& stream, size_t depth = 0)
+    : Packet(stream, depth, depth == 0)
+    {}
 
     Packet(const void* data, size_t size)
     : Packet(ReadStream(data, size))
     {}
 
+    //* Construct a top-level packet without counting it as parsed.
+    //
+    // Used for packet data the library wraps again internally, e.g. when
+    // indexing a recorded packet or printing a built one, so that every
+    // packet is only counted where the application parses it.
+    static Packet view(const void* data, size_t size)
+    {
+        return Packet(ReadStream(data, size), 0, false);
+    }
+
     const void* data() const
     {
         return m_stream.begin();
@@ -367,22 +565,39 @@ public:
         return !isBundle();
     }
 
+    //* Return the number of enclosing bundles.
+    size_t depth() const
+    {
+        return m_depth;
+    }
+
     operator Bundle() const
     {
         if (!isBundle())
             throw ParseError("Packet is not a bundle");
         ReadStream stream(m_stream);
         uint64_t   time = stream.getUInt64();
-        return Bundle(time, std::move(stream));
+        Stats::countBundle(Stats::kParsed, m_depth);
+        return Bundle(time, std::move(stream), m_depth);
     }
 
     operator Message() const
     {
         if (!isMessage())
             throw ParseError("Packet is not a message");
+        // Scan address and type tags in a single pass and construct the
+        // argument stream from the lengths determined along the way.
         ReadStream  stream(m_stream);
-        const char* address = stream.getString();
-        return Message(address, std::move(stream));
+        size_t      addressLength;
+        const char* address = stream.getString(addressLength);
+        size_t      tagsLength;
+        const char* tags = stream.getString(tagsLength);
+        if (tags[0] != ',')
+            throw ParseError("Tag string doesn't start with ','");
+        Stats::countMessage(Stats::kParsed, tags + 1, tagsLength - 1);
+        return Message(address, addressLength,
+                       ArgStream(ReadStream(tags + 1, tagsLength - 1),
+                                 stream));
     }
 
     static bool isMessage(const void* data, size_t size)
@@ -406,15 +621,30 @@ public:
     }
 
 private:
+    Packet(const ReadStream& stream, size_t depth, bool count)
+    : m_stream(stream)
+    , m_isBundle(isBundle(stream))
+    , m_depth(static_cast<uint32_t>(depth))
+    {
+        // Skip over #bundle header
+        if (m_isBundle)
+            m_stream.skip(8);
+        if (count)
+            Stats::countPacket(Stats::kParsed, m_stream.capacity());
+    }
+
     ReadStream m_stream;
     bool       m_isBundle;
+    uint32_t   m_depth;
 };
 
 class PacketStream
 {
 public:
-    PacketStream(const ReadStream& stream)
+    //* Construct a stream of bundle elements nested depth bundles deep.
+    PacketStream(const ReadStream& stream, size_t depth = 1)
     : m_stream(stream)
+    , m_depth(static_cast<uint32_t>(depth))
     {}
 
     bool atEnd() const
@@ -422,16 +652,25 @@ public:
         return m_stream.atEnd();
     }
 
+    //! Return the next bundle element.
+    /*!
+     * \throw OSCPP::UnderrunError stream buffer underrun.
+     * \throw OSCPP::ParseError element size is negative or not a
+     * multiple of four.
+     */
     Packet next()
     {
-        size_t     size = m_stream.getInt32();
-        ReadStream stream(m_stream, size);
-        m_stream.skip(size);
-        return Packet(stream);
+        const int32_t size = m_stream.getInt32();
+        if (size < 0 || !isAligned(static_cast<size_t>(size)))
+            throw ParseError("Invalid bundle element size");
+        ReadStream stream(m_stream, static_cast<size_t>(size));
+        m_stream.skip(static_cast<size_t>(size));
+        return Packet(stream, m_depth);
     }
 
 private:
     ReadStream m_stream;
+    uint32_t   m_depth;
 };
 
 template <> inline int32_t ArgStream::next<int32_t>()
@@ -449,6 +688,16 @@ template <> inline const char* ArgStream::next<const char*>()
     return string();
 }
 
+template <> inline int64_t ArgStream::next<int64_t>()
+{
+    return int64();
+}
+
+template <> inline double ArgStream::next<double>()
+{
+    return float64();
+}
+
 template <> inline Blob ArgStream::next<Blob>()
 {
     return blob();
@@ -459,9 +708,29 @@ template <> inline ArgStream ArgStream::next<ArgStream>()
     return array();
 }
 
+template <> inline bool ArgStream::next<bool>()
+{
+    return boolean();
+}
+
+template <> inline char ArgStream::next<char>()
+{
+    return character();
+}
+
+template <> inline Rgba ArgStream::next<Rgba>()
+{
+    return rgba();
+}
+
+template <> inline Midi ArgStream::next<Midi>()
+{
+    return midi();
+}
+
 PacketStream Bundle::packets() const
 {
-    return PacketStream(m_stream);
+    return PacketStream(m_stream, m_depth + 1);
 }
 
 }} // namespace OSCPP::Server
@@ -0,0 +1,250 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_SPLIT_HPP_INCLUDED
+#define OSCPP_SPLIT_HPP_INCLUDED
+
+#include <oscpp/client.hpp>
+#include <oscpp/error.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace OSCPP { namespace Client {
+
+//! Bundle construction split into datagrams of limited size.
+/*!
+ * Builds bundles like Client::Packet, but starts a new datagram
+ * whenever the next element would exceed the size limit: the open
+ * bundles are closed, the datagram is passed to the sink and the chain
+ * of open bundles is reopened with the same time tags in the next
+ * datagram, where the element is written again. Bundles that would be
+ * left empty by a split are dropped from the datagram being sent.
+ *
+ * The sink is called as sink(const void* data, size_t size) with a
+ * pointer into the writer's buffer, which is valid until the call
+ * returns. A datagram is emitted for every split and when the
+ * outermost bundle is closed; a message added outside of a bundle is
+ * emitted as a datagram of its own.
+ */
+template <typename Sink> class SplitWriter
+{
+public:
+    //! Constructor.
+    /*!
+     * \param sink Datagram sink.
+     * \param limit Maximum datagram size in bytes.
+     */
+    SplitWriter(Sink sink, size_t limit)
+    : m_sink(sink)
+    , m_limit(limit & ~size_t(3))
+    , m_buffer(new char[m_limit])
+    , m_packet(m_buffer.get(), m_limit)
+    , m_numUsed(0)
+    , m_numPackets(0)
+    {}
+
+    SplitWriter(const SplitWriter&) = delete;
+    SplitWriter& operator=(const SplitWriter&) = delete;
+
+    //! Open a bundle.
+    /*!
+     * \throw OSCPP::OverflowError the chain of open bundles doesn't fit
+     * into the size limit.
+     */
+    SplitWriter& openBundle(uint64_t time)
+    {
+        if (m_bundles.empty())
+            m_packet.reset();
+        const Packet::Mark mark = m_packet.mark();
+        try
+        {
+            m_packet.openBundle(time);
+        }
+        catch (OverflowError&)
+        {
+            m_packet.rewind(mark);
+            const Packet::Mark mark2 = split();
+            try
+            {
+                m_packet.openBundle(time);
+            }
+            catch (OverflowError&)
+            {
+                abort();
+                throw;
+            }
+            m_bundles.push_back(Bundle{time, mark2});
+            return *this;
+        }
+        m_bundles.push_back(Bundle{time, mark});
+        return *this;
+    }
+
+    //! Close the innermost open bundle, emitting the datagram when it is
+    //! the outermost one.
+    SplitWriter& closeBundle()
+    {
+        if (m_bundles.empty())
+            throw std::logic_error(
+                "closeBundle() without matching openBundle()");
+        m_packet.closeBundle();
+        m_bundles.pop_back();
+        // The parent now has content in this datagram
+        m_numUsed = m_bundles.size();
+        if (m_bundles.empty())
+            emit();
+        return *this;
+    }
+
+    //! Add a message.
+    /*!
+     * Calls build(packet), which has to write a single message (or
+     * bundle) to the packet, splitting the current datagram first if
+     * the message doesn't fit.
+     *
+     * \throw OSCPP::OverflowError message doesn't fit into a datagram
+     * by itself, together with the open bundles.
+     */
+    template <typename Builder> SplitWriter& add(Builder build)
+    {
+        if (m_bundles.empty())
+        {
+            m_packet.reset();
+            build(m_packet);
+            emit();
+            return *this;
+        }
+        const Packet::Mark mark = m_packet.mark();
+        try
+        {
+            build(m_packet);
+        }
+        catch (OverflowError&)
+        {
+            m_packet.rewind(mark);
+            split();
+            try
+            {
+                build(m_packet);
+            }
+            catch (OverflowError&)
+            {
+                abort();
+                throw;
+            }
+        }
+        m_numUsed = m_bundles.size();
+        return *this;
+    }
+
+    //! Number of open bundles.
+    size_t depth() const
+    {
+        return m_bundles.size();
+    }
+
+    //! Maximum datagram size, rounded down to a multiple of four.
+    size_t limit() const
+    {
+        return m_limit;
+    }
+
+    //! Number of datagrams emitted.
+    uint64_t numPackets() const
+    {
+        return m_numPackets;
+    }
+
+private:
+    struct Bundle
+    {
+        uint64_t     time;
+        Packet::Mark mark; // Position of the bundle in the datagram
+    };
+
+    void emit()
+    {
+        const size_t size = m_packet.size();
+        m_numPackets++;
+        m_packet.reset();
+        m_sink(static_cast<const char*>(m_packet.data()), size);
+    }
+
+    // Emit the bundles written so far and reopen the chain of open
+    // bundles in a new datagram; called while handling an
+    // OverflowError, which is rethrown if splitting doesn't free any
+    // space. Returns the position after the reopened bundles.
+    Packet::Mark split()
+    {
+        if (m_numUsed == 0)
+        {
+            // Nothing but open bundles in this datagram
+            abort();
+            throw;
+        }
+        if (m_numUsed < m_bundles.size())
+            m_packet.rewind(m_bundles[m_numUsed].mark);
+        for (size_t i = 0; i < m_numUsed; i++)
+            m_packet.closeBundle();
+        emit();
+        m_numUsed = 0;
+        try
+        {
+            for (Bundle& bundle : m_bundles)
+            {
+                bundle.mark = m_packet.mark();
+                m_packet.openBundle(bundle.time);
+            }
+        }
+        catch (OverflowError&)
+        {
+            abort();
+            throw;
+        }
+        return m_packet.mark();
+    }
+
+    // Discard the open bundles after an error.
+    void abort()
+    {
+        m_bundles.clear();
+        m_numUsed = 0;
+        m_packet.reset();
+    }
+
+    Sink                    m_sink;
+    size_t                  m_limit;
+    std::unique_ptr<char[]> m_buffer;
+    Packet                  m_packet;
+    std::vector<Bundle>     m_bundles;
+    size_t                  m_numUsed; // Open bundles with content
+    uint64_t                m_numPackets;
+};
+
+}} // namespace OSCPP::Client
+
+#endif // OSCPP_SPLIT_HPP_INCLUDED
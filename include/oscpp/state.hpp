@@ -0,0 +1,322 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_STATE_HPP_INCLUDED
+#define OSCPP_STATE_HPP_INCLUDED
+
+#include <oscpp/client.hpp>
+#include <oscpp/server.hpp>
+#include <oscpp/symbol.hpp>
+#include <oscpp/util.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <tuple>
+
+namespace OSCPP { namespace Server {
+
+//! Latest message arguments by address.
+/*!
+ * Stores the type tags and argument data of the last message received
+ * for each address, so that consumers interested only in the current
+ * state don't need to see every message. A single writer thread calls
+ * update(); any number of reader threads call read() and snapshot()
+ * concurrently without locking.
+ *
+ * Addresses are interned in a ConcurrentSymbolTable and each has a
+ * value slot of fixed size, allocated on construction. Slots are
+ * guarded by sequence locks: the writer makes the sequence number odd
+ * while it copies a value, and readers copy the value and retry if the
+ * sequence number was odd or has changed meanwhile. Readers never block
+ * the writer; they can only be delayed by updates of the address they
+ * read. Values are stored as atomic words, so that concurrent copies
+ * are well-defined.
+ */
+class StateStore
+{
+public:
+    //! Reader-side copy of a value.
+    class Value
+    {
+    public:
+        //! Allocate a copy buffer for values of store.
+        explicit Value(const StateStore& store)
+        : m_words(new uint32_t[store.m_numWords])
+        , m_size(0)
+        , m_version(0)
+        {}
+
+        //! Arguments of the value, valid until the next read into it.
+        /*!
+         * \throw OSCPP::ParseError, OSCPP::UnderrunError malformed
+         * value.
+         */
+        ArgStream args() const
+        {
+            return ArgStream(ReadStream(m_words.get(), m_size));
+        }
+
+        //! Type tags (starting with ',') and argument data.
+        const void* data() const
+        {
+            return m_words.get();
+        }
+
+        size_t size() const
+        {
+            return m_size;
+        }
+
+        //! Number of updates of the address, including this one.
+        uint64_t version() const
+        {
+            return m_version;
+        }
+
+    private:
+        friend class StateStore;
+
+        std::unique_ptr<uint32_t[]> m_words;
+        size_t                      m_size;
+        uint64_t                    m_version;
+    };
+
+    //! Constructor.
+    /*!
+     * \param maxAddresses Maximum number of addresses.
+     * \param maxValueSize Maximum size in bytes of the type tags and
+     * argument data of a message, rounded up to a multiple of four.
+     */
+    StateStore(size_t maxAddresses, size_t maxValueSize)
+    : m_symbols(maxAddresses)
+    , m_numWords(align(maxValueSize) / 4)
+    , m_slots(new Slot[maxAddresses])
+    , m_words(new std::atomic<uint32_t>[maxAddresses * m_numWords])
+    , m_numOversized(0)
+    {
+        for (size_t i = 0; i < maxAddresses; i++)
+        {
+            m_slots[i].sequence.store(0, std::memory_order_relaxed);
+            m_slots[i].size.store(0, std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < maxAddresses * m_numWords; i++)
+            m_words[i].store(0, std::memory_order_relaxed);
+    }
+
+    StateStore(const StateStore&) = delete;
+    StateStore& operator=(const StateStore&) = delete;
+
+    //! \name Writer
+    //@{
+
+    //! Store the arguments of a message.
+    /*!
+     * Returns false if the type tags and arguments are larger than
+     * the maximum value size, in which case the message is ignored.
+     * Must not be called concurrently with itself.
+     *
+     * \throw std::length_error maximum number of addresses exceeded.
+     * \throw OSCPP::ParseError, OSCPP::UnderrunError malformed message.
+     */
+    bool update(const Message& msg)
+    {
+        // Type tags (including the leading ',') and arguments
+        ReadStream tags, args;
+        std::tie(tags, args) = msg.args().state();
+        const char*  value = tags.begin() - 1;
+        const size_t size = static_cast<size_t>(args.end() - value);
+        if (size > 4 * m_numWords)
+        {
+            m_numOversized++;
+            return false;
+        }
+
+        const Symbol symbol =
+            m_symbols.intern(msg.address(), msg.addressLength());
+        Slot&                  slot = m_slots[symbol];
+        std::atomic<uint32_t>* words = m_words.get() + symbol * m_numWords;
+
+        const uint32_t sequence =
+            slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < size / 4; i++)
+        {
+            uint32_t w;
+            std::memcpy(&w, value + 4 * i, 4);
+            words[i].store(w, std::memory_order_relaxed);
+        }
+        slot.size.store(static_cast<uint32_t>(size),
+                        std::memory_order_relaxed);
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+        return true;
+    }
+
+    //! Store the arguments of all messages in a packet.
+    /*!
+     * Returns the number of messages stored.
+     *
+     * \throw std::length_error maximum number of addresses exceeded.
+     * \throw OSCPP::ParseError, OSCPP::UnderrunError malformed packet.
+     */
+    size_t updateAll(const Packet& packet)
+    {
+        if (packet.isMessage())
+            return update(packet) ? 1 : 0;
+        size_t       n = 0;
+        PacketStream elements(Bundle(packet).packets());
+        while (!elements.atEnd())
+            n += updateAll(elements.next());
+        return n;
+    }
+
+    //@}
+
+    //! \name Readers
+    //@{
+
+    //! Return the symbol of an address, or kNoSymbol if it hasn't been
+    //! stored.
+    Symbol lookup(const char* address, size_t length) const
+    {
+        return m_symbols.lookup(address, length);
+    }
+
+    Symbol lookup(const char* address) const
+    {
+        return m_symbols.lookup(address);
+    }
+
+    //! Number of addresses stored.
+    size_t size() const
+    {
+        return m_symbols.size();
+    }
+
+    const char* address(Symbol symbol) const
+    {
+        return m_symbols.name(symbol);
+    }
+
+    //! Copy the latest value of an address.
+    /*!
+     * Returns false if no value has been stored for the address.
+     */
+    bool read(Symbol symbol, Value& value) const
+    {
+        if (symbol == kNoSymbol || symbol >= size())
+            return false;
+        const Slot&                  slot = m_slots[symbol];
+        const std::atomic<uint32_t>* words =
+            m_words.get() + symbol * m_numWords;
+        for (;;)
+        {
+            const uint32_t before =
+                slot.sequence.load(std::memory_order_acquire);
+            if (before == 0)
+                return false;
+            if (before & 1)
+                continue;
+            const size_t size = slot.size.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < size / 4; i++)
+                value.m_words[i] = words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == before)
+            {
+                value.m_size = size;
+                value.m_version = before / 2;
+                return true;
+            }
+        }
+    }
+
+    bool read(const char* address, size_t length, Value& value) const
+    {
+        return read(lookup(address, length), value);
+    }
+
+    bool read(const char* address, Value& value) const
+    {
+        return read(lookup(address), value);
+    }
+
+    //! Write the latest values of all addresses as a bundle.
+    /*!
+     * Each address contributes a message with its latest value at the
+     * time it is read; updates during the snapshot may or may not be
+     * included. Returns the number of messages written.
+     *
+     * \throw OSCPP::OverflowError packet buffer too small.
+     */
+    size_t snapshot(Client::Packet& packet, uint64_t time = 1) const
+    {
+        Value        value(*this);
+        const size_t numAddresses = size();
+        size_t       n = 0;
+        packet.openBundle(time);
+        for (Symbol symbol = 0; symbol < numAddresses; symbol++)
+        {
+            if (!read(symbol, value))
+                continue;
+            // Tags are followed by at least one NUL
+            const char*  tags = static_cast<const char*>(value.data()) + 1;
+            const size_t numTags = std::strlen(tags);
+            const size_t tagsSize = align(numTags + 2);
+            packet.putMessage(m_symbols.name(symbol),
+                              m_symbols.length(symbol), tags, numTags,
+                              tags - 1 + tagsSize, value.size() - tagsSize);
+            n++;
+        }
+        packet.closeBundle();
+        return n;
+    }
+
+    //@}
+
+    //! Number of messages ignored because their value was too large.
+    uint64_t numOversized() const
+    {
+        return m_numOversized;
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint32_t> sequence; // Odd while the value is written
+        std::atomic<uint32_t> size;     // Value size in bytes
+    };
+
+    ConcurrentSymbolTable                    m_symbols;
+    size_t                                   m_numWords;
+    std::unique_ptr<Slot[]>                  m_slots;
+    std::unique_ptr<std::atomic<uint32_t>[]> m_words;
+    uint64_t                                 m_numOversized;
+};
+
+}} // namespace OSCPP::Server
+
+#endif // OSCPP_STATE_HPP_INCLUDED
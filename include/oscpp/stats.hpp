@@ -0,0 +1,372 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_STATS_HPP_INCLUDED
+#define OSCPP_STATS_HPP_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+//! \file
+//! Library instrumentation.
+/*!
+ * When OSCPP_ENABLE_STATS is defined, packet construction, parsing and
+ * error reporting update counters that can be collected with
+ * OSCPP::Stats::collect(). Otherwise the hooks are empty inline
+ * functions and collect() returns zeros. The macro has to be defined
+ * consistently in all translation units of a program.
+ *
+ * Every thread updates its own counter block, which is padded to a
+ * cache line and written with plain stores; collect() sums all blocks
+ * without synchronizing with the writers. Blocks are never freed: a
+ * block released by an exiting thread is reused by the next thread
+ * that starts counting, so totals are preserved.
+ */
+
+namespace OSCPP { namespace Stats {
+
+//! Scalar counters.
+enum Counter
+{
+    kPacketsBuilt,   //!< Top-level packets completed by Client::Packet
+    kMessagesBuilt,  //!< Messages closed by Client::Packet
+    kBundlesBuilt,   //!< Bundles opened by Client::Packet
+    kBytesBuilt,     //!< Size of completed top-level packets
+    kPacketsParsed,  //!< Top-level Server::Packet objects constructed
+    kMessagesParsed, //!< Conversions of Server::Packet to Message
+    kBundlesParsed,  //!< Conversions of Server::Packet to Bundle
+    kBytesParsed,    //!< Size of parsed top-level packets
+    kUnderrunErrors, //!< UnderrunError exceptions constructed
+    kOverflowErrors, //!< OverflowError exceptions constructed
+    kParseErrors,    //!< ParseError exceptions constructed
+    kNumCounters
+};
+
+//! Direction of a packet, used to select a histogram.
+enum Direction
+{
+    kBuilt,
+    kParsed,
+    kNumDirections
+};
+
+//! Number of bundle depth buckets; the last bucket collects all deeper
+//! bundles.
+static const size_t kMaxBundleDepth = 8;
+
+//! Number of type tag buckets, indexed by the 7-bit tag character.
+static const size_t kNumTags = 128;
+
+//! Aggregated counter values.
+struct Snapshot
+{
+    Snapshot()
+    {
+        for (size_t i = 0; i < kNumCounters; i++)
+            counters[i] = 0;
+        for (size_t d = 0; d < kNumDirections; d++)
+        {
+            for (size_t i = 0; i < kMaxBundleDepth; i++)
+                bundleDepth[d][i] = 0;
+            for (size_t i = 0; i < kNumTags; i++)
+                tags[d][i] = 0;
+        }
+    }
+
+    //! Return the value of a scalar counter.
+    uint64_t operator[](Counter c) const
+    {
+        return counters[c];
+    }
+
+    //! Return the number of bundles seen at a nesting depth, where
+    //! top-level bundles have depth zero.
+    uint64_t bundlesAtDepth(Direction dir, size_t depth) const
+    {
+        return bundleDepth[dir][depth < kMaxBundleDepth ? depth
+                                                        : kMaxBundleDepth - 1];
+    }
+
+    //! Return the number of arguments with type tag t.
+    uint64_t tagCount(Direction dir, char t) const
+    {
+        return tags[dir][static_cast<unsigned char>(t) & (kNumTags - 1)];
+    }
+
+    //! Return the counts accumulated since an earlier snapshot.
+    Snapshot operator-(const Snapshot& other) const
+    {
+        Snapshot result(*this);
+        for (size_t i = 0; i < kNumCounters; i++)
+            result.counters[i] -= other.counters[i];
+        for (size_t d = 0; d < kNumDirections; d++)
+        {
+            for (size_t i = 0; i < kMaxBundleDepth; i++)
+                result.bundleDepth[d][i] -= other.bundleDepth[d][i];
+            for (size_t i = 0; i < kNumTags; i++)
+                result.tags[d][i] -= other.tags[d][i];
+        }
+        return result;
+    }
+
+    uint64_t counters[kNumCounters];
+    uint64_t bundleDepth[kNumDirections][kMaxBundleDepth];
+    uint64_t tags[kNumDirections][kNumTags];
+};
+
+//! True if the library was compiled with instrumentation.
+#if defined(OSCPP_ENABLE_STATS)
+static const bool kEnabled = true;
+#else
+static const bool kEnabled = false;
+#endif
+
+#if defined(OSCPP_ENABLE_STATS)
+
+namespace detail {
+
+static const size_t kCacheLineSize = 64;
+
+// Counter block owned by a single thread. Only the owner writes, so an
+// increment is a relaxed load and store instead of a locked add.
+class ThreadCounters
+{
+public:
+    ThreadCounters()
+    : m_next(nullptr)
+    , m_inUse(true)
+    {
+        for (size_t i = 0; i < kNumValues; i++)
+            m_values[i].store(0, std::memory_order_relaxed);
+    }
+
+    void add(size_t i, uint64_t n)
+    {
+        m_values[i].store(m_values[i].load(std::memory_order_relaxed) + n,
+                          std::memory_order_relaxed);
+    }
+
+    void addTo(Snapshot& s) const
+    {
+        size_t i = 0;
+        for (size_t c = 0; c < kNumCounters; c++)
+            s.counters[c] += load(i++);
+        for (size_t d = 0; d < kNumDirections; d++)
+            for (size_t k = 0; k < kMaxBundleDepth; k++)
+                s.bundleDepth[d][k] += load(i++);
+        for (size_t d = 0; d < kNumDirections; d++)
+            for (size_t k = 0; k < kNumTags; k++)
+                s.tags[d][k] += load(i++);
+    }
+
+    static size_t depthIndex(Direction dir, size_t depth)
+    {
+        return kNumCounters + dir * kMaxBundleDepth +
+               (depth < kMaxBundleDepth ? depth : kMaxBundleDepth - 1);
+    }
+
+    static size_t tagIndex(Direction dir, char t)
+    {
+        return kNumCounters + kNumDirections * kMaxBundleDepth +
+               dir * kNumTags + (static_cast<unsigned char>(t) & (kNumTags - 1));
+    }
+
+    ThreadCounters* next() const
+    {
+        return m_next;
+    }
+
+    bool tryAcquire()
+    {
+        bool expected = false;
+        return m_inUse.compare_exchange_strong(expected, true,
+                                               std::memory_order_acquire);
+    }
+
+    void release()
+    {
+        m_inUse.store(false, std::memory_order_release);
+    }
+
+    // Push a new block onto the global list.
+    static ThreadCounters* create(std::atomic<ThreadCounters*>& head)
+    {
+        // Blocks are never freed, so the unaligned allocation is simply
+        // leaked along with the aligned block inside it.
+        char* raw = static_cast<char*>(
+            ::operator new(sizeof(ThreadCounters) + kCacheLineSize));
+        void* aligned =
+            raw + (kCacheLineSize -
+                   reinterpret_cast<uintptr_t>(raw) % kCacheLineSize);
+        ThreadCounters* block = new (aligned) ThreadCounters;
+        ThreadCounters* next = head.load(std::memory_order_relaxed);
+        do
+        {
+            block->m_next = next;
+        } while (!head.compare_exchange_weak(next, block,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed));
+        return block;
+    }
+
+private:
+    static const size_t kNumValues = kNumCounters +
+                                     kNumDirections * kMaxBundleDepth +
+                                     kNumDirections * kNumTags;
+
+    uint64_t load(size_t i) const
+    {
+        return m_values[i].load(std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> m_values[kNumValues];
+    ThreadCounters*       m_next;
+    std::atomic<bool>     m_inUse;
+    // Keep the next allocation off the last cache line.
+    char m_padding[kCacheLineSize];
+};
+
+template <typename T = void> struct Registry
+{
+    static std::atomic<ThreadCounters*> head;
+};
+
+template <typename T>
+std::atomic<ThreadCounters*> Registry<T>::head(nullptr);
+
+// Claims a counter block for the current thread and releases it when the
+// thread exits.
+class ThreadHandle
+{
+public:
+    ThreadHandle()
+    {
+        std::atomic<ThreadCounters*>& head = Registry<>::head;
+        for (ThreadCounters* b = head.load(std::memory_order_acquire);
+             b != nullptr; b = b->next())
+        {
+            if (b->tryAcquire())
+            {
+                m_counters = b;
+                return;
+            }
+        }
+        m_counters = ThreadCounters::create(head);
+    }
+
+    ~ThreadHandle()
+    {
+        m_counters->release();
+    }
+
+    ThreadHandle(const ThreadHandle&) = delete;
+    ThreadHandle& operator=(const ThreadHandle&) = delete;
+
+    ThreadCounters& counters() const
+    {
+        return *m_counters;
+    }
+
+private:
+    ThreadCounters* m_counters;
+};
+
+inline ThreadCounters& local()
+{
+    static thread_local ThreadHandle handle;
+    return handle.counters();
+}
+
+} // namespace detail
+
+//! Return the sum of the counters of all threads.
+inline Snapshot collect()
+{
+    Snapshot s;
+    for (const detail::ThreadCounters* b =
+             detail::Registry<>::head.load(std::memory_order_acquire);
+         b != nullptr; b = b->next())
+    {
+        b->addTo(s);
+    }
+    return s;
+}
+
+//* Increment a scalar counter.
+inline void count(Counter c, uint64_t n = 1)
+{
+    detail::local().add(c, n);
+}
+
+//* Record a completed or parsed top-level packet.
+inline void countPacket(Direction dir, size_t size)
+{
+    detail::ThreadCounters& c = detail::local();
+    c.add(dir == kBuilt ? kPacketsBuilt : kPacketsParsed, 1);
+    c.add(dir == kBuilt ? kBytesBuilt : kBytesParsed, size);
+}
+
+//* Record a bundle at the given nesting depth.
+inline void countBundle(Direction dir, size_t depth)
+{
+    detail::ThreadCounters& c = detail::local();
+    c.add(dir == kBuilt ? kBundlesBuilt : kBundlesParsed, 1);
+    c.add(detail::ThreadCounters::depthIndex(dir, depth), 1);
+}
+
+//* Record a message and its type tags (without the leading ',').
+inline void countMessage(Direction dir, const char* tags, size_t numTags)
+{
+    detail::ThreadCounters& c = detail::local();
+    c.add(dir == kBuilt ? kMessagesBuilt : kMessagesParsed, 1);
+    for (size_t i = 0; i < numTags; i++)
+        c.add(detail::ThreadCounters::tagIndex(dir, tags[i]), 1);
+}
+
+#else // OSCPP_ENABLE_STATS
+
+inline Snapshot collect()
+{
+    return Snapshot();
+}
+
+inline void count(Counter, uint64_t = 1)
+{}
+
+inline void countPacket(Direction, size_t)
+{}
+
+inline void countBundle(Direction, size_t)
+{}
+
+inline void countMessage(Direction, const char*, size_t)
+{}
+
+#endif // OSCPP_ENABLE_STATS
+
+}} // namespace OSCPP::Stats
+
+#endif // OSCPP_STATS_HPP_INCLUDED
@@ -0,0 +1,337 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_SYMBOL_HPP_INCLUDED
+#define OSCPP_SYMBOL_HPP_INCLUDED
+
+#include <oscpp/util.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace OSCPP {
+
+//! Small integer identifier of an interned string.
+typedef uint32_t Symbol;
+
+//! Symbol returned by lookups of strings that haven't been interned.
+static const Symbol kNoSymbol = 0xFFFFFFFF;
+
+namespace detail {
+
+inline uint64_t loadWord64(const char* p)
+{
+    uint64_t w;
+    std::memcpy(&w, p, 8);
+    return w;
+}
+
+inline uint32_t loadWord32(const char* p)
+{
+    uint32_t w;
+    std::memcpy(&w, p, 4);
+    return w;
+}
+
+inline uint64_t hashMix(uint64_t h, uint64_t w)
+{
+    h = (h ^ w) * 0x9E3779B97F4A7C15ull;
+    return h ^ (h >> 32);
+}
+
+//! Hash a string of known length.
+/*!
+ * The string is read in 8-byte words; a trailing partial word is read
+ * as a word overlapping the previous one, or for short strings with
+ * 4-byte or single byte loads, so that only bytes of the string itself
+ * are accessed and the string doesn't need to be padded.
+ */
+inline uint32_t hashString(const char* str, size_t length)
+{
+    uint64_t h = hashMix(0, length);
+    if (length >= 8)
+    {
+        const size_t numWords = length / 8;
+        for (size_t i = 0; i < numWords; i++)
+            h = hashMix(h, loadWord64(str + 8 * i));
+        if (length & 7)
+            h = hashMix(h, loadWord64(str + length - 8));
+    }
+    else if (length >= 4)
+    {
+        h = hashMix(h, (uint64_t(loadWord32(str)) << 32) |
+                           loadWord32(str + length - 4));
+    }
+    else if (length > 0)
+    {
+        const unsigned char* u = reinterpret_cast<const unsigned char*>(str);
+        h = hashMix(h, (uint64_t(u[0]) << 16) | (uint64_t(u[length / 2]) << 8) |
+                           u[length - 1]);
+    }
+    return static_cast<uint32_t>(h ^ (h >> 29));
+}
+
+//! Compare two byte ranges of equal length for equality.
+/*!
+ * Like hashString, compares 8-byte words and finishes with an
+ * overlapping word instead of calling memcmp.
+ */
+inline bool equalBytes(const char* a, const char* b, size_t length)
+{
+    if (length >= 8)
+    {
+        const size_t last = length - 8;
+        for (size_t i = 0; i < last; i += 8)
+        {
+            if (loadWord64(a + i) != loadWord64(b + i))
+                return false;
+        }
+        return loadWord64(a + last) == loadWord64(b + last);
+    }
+    else if (length >= 4)
+    {
+        return loadWord32(a) == loadWord32(b) &&
+               loadWord32(a + length - 4) == loadWord32(b + length - 4);
+    }
+    for (size_t i = 0; i < length; i++)
+    {
+        if (a[i] != b[i])
+            return false;
+    }
+    return true;
+}
+
+// Open addressing hash table from strings to dense symbol ids. Slots are
+// atomic so that lookups can run concurrently with a single writer;
+// entries are immutable once published.
+class SymbolTableBase
+{
+public:
+    SymbolTableBase(size_t maxSymbols)
+    : m_entries(maxSymbols)
+    , m_size(0)
+    {
+        size_t numSlots = 8;
+        m_shift = 61;
+        while (numSlots < 2 * maxSymbols)
+        {
+            numSlots *= 2;
+            m_shift--;
+        }
+        m_mask = numSlots - 1;
+        m_slots.reset(new std::atomic<uint32_t>[numSlots]);
+        for (size_t i = 0; i < numSlots; i++)
+            m_slots[i].store(0, std::memory_order_relaxed);
+    }
+
+    //! Return the number of interned strings.
+    size_t size() const
+    {
+        return m_size.load(std::memory_order_acquire);
+    }
+
+    //! Return the maximum number of strings that can be interned.
+    size_t capacity() const
+    {
+        return m_entries.size();
+    }
+
+    //! Return the symbol for a string, or kNoSymbol if it hasn't been
+    //! interned.
+    Symbol lookup(const char* str, size_t length) const
+    {
+        const uint32_t hash = hashString(str, length);
+        for (size_t i = firstSlot(hash);; i = (i + 1) & m_mask)
+        {
+            const uint32_t slot = m_slots[i].load(std::memory_order_acquire);
+            if (slot == 0)
+                return kNoSymbol;
+            const Entry& e = m_entries[slot - 1];
+            if (e.hash == hash && e.length == length &&
+                equalBytes(e.data.get(), str, length))
+            {
+                return slot - 1;
+            }
+        }
+    }
+
+    Symbol lookup(const char* str) const
+    {
+        return lookup(str, std::strlen(str));
+    }
+
+    //! Return the string corresponding to an interned symbol.
+    const char* name(Symbol symbol) const
+    {
+        return m_entries[symbol].data.get();
+    }
+
+    //! Return the length of the string corresponding to a symbol.
+    size_t length(Symbol symbol) const
+    {
+        return m_entries[symbol].length;
+    }
+
+protected:
+    // Must not be called concurrently with itself.
+    Symbol insert(const char* str, size_t length)
+    {
+        const uint32_t hash = hashString(str, length);
+        size_t         i = firstSlot(hash);
+        for (;; i = (i + 1) & m_mask)
+        {
+            const uint32_t slot = m_slots[i].load(std::memory_order_relaxed);
+            if (slot == 0)
+                break;
+            const Entry& e = m_entries[slot - 1];
+            if (e.hash == hash && e.length == length &&
+                equalBytes(e.data.get(), str, length))
+            {
+                return slot - 1;
+            }
+        }
+
+        const size_t id = m_size.load(std::memory_order_relaxed);
+        if (id == m_entries.size())
+            throw std::length_error("Symbol table capacity exceeded");
+
+        // Store a zero-padded copy, so that names are valid OSC strings.
+        Entry& e = m_entries[id];
+        e.data.reset(new char[align(length + 1)]());
+        std::memcpy(e.data.get(), str, length);
+        e.length = length;
+        e.hash = hash;
+
+        m_slots[i].store(static_cast<uint32_t>(id + 1),
+                         std::memory_order_release);
+        m_size.store(id + 1, std::memory_order_release);
+        return static_cast<Symbol>(id);
+    }
+
+private:
+    // The low bits of hashString cluster for strings differing only in
+    // their last characters, so take the slot from the high bits of a
+    // multiplicative remix.
+    size_t firstSlot(uint32_t hash) const
+    {
+        return static_cast<size_t>((hash * 0x9E3779B97F4A7C15ull) >> m_shift);
+    }
+
+    struct Entry
+    {
+        std::unique_ptr<char[]> data;
+        size_t                  length = 0;
+        uint32_t                hash = 0;
+    };
+
+    std::vector<Entry>                       m_entries;
+    std::unique_ptr<std::atomic<uint32_t>[]> m_slots;
+    size_t                                   m_mask;
+    unsigned                                 m_shift;
+    std::atomic<size_t>                      m_size;
+};
+
+} // namespace detail
+
+//! String interning.
+/*!
+ * Maps strings such as message addresses or string arguments to dense
+ * integer ids in the range [0, size()), so that handlers can switch on
+ * symbols instead of comparing strings:
+ *
+ *     const Symbol kFreq = table.intern("freq");
+ *     ...
+ *     if (table.lookup(args.string()) == kFreq) ...
+ *
+ * Message addresses can be looked up without scanning for the terminator
+ * with `table.lookup(msg.address(), msg.addressLength())`.
+ *
+ * The capacity is fixed at construction time and all memory except the
+ * string copies is allocated up front. Not thread-safe; see
+ * ConcurrentSymbolTable.
+ */
+class SymbolTable : public detail::SymbolTableBase
+{
+public:
+    SymbolTable(size_t maxSymbols)
+    : SymbolTableBase(maxSymbols)
+    {}
+
+    //! Intern a string and return its symbol.
+    /*!
+     * \throw std::length_error table capacity exceeded.
+     */
+    Symbol intern(const char* str, size_t length)
+    {
+        return insert(str, length);
+    }
+
+    Symbol intern(const char* str)
+    {
+        return insert(str, std::strlen(str));
+    }
+};
+
+//! Read-mostly string interning.
+/*!
+ * Like SymbolTable, but lookups are lock-free and may run concurrently
+ * with each other and with intern(), which is serialized by a mutex.
+ */
+class ConcurrentSymbolTable : public detail::SymbolTableBase
+{
+public:
+    ConcurrentSymbolTable(size_t maxSymbols)
+    : SymbolTableBase(maxSymbols)
+    {}
+
+    //! Intern a string and return its symbol.
+    /*!
+     * \throw std::length_error table capacity exceeded.
+     */
+    Symbol intern(const char* str, size_t length)
+    {
+        const Symbol symbol = lookup(str, length);
+        if (symbol != kNoSymbol)
+            return symbol;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return insert(str, length);
+    }
+
+    Symbol intern(const char* str)
+    {
+        return intern(str, std::strlen(str));
+    }
+
+private:
+    std::mutex m_mutex;
+};
+
+} // namespace OSCPP
+
+#endif // OSCPP_SYMBOL_HPP_INCLUDED
@@ -0,0 +1,346 @@
+// oscpp library
+//
+// Copyright (c) 2004-2013 Stefan Kersten <sk@k-hornz.de>
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OSCPP_THROTTLE_HPP_INCLUDED
+#define OSCPP_THROTTLE_HPP_INCLUDED
+
+#include <oscpp/server.hpp>
+#include <oscpp/symbol.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+namespace OSCPP { namespace Server {
+
+//! Per-address deduplication and rate limiting of incoming messages.
+/*!
+ * Keeps an entry per address in a fixed-size open addressing table,
+ * holding a copy of the address, the type tags and argument data of the
+ * last message passed, and the state of a token bucket. A message is
+ * dropped as a duplicate if its type tags and arguments are
+ * byte-identical to the last one passed for its address, and dropped
+ * as rate limited if its address has sent more than burst messages
+ * within burst intervals. The token bucket is kept as the time at
+ * which the bucket will be full again, so that checking and updating it
+ * takes a single comparison.
+ *
+ * No memory is allocated after construction. When an address doesn't
+ * find a free entry within a few probes, the least recently used entry
+ * among the probed ones is evicted, which forgets its last value and
+ * rate. Addresses longer than the entry size aren't tracked and always
+ * pass; values that don't fit next to the address are never considered
+ * duplicates.
+ *
+ * The Clock type must provide now(), time_point and duration like the
+ * clocks in std::chrono.
+ */
+template <typename Clock = std::chrono::steady_clock> class Throttle
+{
+public:
+    typedef typename Clock::duration   Duration;
+    typedef typename Clock::time_point TimePoint;
+
+    enum Result
+    {
+        kPass,       //!< Message passes
+        kDuplicate,  //!< Same arguments as the last message passed
+        kRateLimited //!< Rate of the address exceeded
+    };
+
+    //! Constructor.
+    /*!
+     * \param capacity Number of addresses tracked, rounded up to a
+     * power of two of at least eight.
+     * \param entrySize Maximum size in bytes of an address and the
+     * type tags and argument data compared for deduplication.
+     * \param interval Minimum average time between messages of an
+     * address, or zero for no rate limit.
+     * \param burst Number of messages an address may send at once
+     * after having been idle.
+     * \param deduplicate Drop messages repeating the last value.
+     *
+     * \throw std::invalid_argument zero capacity or burst.
+     */
+    Throttle(size_t capacity, size_t entrySize,
+             Duration interval = Duration::zero(), size_t burst = 1,
+             bool deduplicate = true)
+    : m_entrySize(entrySize)
+    , m_interval(interval)
+    , m_deduplicate(deduplicate)
+    , m_time(0)
+    , m_numPassed(0)
+    , m_numDuplicates(0)
+    , m_numRateLimited(0)
+    , m_numUntracked(0)
+    , m_numEvictions(0)
+    {
+        if (capacity == 0)
+            throw std::invalid_argument("Throttle capacity must be positive");
+        if (burst == 0)
+            throw std::invalid_argument("Throttle burst must be positive");
+        m_tolerance = interval * static_cast<typename Duration::rep>(burst - 1);
+        size_t n = kMaxProbes;
+        m_shift = 64;
+        while (n < capacity)
+            n *= 2;
+        for (size_t i = 1; i < n; i *= 2)
+            m_shift--;
+        m_entries.resize(n);
+        m_data.reset(new char[n * entrySize]);
+    }
+
+    Throttle(const Throttle&) = delete;
+    Throttle& operator=(const Throttle&) = delete;
+
+    //! Check a message received at time now and record it if it passes.
+    /*!
+     * \throw OSCPP::ParseError, OSCPP::UnderrunError malformed message.
+     */
+    Result check(const Message& msg, TimePoint now)
+    {
+        const char*  address = msg.address();
+        const size_t length = msg.addressLength();
+        if (length > m_entrySize)
+        {
+            m_numUntracked++;
+            m_numPassed++;
+            return kPass;
+        }
+
+        // Type tags (including the leading ',') and arguments
+        ReadStream tags, args;
+        std::tie(tags, args) = msg.args().state();
+        const char*  value = tags.begin() - 1;
+        const size_t valueSize = static_cast<size_t>(args.end() - value);
+
+        Entry&      entry = lookup(address, length, now);
+        char* const data = m_data.get() + index(entry) * m_entrySize;
+        if (m_deduplicate && entry.valueSize == valueSize &&
+            detail::equalBytes(data + length, value, valueSize))
+        {
+            m_numDuplicates++;
+            return kDuplicate;
+        }
+        if (m_interval != Duration::zero())
+        {
+            if (entry.full > now + m_tolerance)
+            {
+                m_numRateLimited++;
+                return kRateLimited;
+            }
+            entry.full = std::max(entry.full, now) + m_interval;
+        }
+        if (m_deduplicate)
+        {
+            if (valueSize <= m_entrySize - length)
+            {
+                std::memcpy(data + length, value, valueSize);
+                entry.valueSize = static_cast<uint32_t>(valueSize);
+            }
+            else
+            {
+                entry.valueSize = kNoValue;
+            }
+        }
+        m_numPassed++;
+        return kPass;
+    }
+
+    //! Check a message received now.
+    Result check(const Message& msg)
+    {
+        return check(msg, Clock::now());
+    }
+
+    //! Return true if msg passes.
+    bool operator()(const Message& msg)
+    {
+        return check(msg) == kPass;
+    }
+
+    //! Call f(msg) for every message in packet that passes.
+    /*!
+     * All messages, including those in nested bundles, are checked as
+     * received at the same time. Returns the number of messages passed.
+     *
+     * \throw OSCPP::ParseError, OSCPP::UnderrunError malformed packet.
+     */
+    template <typename F> size_t apply(const Packet& packet, F&& f)
+    {
+        return apply(packet, f, Clock::now());
+    }
+
+    //! Forget all addresses.
+    void clear()
+    {
+        std::fill(m_entries.begin(), m_entries.end(), Entry());
+    }
+
+    //! Number of addresses that can be tracked.
+    size_t capacity() const
+    {
+        return m_entries.size();
+    }
+
+    //! \name Counters
+    //@{
+    uint64_t numPassed() const
+    {
+        return m_numPassed;
+    }
+
+    uint64_t numDuplicates() const
+    {
+        return m_numDuplicates;
+    }
+
+    uint64_t numRateLimited() const
+    {
+        return m_numRateLimited;
+    }
+
+    //! Messages passed because their address was too long to track.
+    uint64_t numUntracked() const
+    {
+        return m_numUntracked;
+    }
+
+    //! Addresses evicted from a full table.
+    uint64_t numEvictions() const
+    {
+        return m_numEvictions;
+    }
+    //@}
+
+private:
+    static const size_t   kMaxProbes = 8;
+    static const uint32_t kEmpty = 0xFFFFFFFF;
+    static const uint32_t kNoValue = 0xFFFFFFFF;
+
+    struct Entry
+    {
+        Entry()
+        : hash(0)
+        , length(kEmpty)
+        , valueSize(kNoValue)
+        , lastUse(0)
+        {}
+
+        uint32_t  hash;
+        uint32_t  length;    // Address length or kEmpty
+        uint32_t  valueSize; // Size of the last value or kNoValue
+        uint64_t  lastUse;   // Message count at the last use
+        TimePoint full;      // Time the token bucket is full again
+    };
+
+    size_t index(const Entry& entry) const
+    {
+        return static_cast<size_t>(&entry - m_entries.data());
+    }
+
+    // Find the entry of an address or claim one for it.
+    Entry& lookup(const char* address, size_t length, TimePoint now)
+    {
+        const uint32_t hash = detail::hashString(address, length);
+        // Take the slot from the high bits of the product, which depend
+        // on all bits of the hash.
+        const size_t slot =
+            static_cast<size_t>((hash * 0x9E3779B97F4A7C15ull) >> m_shift);
+        const size_t mask = m_entries.size() - 1;
+        Entry*       victim = nullptr;
+        for (size_t i = 0; i < kMaxProbes; i++)
+        {
+            Entry& entry = m_entries[(slot + i) & mask];
+            if (entry.length == kEmpty)
+            {
+                victim = &entry;
+                break;
+            }
+            if (entry.hash == hash && entry.length == length &&
+                detail::equalBytes(m_data.get() + index(entry) * m_entrySize,
+                                   address, length))
+            {
+                entry.lastUse = ++m_time;
+                return entry;
+            }
+            if (victim == nullptr || entry.lastUse < victim->lastUse)
+                victim = &entry;
+        }
+        // Entries are never removed, so the address can't be found past
+        // a free entry.
+        if (victim->length != kEmpty)
+            m_numEvictions++;
+        victim->hash = hash;
+        victim->length = static_cast<uint32_t>(length);
+        victim->valueSize = kNoValue;
+        victim->lastUse = ++m_time;
+        victim->full = now;
+        std::memcpy(m_data.get() + index(*victim) * m_entrySize, address,
+                    length);
+        return *victim;
+    }
+
+    template <typename F>
+    size_t apply(const Packet& packet, F& f, TimePoint now)
+    {
+        if (packet.isMessage())
+        {
+            const Message msg(packet);
+            if (check(msg, now) != kPass)
+                return 0;
+            f(msg);
+            return 1;
+        }
+        size_t       n = 0;
+        PacketStream elements(Bundle(packet).packets());
+        while (!elements.atEnd())
+            n += apply(elements.next(), f, now);
+        return n;
+    }
+
+    size_t                  m_entrySize;
+    Duration                m_interval;
+    Duration                m_tolerance;
+    bool                    m_deduplicate;
+    unsigned                m_shift;
+    std::vector<Entry>      m_entries;
+    std::unique_ptr<char[]> m_data;
+    uint64_t                m_time;
+    uint64_t                m_numPassed;
+    uint64_t                m_numDuplicates;
+    uint64_t                m_numRateLimited;
+    uint64_t                m_numUntracked;
+    uint64_t                m_numEvictions;
+};
+
+}} // namespace OSCPP::Server
+
+#endif // OSCPP_THROTTLE_HPP_INCLUDED
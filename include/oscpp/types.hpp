@@ -25,6 +25,9 @@
 #ifndef OSCPP_TYPES_HPP_INCLUDED
 #define OSCPP_TYPES_HPP_INCLUDED
 
+#include <cstddef>
+#include <cstdint>
+
 namespace OSCPP {
 
 class Blob
@@ -54,6 +57,86 @@ private:
     const void* m_data;
 };
 
+//! 32 bit RGBA color value.
+class Rgba
+{
+public:
+    Rgba()
+    : m_value(0)
+    {}
+    explicit Rgba(uint32_t value)
+    : m_value(value)
+    {}
+    Rgba(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+    : m_value(uint32_t(r) << 24 | uint32_t(g) << 16 | uint32_t(b) << 8 |
+              uint32_t(a))
+    {}
+
+    uint32_t value() const
+    {
+        return m_value;
+    }
+    uint8_t r() const
+    {
+        return static_cast<uint8_t>(m_value >> 24);
+    }
+    uint8_t g() const
+    {
+        return static_cast<uint8_t>(m_value >> 16);
+    }
+    uint8_t b() const
+    {
+        return static_cast<uint8_t>(m_value >> 8);
+    }
+    uint8_t a() const
+    {
+        return static_cast<uint8_t>(m_value);
+    }
+
+private:
+    uint32_t m_value;
+};
+
+//! 4 byte MIDI message: port id, status byte and two data bytes.
+class Midi
+{
+public:
+    Midi()
+    : m_value(0)
+    {}
+    explicit Midi(uint32_t value)
+    : m_value(value)
+    {}
+    Midi(uint8_t port, uint8_t status, uint8_t data1, uint8_t data2)
+    : m_value(uint32_t(port) << 24 | uint32_t(status) << 16 |
+              uint32_t(data1) << 8 | uint32_t(data2))
+    {}
+
+    uint32_t value() const
+    {
+        return m_value;
+    }
+    uint8_t port() const
+    {
+        return static_cast<uint8_t>(m_value >> 24);
+    }
+    uint8_t status() const
+    {
+        return static_cast<uint8_t>(m_value >> 16);
+    }
+    uint8_t data1() const
+    {
+        return static_cast<uint8_t>(m_value >> 8);
+    }
+    uint8_t data2() const
+    {
+        return static_cast<uint8_t>(m_value);
+    }
+
+private:
+    uint32_t m_value;
+};
+
 } // namespace OSCPP
 
 #endif // OSCPP_TYPES_HPP_INCLUDED
@@ -26,7 +26,9 @@
 #define OSCPP_UTIL_HPP_INCLUDED
 
 #include <cassert>
+#include <cstdint>
 #include <cstring>
+#include <stdexcept>
 
 namespace OSCPP {
 
@@ -78,6 +80,34 @@ constexpr size_t blob()
 {
     return 1;
 }
+constexpr size_t boolean()
+{
+    return 1;
+}
+constexpr size_t nil()
+{
+    return 1;
+}
+constexpr size_t infinitum()
+{
+    return 1;
+}
+constexpr size_t character()
+{
+    return 1;
+}
+constexpr size_t rgba()
+{
+    return 1;
+}
+constexpr size_t midi()
+{
+    return 1;
+}
+constexpr size_t symbol()
+{
+    return 1;
+}
 constexpr size_t array(size_t numElems)
 {
     return numElems + 2;
@@ -139,6 +169,16 @@ constexpr size_t float32(size_t n = 1)
     return n * 4;
 }
 
+constexpr size_t int64(size_t n = 1)
+{
+    return n * 8;
+}
+
+constexpr size_t timeTag(size_t n = 1)
+{
+    return n * 8;
+}
+
 constexpr size_t float64(size_t n = 1)
 {
     return n * 8;
@@ -153,6 +193,36 @@ constexpr size_t blob(size_t size)
 {
     return 4 + align(size);
 }
+
+constexpr size_t boolean(size_t = 1)
+{
+    return 0;
+}
+
+constexpr size_t nil(size_t = 1)
+{
+    return 0;
+}
+
+constexpr size_t infinitum(size_t = 1)
+{
+    return 0;
+}
+
+constexpr size_t character(size_t n = 1)
+{
+    return n * 4;
+}
+
+constexpr size_t rgba(size_t n = 1)
+{
+    return n * 4;
+}
+
+constexpr size_t midi(size_t n = 1)
+{
+    return n * 4;
+}
 } // namespace Size
 } // namespace OSCPP
 
@@ -0,0 +1,211 @@
+#include "bench.hpp"
+
+#include <oscpp/batch.hpp>
+#include <oscpp/client.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#    include <arpa/inet.h>
+#    include <netinet/in.h>
+#    include <sys/socket.h>
+#    include <unistd.h>
+#    define OSCPP_BENCH_HAVE_SOCKETS 1
+#endif
+
+// Coalescing small messages with Client::Batcher.
+//
+// A simulated audio callback emits kMessagesPerBlock messages per block
+// of 64 frames at 48 kHz and polls the batcher at the end of each block,
+// or flushes it for sending one datagram per block.
+// Time is simulated, so that the reported latency is the time messages
+// are held back by batching, independent of the machine. Datagrams are
+// sent to a UDP socket on the loopback interface where available, which
+// is never read from. Besides time per message, the benchmarks report
+// datagrams per second, messages per datagram and the mean added
+// latency in microseconds.
+
+namespace OSCPP { namespace Bench {
+
+namespace {
+
+const size_t kMessagesPerBlock = 8;
+const size_t kMtu = 1472;
+const std::chrono::nanoseconds kBlockPeriod(1333333);
+
+// Simulated clock advanced by the benchmark.
+struct SimulatedClock
+{
+    typedef std::chrono::nanoseconds                 duration;
+    typedef duration::rep                            rep;
+    typedef duration::period                         period;
+    typedef std::chrono::time_point<SimulatedClock> time_point;
+    static const bool                                is_steady = true;
+
+    static time_point now()
+    {
+        return current();
+    }
+
+    static time_point& current()
+    {
+        static time_point t;
+        return t;
+    }
+};
+
+// Datagram socket connected to an unread socket on the loopback
+// interface.
+class Socket
+{
+public:
+    Socket()
+    : m_send(-1)
+    , m_receive(-1)
+    {
+#if defined(OSCPP_BENCH_HAVE_SOCKETS)
+        m_receive = socket(AF_INET, SOCK_DGRAM, 0);
+        m_send = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in addr = sockaddr_in();
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(addr);
+        if (m_receive < 0 || m_send < 0 ||
+            bind(m_receive, reinterpret_cast<sockaddr*>(&addr), length) !=
+                0 ||
+            getsockname(m_receive, reinterpret_cast<sockaddr*>(&addr),
+                        &length) != 0 ||
+            connect(m_send, reinterpret_cast<sockaddr*>(&addr), length) != 0)
+        {
+            std::perror("oscpp_bench: socket");
+            close();
+        }
+#endif
+    }
+
+    ~Socket()
+    {
+        close();
+    }
+
+    Socket(const Socket&) = delete;
+    Socket& operator=(const Socket&) = delete;
+
+    void send(const void* data, size_t size)
+    {
+#if defined(OSCPP_BENCH_HAVE_SOCKETS)
+        if (m_send >= 0)
+            doNotOptimize(::send(m_send, data, size, 0));
+#endif
+        doNotOptimize(data);
+    }
+
+private:
+    void close()
+    {
+#if defined(OSCPP_BENCH_HAVE_SOCKETS)
+        if (m_send >= 0)
+            ::close(m_send);
+        if (m_receive >= 0)
+            ::close(m_receive);
+#endif
+        m_send = m_receive = -1;
+    }
+
+    int m_send;
+    int m_receive;
+};
+
+void buildMessage(Client::Packet& packet, size_t i)
+{
+    static const char* const addresses[kMessagesPerBlock] = {
+        "/voice/0/freq", "/voice/1/freq", "/voice/2/freq", "/voice/3/freq",
+        "/voice/4/freq", "/voice/5/freq", "/voice/6/freq", "/voice/7/freq"};
+    packet.openMessage(addresses[i % kMessagesPerBlock], 1)
+        .float32(static_cast<float>(i))
+        .closeMessage();
+}
+
+void reportRates(State& state, size_t numPackets, double latency)
+{
+    state.stopTimer();
+    const double seconds = state.seconds();
+    state.setCounter("packets/s", seconds > 0 ? numPackets / seconds : 0);
+    state.setCounter("msgs/packet", numPackets > 0
+                                        ? double(state.iterations()) /
+                                              double(numPackets)
+                                        : 0);
+    state.setCounter("latency_us", latency);
+}
+
+// Batch with the given budget, or flush at the end of each block.
+void addBatch(Registry& registry, const std::string& name,
+              std::chrono::nanoseconds budget, bool perBlock = false)
+{
+    registry.add("batch/" + name, [budget, perBlock](State& state) {
+        typedef SimulatedClock::time_point TimePoint;
+        Socket                 socket;
+        std::vector<TimePoint> added;
+        added.reserve(kMtu / 8);
+        double latency = 0;
+        auto   sink = [&](const void* data, size_t size) {
+            socket.send(data, size);
+            const TimePoint now = SimulatedClock::now();
+            for (const TimePoint& t : added)
+                latency += std::chrono::duration<double, std::micro>(now - t)
+                               .count();
+            added.clear();
+        };
+        SimulatedClock::current() = TimePoint();
+        Client::Batcher<decltype(sink), SimulatedClock> batcher(sink, kMtu,
+                                                                budget);
+        state.setBytesPerOp(Size::message("/voice/0/freq", 1) + 4);
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            added.push_back(SimulatedClock::now());
+            batcher.add([i](Client::Packet& p) { buildMessage(p, i); });
+            if ((i + 1) % kMessagesPerBlock == 0)
+            {
+                if (perBlock)
+                    batcher.flush();
+                else
+                    batcher.poll();
+                SimulatedClock::current() += kBlockPeriod;
+            }
+        }
+        batcher.flush();
+        reportRates(state, batcher.numPackets(),
+                    latency / double(state.iterations()));
+    });
+}
+
+} // namespace
+
+void registerBatch(Registry& registry)
+{
+    // One datagram per message
+    registry.add("batch/unbatched", [](State& state) {
+        Socket                     socket;
+        Client::StaticPacket<kMtu> packet;
+        state.setBytesPerOp(Size::message("/voice/0/freq", 1));
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            packet.reset();
+            buildMessage(packet, i);
+            socket.send(packet.data(), packet.size());
+        }
+        reportRates(state, state.iterations(), 0);
+    });
+
+    addBatch(registry, "per-block", std::chrono::hours(1), true);
+    addBatch(registry, "budget-2ms", std::chrono::milliseconds(2));
+    addBatch(registry, "budget-5ms", std::chrono::milliseconds(5));
+    addBatch(registry, "budget-10ms", std::chrono::milliseconds(10));
+}
+
+}} // namespace OSCPP::Bench
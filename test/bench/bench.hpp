@@ -0,0 +1,237 @@
+#ifndef OSCPP_BENCH_HPP_INCLUDED
+#define OSCPP_BENCH_HPP_INCLUDED
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#    include <cstring>
+#    include <linux/perf_event.h>
+#    include <sys/ioctl.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+namespace OSCPP { namespace Bench {
+
+// Hardware instruction counter for the calling thread, if available.
+class InstructionCounter
+{
+public:
+    InstructionCounter()
+    : m_fd(-1)
+    {
+#if defined(__linux__)
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        m_fd = static_cast<int>(
+            syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    InstructionCounter(const InstructionCounter&) = delete;
+    InstructionCounter& operator=(const InstructionCounter&) = delete;
+
+    ~InstructionCounter()
+    {
+#if defined(__linux__)
+        if (m_fd >= 0)
+            close(m_fd);
+#endif
+    }
+
+    bool available() const
+    {
+        return m_fd >= 0;
+    }
+
+    void start()
+    {
+#if defined(__linux__)
+        if (m_fd >= 0)
+        {
+            ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    uint64_t stop()
+    {
+        uint64_t count = 0;
+#if defined(__linux__)
+        if (m_fd >= 0)
+        {
+            ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(m_fd, &count, sizeof(count)) != sizeof(count))
+                count = 0;
+        }
+#endif
+        return count;
+    }
+
+private:
+    int m_fd;
+};
+
+// Named values reported by a benchmark.
+typedef std::vector<std::pair<std::string, double>> Counters;
+
+// Per-run state passed to a benchmark function, which has to execute its
+// operation iterations() times.
+class State
+{
+public:
+    State(size_t iterations, InstructionCounter& counter)
+    : m_iterations(iterations)
+    , m_bytesPerOp(0)
+    , m_counter(counter)
+    {
+        resetTimer();
+    }
+
+    size_t iterations() const
+    {
+        return m_iterations;
+    }
+
+    // Number of bytes produced or consumed by a single operation, used for
+    // reporting throughput.
+    void setBytesPerOp(size_t bytes)
+    {
+        m_bytesPerOp = bytes;
+    }
+
+    size_t bytesPerOp() const
+    {
+        return m_bytesPerOp;
+    }
+
+    // Report a named value in addition to the timing, e.g. a rate or
+    // latency computed by the benchmark itself.
+    void setCounter(const std::string& name, double value)
+    {
+        for (auto& counter : m_counters)
+        {
+            if (counter.first == name)
+            {
+                counter.second = value;
+                return;
+            }
+        }
+        m_counters.emplace_back(name, value);
+    }
+
+    const Counters& counters() const
+    {
+        return m_counters;
+    }
+
+    // Exclude setup code executed so far from the measurement.
+    void resetTimer()
+    {
+        m_counter.start();
+        m_start = std::chrono::steady_clock::now();
+        m_running = true;
+    }
+
+    // Stop the measurement, excluding any teardown code that follows.
+    // Only the first call after resetTimer() has an effect.
+    void stopTimer()
+    {
+        if (m_running)
+        {
+            m_end = std::chrono::steady_clock::now();
+            m_instructions = m_counter.stop();
+            m_running = false;
+        }
+    }
+
+    double seconds() const
+    {
+        return std::chrono::duration<double>(m_end - m_start).count();
+    }
+
+    uint64_t instructions() const
+    {
+        return m_instructions;
+    }
+
+private:
+    size_t                                m_iterations;
+    size_t                                m_bytesPerOp;
+    InstructionCounter&                   m_counter;
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::steady_clock::time_point m_end;
+    uint64_t                              m_instructions = 0;
+    bool                                  m_running = false;
+    Counters                              m_counters;
+};
+
+typedef std::function<void(State&)> Function;
+
+struct Benchmark
+{
+    std::string name;
+    Function    function;
+};
+
+class Registry
+{
+public:
+    void add(const std::string& name, Function function)
+    {
+        m_benchmarks.push_back(Benchmark{name, function});
+    }
+
+    const std::vector<Benchmark>& benchmarks() const
+    {
+        return m_benchmarks;
+    }
+
+private:
+    std::vector<Benchmark> m_benchmarks;
+};
+
+// Prevent the compiler from optimizing away a computed value.
+template <typename T> inline void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+// Suites
+void registerWorkloads(Registry& registry);
+void registerParse(Registry& registry);
+void registerDispatch(Registry& registry);
+void registerLatency(Registry& registry);
+void registerPcap(Registry& registry);
+void registerFormat(Registry& registry);
+void registerJson(Registry& registry);
+void registerBatch(Registry& registry);
+void registerRouter(Registry& registry);
+void registerEdit(Registry& registry);
+void registerFilter(Registry& registry);
+void registerThrottle(Registry& registry);
+void registerDelta(Registry& registry);
+void registerState(Registry& registry);
+void registerFanOut(Registry& registry);
+void registerQueue(Registry& registry);
+
+}} // namespace OSCPP::Bench
+
+#endif // OSCPP_BENCH_HPP_INCLUDED
@@ -0,0 +1,108 @@
+#include "bench.hpp"
+
+#include <oscpp/client.hpp>
+#include <oscpp/delta.hpp>
+#include <oscpp/server.hpp>
+
+#include <string>
+#include <vector>
+
+// Sending 64 meter updates with a single float argument each as an OSC
+// bundle and as a delta frame once their addresses have been defined:
+// encoding the messages of the bundle into a frame, decoding the frame
+// and, for comparison, parsing the bundle. Reports the frame size
+// relative to the bundle.
+
+namespace OSCPP { namespace Bench {
+
+namespace {
+
+const size_t kNumMessages = 64;
+
+std::vector<char> makeBundle()
+{
+    Client::StaticPacket<8192> packet;
+    packet.openBundle(1);
+    for (size_t i = 0; i < kNumMessages; i++)
+    {
+        const std::string address =
+            "/mixer/channel/" + std::to_string(i) + "/meter";
+        packet.openMessage(address.c_str(), 1)
+            .float32(static_cast<float>(i) / kNumMessages)
+            .closeMessage();
+    }
+    packet.closeBundle();
+    const char* data = static_cast<const char*>(packet.data());
+    return std::vector<char>(data, data + packet.size());
+}
+
+// Encode the messages of a bundle into a frame.
+void encode(const Server::Packet& packet, Client::DeltaEncoder& encoder)
+{
+    encoder.clear();
+    Server::PacketStream elements(Server::Bundle(packet).packets());
+    while (!elements.atEnd())
+        encoder.add(elements.next());
+}
+
+struct Sum
+{
+    float value = 0;
+
+    void operator()(const Server::Message& msg)
+    {
+        value += msg.args().float32();
+    }
+};
+
+} // namespace
+
+void registerDelta(Registry& registry)
+{
+    registry.add("delta/encode", [](State& state) {
+        const std::vector<char> bundle = makeBundle();
+        const Server::Packet    packet(bundle.data(), bundle.size());
+        std::vector<uint32_t>   frame(bundle.size() / 2);
+        Client::DeltaEncoder    encoder(frame.data(), 4 * frame.size());
+        encode(packet, encoder);
+        state.setBytesPerOp(bundle.size());
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+            encode(packet, encoder);
+        state.stopTimer();
+        state.setCounter("ratio", double(encoder.size()) / bundle.size());
+    });
+    registry.add("delta/decode", [](State& state) {
+        const std::vector<char> bundle = makeBundle();
+        std::vector<uint32_t>   frame(bundle.size() / 2);
+        Client::DeltaEncoder    encoder(frame.data(), 4 * frame.size());
+        Server::DeltaDecoder    decoder;
+        Sum                     sum;
+        // Define the addresses, then decode a frame of references
+        encode(Server::Packet(bundle.data(), bundle.size()), encoder);
+        decoder.decode(encoder.data(), encoder.size(), sum);
+        encode(Server::Packet(bundle.data(), bundle.size()), encoder);
+        state.setBytesPerOp(encoder.size());
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+            decoder.decode(encoder.data(), encoder.size(), sum);
+        state.stopTimer();
+        doNotOptimize(sum.value);
+    });
+    registry.add("delta/decode/plain", [](State& state) {
+        const std::vector<char> bundle = makeBundle();
+        Sum                     sum;
+        state.setBytesPerOp(bundle.size());
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            const Server::Packet packet(bundle.data(), bundle.size());
+            Server::PacketStream elements(Server::Bundle(packet).packets());
+            while (!elements.atEnd())
+                sum(elements.next());
+        }
+        state.stopTimer();
+        doNotOptimize(sum.value);
+    });
+}
+
+}} // namespace OSCPP::Bench
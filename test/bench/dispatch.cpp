@@ -0,0 +1,83 @@
+#include "bench.hpp"
+
+#include <oscpp/client.hpp>
+#include <oscpp/executor.hpp>
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+// Scaling of BundleExecutor over 1..N threads, where N is the number of
+// hardware threads.
+
+namespace OSCPP { namespace Bench {
+
+namespace {
+
+const size_t kNumMessages = 10000;
+
+std::shared_ptr<Client::DynamicPacket> makeSnapshot()
+{
+    std::shared_ptr<Client::DynamicPacket> packet(
+        new Client::DynamicPacket(kNumMessages * 64 + 64));
+    char address[32];
+    packet->openBundle(1);
+    for (size_t i = 0; i < kNumMessages; i++)
+    {
+        std::snprintf(address, sizeof(address), "/state/%zu/value",
+                      i % 256);
+        packet->openMessage(address, 2)
+            .int32(static_cast<int32_t>(i))
+            .float32(static_cast<float>(i) * 0.5f)
+            .closeMessage();
+    }
+    packet->closeBundle();
+    return packet;
+}
+
+std::atomic<uint64_t> gSink(0);
+
+// Simulate a handler doing a moderate amount of work per message.
+void handleMessage(const Server::Message& msg)
+{
+    Server::ArgStream args(msg.args());
+    const int32_t     id = args.int32();
+    float             x = args.float32();
+    for (int i = 0; i < 64; i++)
+        x = std::sqrt(x * x + 1.f);
+    gSink.fetch_add(static_cast<uint64_t>(x) + id, std::memory_order_relaxed);
+}
+
+void addDispatch(Registry& registry, const char* name,
+                 Server::Affinity affinity, size_t numThreads)
+{
+    registry.add(std::string("dispatch/") + name +
+                     "/threads:" + std::to_string(numThreads),
+                 [affinity, numThreads](State& state) {
+                     auto packet = makeSnapshot();
+                     const Server::Bundle bundle(
+                         Server::Packet(packet->data(), packet->size()));
+                     Server::BundleExecutor executor(numThreads, affinity,
+                                                     2);
+                     state.setBytesPerOp(packet->size());
+                     state.resetTimer();
+                     for (size_t i = 0; i < state.iterations(); i++)
+                         executor.dispatch(bundle, handleMessage);
+                 });
+}
+
+} // namespace
+
+void registerDispatch(Registry& registry)
+{
+    const size_t maxThreads =
+        std::max(1u, std::thread::hardware_concurrency());
+    for (size_t n = 1; n <= maxThreads; n++)
+        addDispatch(registry, "none", Server::Affinity::None, n);
+    for (size_t n = 1; n <= maxThreads; n++)
+        addDispatch(registry, "prefix", Server::Affinity::AddressPrefix, n);
+}
+
+}} // namespace OSCPP::Bench
@@ -0,0 +1,77 @@
+#include "bench.hpp"
+
+#include <oscpp/client.hpp>
+#include <oscpp/edit.hpp>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Editing a bundle of 16 messages in place with Server::Editor:
+// renaming an address prefix to one of the same padded length and to a
+// longer one (and back), and patching a float argument of every
+// message. Each iteration starts from a fresh copy of the packet, which
+// is included in the timing.
+
+namespace OSCPP { namespace Bench {
+
+namespace {
+
+const size_t kNumMessages = 16;
+
+std::vector<char> makeBundle()
+{
+    Client::StaticPacket<4096> packet;
+    packet.openBundle(1);
+    for (size_t i = 0; i < kNumMessages; i++)
+    {
+        const std::string address =
+            "/room1/" + std::to_string(i % 4) + "/gain";
+        packet.openMessage(address.c_str(), 3)
+            .int32(static_cast<int32_t>(i))
+            .float32(0.5f)
+            .string("channel")
+            .closeMessage();
+    }
+    packet.closeBundle();
+    const char* data = static_cast<const char*>(packet.data());
+    return std::vector<char>(data, data + packet.size());
+}
+
+template <typename Edit>
+void addEdit(Registry& registry, const std::string& name, Edit edit)
+{
+    registry.add("edit/" + name, [edit](State& state) {
+        const std::vector<char> original = makeBundle();
+        std::vector<char>       buffer(2 * original.size());
+        state.setBytesPerOp(original.size());
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            std::memcpy(buffer.data(), original.data(), original.size());
+            Server::Editor editor(buffer.data(), original.size(),
+                                  buffer.size());
+            edit(editor);
+            doNotOptimize(editor.size());
+        }
+    });
+}
+
+} // namespace
+
+void registerEdit(Registry& registry)
+{
+    addEdit(registry, "index", [](Server::Editor&) {});
+    addEdit(registry, "rename/same-size", [](Server::Editor& editor) {
+        editor.replacePrefix("/room1/", "/roomA/");
+    });
+    addEdit(registry, "rename/grow", [](Server::Editor& editor) {
+        editor.replacePrefix("/room1/", "/building/floor2/room1/");
+    });
+    addEdit(registry, "patch/float", [](Server::Editor& editor) {
+        for (size_t i = 0; i < editor.numMessages(); i++)
+            editor.setFloat32(i, 1, 0.25f);
+    });
+}
+
+}} // namespace OSCPP::Bench
@@ -0,0 +1,158 @@
+#include "bench.hpp"
+
+#include <oscpp/client.hpp>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#    include <oscpp/fanout.hpp>
+
+#    include <arpa/inet.h>
+#    include <netinet/in.h>
+#    include <sys/socket.h>
+#    include <unistd.h>
+#    define OSCPP_BENCH_HAVE_SOCKETS 1
+#endif
+
+// Sending one packet to many receivers on the loopback interface, which
+// are never read from, with Client::FanOut and with a loop calling
+// sendto once per destination. Reports datagrams per second and the
+// number of failed sends.
+
+namespace OSCPP { namespace Bench {
+
+#if defined(OSCPP_BENCH_HAVE_SOCKETS)
+
+namespace {
+
+// Unread datagram sockets bound to the loopback interface.
+class Receivers
+{
+public:
+    explicit Receivers(size_t n)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            const int   fd = socket(AF_INET, SOCK_DGRAM, 0);
+            sockaddr_in addr = sockaddr_in();
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t length = sizeof(addr);
+            if (fd < 0 ||
+                bind(fd, reinterpret_cast<sockaddr*>(&addr), length) != 0 ||
+                getsockname(fd, reinterpret_cast<sockaddr*>(&addr),
+                            &length) != 0)
+            {
+                std::perror("oscpp_bench: socket");
+                if (fd >= 0)
+                    close(fd);
+                continue;
+            }
+            m_sockets.push_back(fd);
+            m_addresses.push_back(addr);
+        }
+    }
+
+    ~Receivers()
+    {
+        for (int fd : m_sockets)
+            close(fd);
+    }
+
+    Receivers(const Receivers&) = delete;
+    Receivers& operator=(const Receivers&) = delete;
+
+    const std::vector<sockaddr_in>& addresses() const
+    {
+        return m_addresses;
+    }
+
+private:
+    std::vector<int>         m_sockets;
+    std::vector<sockaddr_in> m_addresses;
+};
+
+void buildPacket(Client::Packet& packet)
+{
+    packet.openBundle(1);
+    for (int i = 0; i < 8; i++)
+    {
+        packet.openMessage("/mixer/fader/level", 1)
+            .float32(static_cast<float>(i))
+            .closeMessage();
+    }
+    packet.closeBundle();
+}
+
+void reportRates(State& state, size_t numDestinations, uint64_t numErrors)
+{
+    state.stopTimer();
+    const double seconds = state.seconds();
+    const double numDatagrams = double(numDestinations) * state.iterations();
+    state.setCounter("datagrams/s", seconds > 0 ? numDatagrams / seconds : 0);
+    state.setCounter("errors", double(numErrors));
+}
+
+void addFanOut(Registry& registry, size_t numDestinations)
+{
+    const std::string suffix = "/" + std::to_string(numDestinations);
+
+    registry.add("fanout/sendmmsg" + suffix, [numDestinations](State& state) {
+        Receivers                 receivers(numDestinations);
+        Client::FanOut            fanOut;
+        Client::StaticPacket<512> packet;
+        buildPacket(packet);
+        for (const sockaddr_in& addr : receivers.addresses())
+            fanOut.addDestination(reinterpret_cast<const sockaddr*>(&addr),
+                                  sizeof(addr));
+        state.setBytesPerOp(packet.size() * numDestinations);
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+            doNotOptimize(fanOut.send(packet));
+        uint64_t numErrors = 0;
+        for (size_t d = 0; d < fanOut.numDestinations(); d++)
+            numErrors += fanOut.stats(d).numErrors;
+        reportRates(state, fanOut.numDestinations(), numErrors);
+    });
+
+    registry.add("fanout/sendto" + suffix, [numDestinations](State& state) {
+        Receivers                 receivers(numDestinations);
+        const int                 fd = socket(AF_INET, SOCK_DGRAM, 0);
+        Client::StaticPacket<512> packet;
+        buildPacket(packet);
+        const std::vector<sockaddr_in>& addresses = receivers.addresses();
+        uint64_t                        numErrors = 0;
+        state.setBytesPerOp(packet.size() * numDestinations);
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            for (const sockaddr_in& addr : addresses)
+            {
+                if (sendto(fd, packet.data(), packet.size(), 0,
+                           reinterpret_cast<const sockaddr*>(&addr),
+                           sizeof(addr)) < 0)
+                    numErrors++;
+            }
+        }
+        reportRates(state, addresses.size(), numErrors);
+        close(fd);
+    });
+}
+
+} // namespace
+
+void registerFanOut(Registry& registry)
+{
+    addFanOut(registry, 8);
+    addFanOut(registry, 32);
+}
+
+#else
+
+void registerFanOut(Registry&) {}
+
+#endif
+
+}} // namespace OSCPP::Bench
@@ -0,0 +1,115 @@
+#include "bench.hpp"
+
+#include <oscpp/client.hpp>
+#include <oscpp/filter.hpp>
+#include <oscpp/server.hpp>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Filtering a bundle of 64 meter, synth and fader messages with
+// compiled Server::Filter expressions of increasing complexity, and the
+// simplest one hand-written against ArgStream for comparison. Reports
+// the number of messages evaluated per second.
+
+namespace OSCPP { namespace Bench {
+
+namespace {
+
+const size_t kNumMessages = 64;
+
+std::vector<char> makeBundle()
+{
+    Client::StaticPacket<8192> packet;
+    packet.openBundle(1);
+    for (size_t i = 0; i < kNumMessages; i++)
+    {
+        const std::string n = std::to_string(i % 8);
+        switch (i % 3)
+        {
+            case 0:
+                packet.openMessage(("/meter/" + n).c_str(), 1)
+                    .float32(static_cast<float>(i % 5) / 10)
+                    .closeMessage();
+                break;
+            case 1:
+                packet.openMessage(("/synth/" + n + "/freq").c_str(), 2)
+                    .int32(static_cast<int32_t>(i * 10))
+                    .string(i % 2 ? "sine" : "saw")
+                    .closeMessage();
+                break;
+            default:
+                packet.openMessage(("/fader/" + n).c_str(), 2)
+                    .int32(static_cast<int32_t>(i))
+                    .float32(0.5f)
+                    .closeMessage();
+        }
+    }
+    packet.closeBundle();
+    const char* data = static_cast<const char*>(packet.data());
+    return std::vector<char>(data, data + packet.size());
+}
+
+template <typename Run>
+void addFilter(Registry& registry, const std::string& name, Run run)
+{
+    registry.add("filter/" + name, [run](State& state) {
+        const std::vector<char> bundle = makeBundle();
+        const Server::Packet    packet(bundle.data(), bundle.size());
+        state.setBytesPerOp(bundle.size());
+        Run    f(run);
+        size_t accepted = 0;
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+            accepted += f(packet);
+        state.stopTimer();
+        doNotOptimize(accepted);
+        const double seconds = state.seconds();
+        state.setCounter("msgs/s",
+                         seconds > 0 ? kNumMessages * state.iterations() /
+                                           seconds
+                                     : 0);
+    });
+}
+
+void addExpression(Registry& registry, const std::string& name,
+                   const std::string& expression)
+{
+    Server::Filter filter(expression);
+    addFilter(registry, name, [filter](const Server::Packet& packet) mutable {
+        return filter.apply(packet, [](const Server::Message&) {});
+    });
+}
+
+} // namespace
+
+void registerFilter(Registry& registry)
+{
+    addExpression(registry, "address", "/meter/*");
+    addExpression(registry, "address-arg", "/meter/* && arg[0] > 0.1");
+    addExpression(registry, "complex",
+                  "(/meter/* && arg[0] > 0.1) || "
+                  "(/synth/[1-4]/freq && arg[1] == \"sine\") || "
+                  "(!/fader/* && sample(100))");
+    addFilter(registry, "address-arg/hand-written",
+              [](const Server::Packet& packet) {
+                  size_t              n = 0;
+                  Server::PacketStream elements(
+                      Server::Bundle(packet).packets());
+                  while (!elements.atEnd())
+                  {
+                      const Server::Message msg(elements.next());
+                      if (std::strncmp(msg.address(), "/meter/", 7) != 0 ||
+                          std::strchr(msg.address() + 7, '/') != nullptr)
+                          continue;
+                      Server::ArgStream args(msg.args());
+                      if (!args.atEnd() && args.tag() == 'f' &&
+                          args.float32() > 0.1f)
+                          n++;
+                  }
+                  return n;
+              });
+}
+
+}} // namespace OSCPP::Bench
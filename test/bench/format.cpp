@@ -0,0 +1,110 @@
+#include "bench.hpp"
+
+#include <oscpp/client.hpp>
+#include <oscpp/format.hpp>
+#include <oscpp/parse.hpp>
+#include <oscpp/print.hpp>
+
+#include <sstream>
+#include <vector>
+
+// Text formatting into a caller provided buffer with OSCPP::format,
+// compared with the ostream based operator<< writing to a reused string
+// stream, and parsing the formatted text back with a reused TextParser.
+
+namespace OSCPP { namespace Bench {
+
+namespace {
+
+typedef void (*Builder)(Client::Packet&);
+
+void addFormat(Registry& registry, const std::string& name, Builder build)
+{
+    registry.add("format/compact/" + name, [build](State& state) {
+        Client::StaticPacket<1024> packet;
+        build(packet);
+        const Server::Packet serverPacket(packet.data(), packet.size());
+        std::vector<char>    buffer(4096);
+        state.setBytesPerOp(
+            format(serverPacket, buffer.data(), buffer.size()));
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            const size_t n =
+                format(serverPacket, buffer.data(), buffer.size());
+            doNotOptimize(n);
+        }
+    });
+
+    registry.add("format/ostream/" + name, [build](State& state) {
+        Client::StaticPacket<1024> packet;
+        build(packet);
+        const Server::Packet serverPacket(packet.data(), packet.size());
+        std::ostringstream   out;
+        out << serverPacket;
+        state.setBytesPerOp(out.str().size());
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            out.seekp(0);
+            out << serverPacket;
+            doNotOptimize(out.tellp());
+        }
+    });
+
+    registry.add("format/parse/" + name, [build](State& state) {
+        Client::StaticPacket<1024> packet;
+        build(packet);
+        std::vector<char> text(4096);
+        const size_t      length =
+            format(Server::Packet(packet.data(), packet.size()),
+                   text.data(), text.size());
+        TextParser parser;
+        state.setBytesPerOp(length);
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            Client::StaticPacket<1024> result;
+            parser.parse(text.data(), length, result);
+            doNotOptimize(result.size());
+        }
+    });
+}
+
+} // namespace
+
+void registerFormat(Registry& registry)
+{
+    addFormat(registry, "n_set-isf", [](Client::Packet& packet) {
+        packet.openMessage("/n_set", 3)
+            .int32(1000)
+            .string("freq")
+            .float32(440.f)
+            .closeMessage();
+    });
+    addFormat(registry, "floats", [](Client::Packet& packet) {
+        packet.openMessage("/mixer/channel/12/eq", 16);
+        for (int i = 0; i < 16; i++)
+            packet.float32(static_cast<float>(i) * 0.173f - 1.3f);
+        packet.closeMessage();
+    });
+    addFormat(registry, "ints", [](Client::Packet& packet) {
+        packet.openMessage("/grid/led/map", 16);
+        for (int i = 0; i < 16; i++)
+            packet.int32(i * 7919 - 40000);
+        packet.closeMessage();
+    });
+    addFormat(registry, "bundle", [](Client::Packet& packet) {
+        packet.openBundle(1);
+        for (int i = 0; i < 8; i++)
+        {
+            packet.openMessage("/voice/pitch", 2)
+                .int32(i)
+                .float32(220.f * static_cast<float>(i + 1))
+                .closeMessage();
+        }
+        packet.closeBundle();
+    });
+}
+
+}} // namespace OSCPP::Bench
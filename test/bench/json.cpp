@@ -0,0 +1,127 @@
+#include "bench.hpp"
+
+#include <oscpp/client.hpp>
+#include <oscpp/detail/base64.hpp>
+#include <oscpp/json.hpp>
+
+#include <vector>
+
+// JSON conversion in both directions and the Base64 codec used for blobs.
+// Each operation converts one packet, so ns/op is the inverse of the
+// message rate for single message workloads.
+
+namespace OSCPP { namespace Bench {
+
+namespace {
+
+typedef void (*Builder)(Client::Packet&);
+
+void addJson(Registry& registry, const std::string& name, Builder build)
+{
+    registry.add("json/write/" + name, [build](State& state) {
+        Client::DynamicPacket packet(65536);
+        build(packet);
+        const Server::Packet serverPacket(packet.data(), packet.size());
+        std::vector<char>    buffer(4 * 65536);
+        state.setBytesPerOp(
+            Json::write(serverPacket, buffer.data(), buffer.size()));
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            const size_t n =
+                Json::write(serverPacket, buffer.data(), buffer.size());
+            doNotOptimize(n);
+        }
+    });
+
+    registry.add("json/read/" + name, [build](State& state) {
+        Client::DynamicPacket packet(65536);
+        build(packet);
+        std::vector<char> json(4 * 65536);
+        json.resize(Json::write(Server::Packet(packet.data(), packet.size()),
+                                json.data(), json.size()));
+        state.setBytesPerOp(json.size());
+        Json::Reader reader;
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            packet.reset();
+            reader.read(json.data(), json.size(), packet);
+            doNotOptimize(packet.size());
+        }
+    });
+}
+
+void buildBlob(Client::Packet& packet)
+{
+    std::vector<char> data(4096);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = static_cast<char>(i * 7);
+    packet.openMessage("/buffer/set", 2)
+        .int32(1)
+        .blob(Blob(data.data(), data.size()))
+        .closeMessage();
+}
+
+} // namespace
+
+void registerJson(Registry& registry)
+{
+    addJson(registry, "n_set-isf", [](Client::Packet& packet) {
+        packet.openMessage("/n_set", 3)
+            .int32(1000)
+            .string("freq")
+            .float32(440.f)
+            .closeMessage();
+    });
+    addJson(registry, "floats", [](Client::Packet& packet) {
+        packet.openMessage("/mixer/channel/12/eq", 16);
+        for (int i = 0; i < 16; i++)
+            packet.float32(static_cast<float>(i) * 0.173f - 1.3f);
+        packet.closeMessage();
+    });
+    addJson(registry, "bundle", [](Client::Packet& packet) {
+        packet.openBundle(1);
+        for (int i = 0; i < 8; i++)
+        {
+            packet.openMessage("/voice/pitch", 2)
+                .int32(i)
+                .float32(220.f * static_cast<float>(i + 1))
+                .closeMessage();
+        }
+        packet.closeBundle();
+    });
+    addJson(registry, "blob-4k", buildBlob);
+
+    registry.add("base64/encode/64k", [](State& state) {
+        std::vector<char> data(65536);
+        for (size_t i = 0; i < data.size(); i++)
+            data[i] = static_cast<char>(i * 7);
+        std::vector<char> text(detail::base64EncodedSize(data.size()));
+        state.setBytesPerOp(data.size());
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            detail::base64Encode(data.data(), data.size(), text.data());
+            doNotOptimize(text[0]);
+        }
+    });
+
+    registry.add("base64/decode/64k", [](State& state) {
+        std::vector<char> data(65536);
+        for (size_t i = 0; i < data.size(); i++)
+            data[i] = static_cast<char>(i * 7);
+        std::vector<char> text(detail::base64EncodedSize(data.size()));
+        detail::base64Encode(data.data(), data.size(), text.data());
+        state.setBytesPerOp(data.size());
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            const size_t n =
+                detail::base64Decode(text.data(), text.size(), data.data());
+            doNotOptimize(n);
+        }
+    });
+}
+
+}} // namespace OSCPP::Bench
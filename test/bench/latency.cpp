@@ -0,0 +1,126 @@
+#include "bench.hpp"
+
+#include <oscpp/client.hpp>
+#include <oscpp/latency.hpp>
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+// Per-message overhead of LatencyRecorder: dispatching a bundle of
+// messages to a trivial handler without instrumentation, timed with two
+// clock reads (time) or one (lap) per message, and recording a
+// precomputed duration only.
+
+namespace OSCPP { namespace Bench {
+
+namespace {
+
+const size_t kNumMessages = 256;
+const size_t kNumAddresses = 64;
+
+std::shared_ptr<Client::DynamicPacket> makeBundle()
+{
+    std::shared_ptr<Client::DynamicPacket> packet(
+        new Client::DynamicPacket(kNumMessages * 64 + 64));
+    char address[32];
+    packet->openBundle(1);
+    for (size_t i = 0; i < kNumMessages; i++)
+    {
+        std::snprintf(address, sizeof(address), "/synth/%zu/freq",
+                      i % kNumAddresses);
+        packet->openMessage(address, 1)
+            .float32(static_cast<float>(i))
+            .closeMessage();
+    }
+    packet->closeBundle();
+    return packet;
+}
+
+std::vector<Server::Message> parseBundle(const Client::Packet& packet)
+{
+    std::vector<Server::Message> messages;
+    const Server::Bundle bundle =
+        Server::Packet(packet.data(), packet.size());
+    Server::PacketStream packets(bundle.packets());
+    while (!packets.atEnd())
+        messages.push_back(packets.next());
+    return messages;
+}
+
+void handle(const Server::Message& msg)
+{
+    doNotOptimize(msg.args().float32());
+}
+
+} // namespace
+
+void registerLatency(Registry& registry)
+{
+    registry.add("latency/none", [](State& state) {
+        auto packet = makeBundle();
+        auto messages = parseBundle(*packet);
+        state.setBytesPerOp(packet->size());
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            for (const Server::Message& msg : messages)
+                handle(msg);
+        }
+    });
+
+    registry.add("latency/time", [](State& state) {
+        auto                   packet = makeBundle();
+        auto                   messages = parseBundle(*packet);
+        LatencyRecorder        recorder;
+        LatencyRecorder::Local local(recorder);
+        state.setBytesPerOp(packet->size());
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            for (const Server::Message& msg : messages)
+                local.time(msg, handle);
+        }
+        state.stopTimer();
+        doNotOptimize(recorder.snapshot().total().count());
+    });
+
+    registry.add("latency/lap", [](State& state) {
+        auto                   packet = makeBundle();
+        auto                   messages = parseBundle(*packet);
+        LatencyRecorder        recorder;
+        LatencyRecorder::Local local(recorder);
+        state.setBytesPerOp(packet->size());
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            local.start();
+            for (const Server::Message& msg : messages)
+            {
+                handle(msg);
+                local.lap(msg);
+            }
+        }
+        state.stopTimer();
+        doNotOptimize(recorder.snapshot().total().count());
+    });
+
+    registry.add("latency/record", [](State& state) {
+        auto                   packet = makeBundle();
+        auto                   messages = parseBundle(*packet);
+        LatencyRecorder        recorder;
+        LatencyRecorder::Local local(recorder);
+        state.setBytesPerOp(packet->size());
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            uint64_t nanos = i;
+            for (const Server::Message& msg : messages)
+                local.record(msg, nanos++);
+        }
+        state.stopTimer();
+        doNotOptimize(recorder.snapshot().total().count());
+    });
+}
+
+}} // namespace OSCPP::Bench
@@ -0,0 +1,256 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <thread>
+
+// Microbenchmark driver.
+//
+// Usage: oscpp_bench [--json] [--quick] [--filter SUBSTRING]
+//                    [--min-time SECONDS] [--repetitions N]
+//
+// Every benchmark is calibrated to run for at least the minimum time and
+// the fastest of several repetitions is reported, which keeps results
+// reproducible across runs on a quiet machine.
+
+namespace {
+
+struct Options
+{
+    bool        json = false;
+    std::string filter;
+    double      minTime = 0.2;
+    size_t      repetitions = 3;
+};
+
+struct Result
+{
+    std::string            name;
+    size_t                 iterations;
+    double                 nsPerOp;
+    double                 bytesPerSec;
+    double                 instructionsPerOp;
+    OSCPP::Bench::Counters counters;
+};
+
+void usage(const char* program)
+{
+    std::fprintf(stderr,
+                 "Usage: %s [--json] [--quick] [--filter SUBSTRING] "
+                 "[--min-time SECONDS] [--repetitions N]\n",
+                 program);
+    std::exit(1);
+}
+
+Options parseOptions(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--json") == 0)
+        {
+            options.json = true;
+        }
+        else if (std::strcmp(arg, "--quick") == 0)
+        {
+            options.minTime = 0;
+            options.repetitions = 1;
+        }
+        else if (std::strcmp(arg, "--filter") == 0 && i + 1 < argc)
+        {
+            options.filter = argv[++i];
+        }
+        else if (std::strcmp(arg, "--min-time") == 0 && i + 1 < argc)
+        {
+            options.minTime = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(arg, "--repetitions") == 0 && i + 1 < argc)
+        {
+            options.repetitions =
+                std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        }
+        else
+        {
+            usage(argv[0]);
+        }
+    }
+    return options;
+}
+
+Result run(const OSCPP::Bench::Benchmark&    benchmark,
+           OSCPP::Bench::InstructionCounter& counter, const Options& options)
+{
+    // Calibrate the iteration count to the minimum run time
+    size_t iterations = 1;
+    for (;;)
+    {
+        OSCPP::Bench::State state(iterations, counter);
+        benchmark.function(state);
+        state.stopTimer();
+        const double secs = state.seconds();
+        if (secs >= options.minTime / 10 || iterations >= (1u << 30))
+        {
+            if (secs < options.minTime)
+            {
+                const double scale =
+                    secs > 0 ? options.minTime / secs : 1000;
+                iterations = static_cast<size_t>(iterations * scale) + 1;
+            }
+            break;
+        }
+        iterations *= 10;
+    }
+
+    Result result;
+    result.name = benchmark.name;
+    result.iterations = iterations;
+    result.nsPerOp = std::numeric_limits<double>::max();
+    result.bytesPerSec = 0;
+    result.instructionsPerOp = -1;
+    for (size_t i = 0; i < options.repetitions; i++)
+    {
+        OSCPP::Bench::State state(iterations, counter);
+        benchmark.function(state);
+        state.stopTimer();
+        const double nsPerOp = state.seconds() * 1e9 / iterations;
+        if (nsPerOp < result.nsPerOp)
+        {
+            result.nsPerOp = nsPerOp;
+            result.bytesPerSec =
+                nsPerOp > 0 ? state.bytesPerOp() * 1e9 / nsPerOp : 0;
+            result.counters = state.counters();
+            if (counter.available())
+            {
+                result.instructionsPerOp =
+                    static_cast<double>(state.instructions()) / iterations;
+            }
+        }
+    }
+    return result;
+}
+
+void printJsonString(const std::string& str)
+{
+    std::putchar('"');
+    for (char c : str)
+    {
+        if (c == '"' || c == '\\')
+            std::putchar('\\');
+        std::putchar(c);
+    }
+    std::putchar('"');
+}
+
+// JSON has no representation of infinity and NaN, print them as null.
+void printJsonNumber(const char* format, double x)
+{
+    if (std::isfinite(x))
+        std::printf(format, x);
+    else
+        std::printf("null");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const Options options = parseOptions(argc, argv);
+
+    OSCPP::Bench::Registry registry;
+    OSCPP::Bench::registerWorkloads(registry);
+    OSCPP::Bench::registerParse(registry);
+    OSCPP::Bench::registerDispatch(registry);
+    OSCPP::Bench::registerLatency(registry);
+    OSCPP::Bench::registerPcap(registry);
+    OSCPP::Bench::registerFormat(registry);
+    OSCPP::Bench::registerJson(registry);
+    OSCPP::Bench::registerBatch(registry);
+    OSCPP::Bench::registerRouter(registry);
+    OSCPP::Bench::registerEdit(registry);
+    OSCPP::Bench::registerFilter(registry);
+    OSCPP::Bench::registerThrottle(registry);
+    OSCPP::Bench::registerDelta(registry);
+    OSCPP::Bench::registerState(registry);
+    OSCPP::Bench::registerFanOut(registry);
+    OSCPP::Bench::registerQueue(registry);
+
+    OSCPP::Bench::InstructionCounter counter;
+
+    if (options.json)
+    {
+        std::printf("{\n  \"context\": {\"hardware_concurrency\": %u, "
+                    "\"instruction_counter\": %s},\n  \"benchmarks\": [",
+                    std::thread::hardware_concurrency(),
+                    counter.available() ? "true" : "false");
+    }
+    else
+    {
+        std::printf("%-40s %12s %12s %12s %10s\n", "benchmark", "iterations",
+                    "ns/op", "MB/s", "instr/op");
+    }
+
+    bool first = true;
+    for (const auto& benchmark : registry.benchmarks())
+    {
+        if (!options.filter.empty() &&
+            benchmark.name.find(options.filter) == std::string::npos)
+            continue;
+
+        const Result result = run(benchmark, counter, options);
+
+        if (options.json)
+        {
+            std::printf("%s\n    {\"name\": ", first ? "" : ",");
+            printJsonString(result.name);
+            std::printf(", \"iterations\": %zu, \"ns_per_op\": ",
+                        result.iterations);
+            printJsonNumber("%.3f", result.nsPerOp);
+            std::printf(", \"bytes_per_sec\": ");
+            printJsonNumber("%.0f", result.bytesPerSec);
+            std::printf(", \"instructions_per_op\": ");
+            if (result.instructionsPerOp >= 0)
+                printJsonNumber("%.1f", result.instructionsPerOp);
+            else
+                std::printf("null");
+            if (!result.counters.empty())
+            {
+                std::printf(", \"counters\": {");
+                for (size_t i = 0; i < result.counters.size(); i++)
+                {
+                    std::printf("%s", i > 0 ? ", " : "");
+                    printJsonString(result.counters[i].first);
+                    std::printf(": ");
+                    printJsonNumber("%g", result.counters[i].second);
+                }
+                std::printf("}");
+            }
+            std::printf("}");
+        }
+        else
+        {
+            std::printf("%-40s %12zu %12.2f %12.1f ", result.name.c_str(),
+                        result.iterations, result.nsPerOp,
+                        result.bytesPerSec / 1e6);
+            if (result.instructionsPerOp >= 0)
+                std::printf("%10.1f", result.instructionsPerOp);
+            else
+                std::printf("%10s", "-");
+            for (const auto& counter : result.counters)
+                std::printf(" %s=%g", counter.first.c_str(), counter.second);
+            std::printf("\n");
+        }
+        std::fflush(stdout);
+        first = false;
+    }
+
+    if (options.json)
+        std::printf("\n  ]\n}\n");
+
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "bench.hpp"
+
+#include <oscpp/client.hpp>
+#include <oscpp/server.hpp>
+
+#include <memory>
+
+// Message construction, comparing the separate address and tag string
+// scans of the stream based Message constructor with the fused parse in
+// Packet::operator Message().
+
+namespace OSCPP { namespace Bench {
+
+namespace {
+
+typedef void (*Builder)(Client::Packet&);
+
+void addMessage(Registry& registry, const std::string& name, Builder build)
+{
+    registry.add("message/" + name + "/separate", [build](State& state) {
+        Client::StaticPacket<256> packet;
+        build(packet);
+        state.setBytesPerOp(packet.size());
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            ReadStream      stream(packet.data(), packet.size());
+            const char*     address = stream.getString();
+            Server::Message msg(address, stream);
+            doNotOptimize(msg.args().size() + msg.address()[1]);
+        }
+    });
+
+    registry.add("message/" + name + "/fused", [build](State& state) {
+        Client::StaticPacket<256> packet;
+        build(packet);
+        state.setBytesPerOp(packet.size());
+        const Server::Packet serverPacket(packet.data(), packet.size());
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            Server::Message msg(serverPacket);
+            doNotOptimize(msg.args().size() + msg.address()[1]);
+        }
+    });
+}
+
+} // namespace
+
+void registerParse(Registry& registry)
+{
+    addMessage(registry, "n_set-isf", [](Client::Packet& packet) {
+        packet.openMessage("/n_set", 3)
+            .int32(1)
+            .string("freq")
+            .float32(440.f)
+            .closeMessage();
+    });
+    addMessage(registry, "fader-f", [](Client::Packet& packet) {
+        packet.openMessage("/fader", 1).float32(0.5f).closeMessage();
+    });
+    addMessage(registry, "eq-ffffff", [](Client::Packet& packet) {
+        packet.openMessage("/mixer/channel/12/eq/band/3", 6);
+        for (int i = 0; i < 6; i++)
+            packet.float32(static_cast<float>(i));
+        packet.closeMessage();
+    });
+}
+
+}} // namespace OSCPP::Bench
@@ -0,0 +1,82 @@
+#include "bench.hpp"
+
+#include <oscpp/client.hpp>
+#include <oscpp/pcap.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Extracting OSC packets from an Ethernet capture written by
+// Pcap::Writer, read through the file mapping and from memory.
+
+namespace OSCPP { namespace Bench {
+
+namespace {
+
+const size_t kNumPackets = 20000;
+const char*  kPath = "oscpp_bench.pcap";
+
+std::vector<char> makeCapture()
+{
+    {
+        Pcap::Writer              writer(kPath);
+        Client::StaticPacket<256> packet;
+        for (size_t i = 0; i < kNumPackets; i++)
+        {
+            packet.reset();
+            packet.openMessage("/synth/1/freq", 2)
+                .int32(static_cast<int32_t>(i))
+                .float32(440.f)
+                .closeMessage();
+            writer.write(i * 1000, packet);
+        }
+    }
+    std::ifstream     file(kPath, std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(file)),
+                           std::istreambuf_iterator<char>());
+    return data;
+}
+
+size_t readAll(Pcap::Reader& reader)
+{
+    size_t bytes = 0;
+    while (!reader.atEnd())
+        bytes += reader.next().packet.size();
+    return bytes;
+}
+
+} // namespace
+
+void registerPcap(Registry& registry)
+{
+    registry.add("pcap/read/mmap", [](State& state) {
+        const std::vector<char> capture = makeCapture();
+        state.setBytesPerOp(capture.size());
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            Pcap::Reader reader(kPath, {57120});
+            doNotOptimize(readAll(reader));
+        }
+        state.stopTimer();
+        std::remove(kPath);
+    });
+
+    registry.add("pcap/read/memory", [](State& state) {
+        const std::vector<char> capture = makeCapture();
+        std::remove(kPath);
+        state.setBytesPerOp(capture.size());
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            Pcap::Reader reader(Pcap::Buffer{capture.data(), capture.size()},
+                                {57120});
+            doNotOptimize(readAll(reader));
+        }
+    });
+}
+
+}} // namespace OSCPP::Bench
@@ -0,0 +1,159 @@
+#include "bench.hpp"
+
+#include <oscpp/client.hpp>
+#include <oscpp/queue.hpp>
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Queueing fader updates for sending with Client::SendQueue, and with a
+// mutex protected std::deque of std::vector<char> for comparison. The
+// push-drain benchmarks update 64 addresses and drain the queue after
+// every 16 messages; the slow-receiver benchmarks update 16 addresses
+// and simulate a sink accepting one packet for every four pushed into a
+// queue of 32 packets, and report the fractions of messages dropped
+// and coalesced and the mean queue depth.
+
+namespace OSCPP { namespace Bench {
+
+namespace {
+
+const size_t kMaxPacketSize = 64;
+
+std::vector<std::string> makeAddresses(size_t n)
+{
+    std::vector<std::string> addresses;
+    for (size_t i = 0; i < n; i++)
+        addresses.push_back("/mixer/fader/" + std::to_string(i));
+    return addresses;
+}
+
+// Queue with a deque of heap allocated packets.
+class DequeQueue
+{
+public:
+    void push(const std::string& address, float value)
+    {
+        Client::StaticPacket<kMaxPacketSize> packet;
+        packet.openMessage(address.c_str(), 1).float32(value).closeMessage();
+        const char* data = static_cast<const char*>(packet.data());
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_packets.emplace_back(data, data + packet.size());
+    }
+
+    template <typename Sink> size_t drain(Sink sink)
+    {
+        size_t n = 0;
+        for (;;)
+        {
+            std::vector<char> packet;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_packets.empty())
+                    break;
+                packet.swap(m_packets.front());
+                m_packets.pop_front();
+            }
+            sink(packet.data(), packet.size());
+            n++;
+        }
+        return n;
+    }
+
+private:
+    std::mutex                    m_mutex;
+    std::deque<std::vector<char>> m_packets;
+};
+
+struct NullSink
+{
+    bool operator()(const void* data, size_t size) const
+    {
+        doNotOptimize(data);
+        doNotOptimize(size);
+        return true;
+    }
+};
+
+void addSlowReceiver(Registry& registry, const std::string& name,
+                     Client::DropPolicy policy)
+{
+    registry.add("queue/slow-receiver/" + name, [policy](State& state) {
+        const std::vector<std::string> addresses = makeAddresses(16);
+        Client::SendQueue queue(32, kMaxPacketSize, policy, 24, 8);
+        double            depth = 0;
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            const std::string& address = addresses[i % addresses.size()];
+            const float        value = static_cast<float>(i);
+            queue.push([&](Client::Packet& packet) {
+                packet.openMessage(address.c_str(), 1)
+                    .float32(value)
+                    .closeMessage();
+            });
+            if (i % 4 == 3)
+                queue.drain(NullSink(), 1);
+            depth += double(queue.depth());
+        }
+        state.stopTimer();
+        const double seconds = state.seconds();
+        const double numMessages = double(state.iterations());
+        state.setCounter("msgs/s", seconds > 0 ? numMessages / seconds : 0);
+        state.setCounter("dropped", queue.numDropped() / numMessages);
+        state.setCounter("coalesced", queue.numCoalesced() / numMessages);
+        state.setCounter("depth", depth / numMessages);
+    });
+}
+
+} // namespace
+
+void registerQueue(Registry& registry)
+{
+    registry.add("queue/push-drain", [](State& state) {
+        const std::vector<std::string> addresses = makeAddresses(64);
+        Client::SendQueue              queue(16, kMaxPacketSize);
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            const std::string& address = addresses[i % addresses.size()];
+            const float        value = static_cast<float>(i);
+            queue.push([&](Client::Packet& packet) {
+                packet.openMessage(address.c_str(), 1)
+                    .float32(value)
+                    .closeMessage();
+            });
+            if (i % 16 == 15)
+                queue.drain(NullSink());
+        }
+        state.stopTimer();
+        const double seconds = state.seconds();
+        state.setCounter("msgs/s",
+                         seconds > 0 ? state.iterations() / seconds : 0);
+    });
+
+    registry.add("queue/push-drain/mutex-deque", [](State& state) {
+        const std::vector<std::string> addresses = makeAddresses(64);
+        DequeQueue                     queue;
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            queue.push(addresses[i % addresses.size()], static_cast<float>(i));
+            if (i % 16 == 15)
+                queue.drain(NullSink());
+        }
+        state.stopTimer();
+        const double seconds = state.seconds();
+        state.setCounter("msgs/s",
+                         seconds > 0 ? state.iterations() / seconds : 0);
+    });
+
+    addSlowReceiver(registry, "drop-oldest", Client::DropPolicy::DropOldest);
+    addSlowReceiver(registry, "drop-newest", Client::DropPolicy::DropNewest);
+    addSlowReceiver(registry, "coalesce",
+                    Client::DropPolicy::CoalesceByAddress);
+}
+
+}} // namespace OSCPP::Bench
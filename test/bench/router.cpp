@@ -0,0 +1,173 @@
+#include "bench.hpp"
+
+#include <oscpp/client.hpp>
+#include <oscpp/router.hpp>
+#include <oscpp/server.hpp>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Forwarding a bundle of 16 messages to four backends by address prefix
+// plus a monitor backend receiving everything, with Server::Router
+// (forward) and by parsing and rebuilding the messages of each backend
+// with Client::Packet (rebuild). Messages have a single float argument
+// (simple) or strings, a blob and an array (complex).
+
+namespace OSCPP { namespace Bench {
+
+namespace {
+
+const size_t      kNumMessages = 16;
+const size_t      kNumBackends = 5;
+const char* const kPrefixes[] = {"/mixer", "/synth", "/fx", "/light"};
+
+void buildBundle(Client::Packet& packet, bool complex)
+{
+    static const char blob[256] = {};
+    packet.openBundle(1);
+    for (size_t i = 0; i < kNumMessages; i++)
+    {
+        const std::string address =
+            std::string(kPrefixes[i % 4]) + "/" + std::to_string(i);
+        if (complex)
+        {
+            packet.openMessage(address.c_str(), 8)
+                .string("channel name")
+                .int32(static_cast<int32_t>(i))
+                .blob(Blob(blob, sizeof(blob)))
+                .openArray()
+                .float32(1.f)
+                .float32(2.f)
+                .closeArray()
+                .string("tail")
+                .closeMessage();
+        }
+        else
+        {
+            packet.openMessage(address.c_str(), 1)
+                .float32(static_cast<float>(i))
+                .closeMessage();
+        }
+    }
+    packet.closeBundle();
+}
+
+// Copy the arguments of a message, as a proxy without raw forwarding
+// would have to.
+size_t countTags(Server::ArgStream args)
+{
+    size_t n = 0;
+    while (!args.atEnd())
+    {
+        const char t = args.tag();
+        n++;
+        if (t == '[')
+            n += countTags(args.array()) + 1;
+        else
+            args.drop();
+    }
+    return n;
+}
+
+void copyArgs(Server::ArgStream args, Client::Packet& packet)
+{
+    while (!args.atEnd())
+    {
+        switch (args.tag())
+        {
+            case 'i':
+                packet.int32(args.int32());
+                break;
+            case 'f':
+                packet.float32(args.float32());
+                break;
+            case 's':
+                packet.string(args.string());
+                break;
+            case 'b':
+                packet.blob(args.blob());
+                break;
+            case '[':
+                packet.openArray();
+                copyArgs(args.array(), packet);
+                packet.closeArray();
+                break;
+            default:
+                args.drop();
+        }
+    }
+}
+
+Server::Router makeRouter()
+{
+    Server::Router router(kNumBackends);
+    for (size_t b = 0; b < 4; b++)
+        router.addRoute(kPrefixes[b], b);
+    router.addRoute("", 4);
+    return router;
+}
+
+void addRouter(Registry& registry, const std::string& name, bool complex)
+{
+    registry.add("router/forward/" + name, [complex](State& state) {
+        Client::StaticPacket<8192> packet;
+        buildBundle(packet, complex);
+        const Server::Packet serverPacket(packet.data(), packet.size());
+        Server::Router       router = makeRouter();
+        state.setBytesPerOp(packet.size());
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            router.route(serverPacket,
+                         [](size_t, const Server::Fragment* fragments,
+                            size_t numFragments, size_t size) {
+                             doNotOptimize(fragments);
+                             doNotOptimize(numFragments + size);
+                         });
+        }
+    });
+
+    registry.add("router/rebuild/" + name, [complex](State& state) {
+        Client::StaticPacket<8192> packet;
+        buildBundle(packet, complex);
+        const Server::Packet       serverPacket(packet.data(), packet.size());
+        Client::StaticPacket<8192> out;
+        state.setBytesPerOp(packet.size());
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            for (size_t b = 0; b < kNumBackends; b++)
+            {
+                const char*          prefix = b < 4 ? kPrefixes[b] : "";
+                const size_t         length = std::strlen(prefix);
+                const Server::Bundle bundle(serverPacket);
+                Server::PacketStream packets(bundle.packets());
+                out.reset();
+                out.openBundle(bundle.time());
+                while (!packets.atEnd())
+                {
+                    const Server::Message msg(packets.next());
+                    if (std::strncmp(msg.address(), prefix, length) != 0)
+                        continue;
+                    out.openMessage(msg.address(), msg.addressLength(),
+                                    countTags(msg.args()));
+                    copyArgs(msg.args(), out);
+                    out.closeMessage();
+                }
+                out.closeBundle();
+                doNotOptimize(out.size());
+            }
+        }
+    });
+}
+
+} // namespace
+
+void registerRouter(Registry& registry)
+{
+    addRouter(registry, "simple", false);
+    addRouter(registry, "complex", true);
+}
+
+}} // namespace OSCPP::Bench
@@ -0,0 +1,228 @@
+#include "bench.hpp"
+
+#include <oscpp/client.hpp>
+#include <oscpp/server.hpp>
+#include <oscpp/state.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+// Keeping the latest value of 256 addresses, each updated with messages
+// carrying a counter twice, with Server::StateStore and with a mutex
+// protected std::unordered_map from address to value for comparison.
+// Reports the number of messages stored or read per second; the
+// concurrent benchmark reads while another thread keeps updating and
+// also reports the fraction of reads seeing mismatched counters, which
+// must be zero.
+
+namespace OSCPP { namespace Bench {
+
+namespace {
+
+const size_t kNumAddresses = 256;
+const size_t kNumBundles = 64;
+const size_t kBundleSize = 64;
+
+std::string addressOf(size_t i)
+{
+    return "/mixer/fader/" + std::to_string(i % kNumAddresses);
+}
+
+std::vector<std::vector<char>> makeBundles()
+{
+    std::vector<std::vector<char>> bundles;
+    size_t                         n = 0;
+    for (size_t b = 0; b < kNumBundles; b++)
+    {
+        Client::StaticPacket<4096> packet;
+        packet.openBundle(1);
+        for (size_t i = 0; i < kBundleSize; i++, n++)
+        {
+            const int32_t value = static_cast<int32_t>(n);
+            packet.openMessage(addressOf(n * 7).c_str(), 2)
+                .int32(value)
+                .int32(value)
+                .closeMessage();
+        }
+        packet.closeBundle();
+        const char* data = static_cast<const char*>(packet.data());
+        bundles.emplace_back(data, data + packet.size());
+    }
+    return bundles;
+}
+
+// Stores and reads with Server::StateStore.
+class StoreState
+{
+public:
+    StoreState()
+    : m_store(kNumAddresses, 64)
+    , m_value(m_store)
+    {}
+
+    void update(const Server::Packet& packet)
+    {
+        m_store.updateAll(packet);
+    }
+
+    bool read(const std::string& address, int32_t& a, int32_t& b)
+    {
+        if (!m_store.read(address.c_str(), address.size(), m_value))
+            return false;
+        Server::ArgStream args(m_value.args());
+        a = args.int32();
+        b = args.int32();
+        return true;
+    }
+
+private:
+    Server::StateStore        m_store;
+    Server::StateStore::Value m_value;
+};
+
+// Stores and reads with a hash map protected by a mutex.
+class MapState
+{
+public:
+    void update(const Server::Packet& packet)
+    {
+        Server::PacketStream elements(Server::Bundle(packet).packets());
+        while (!elements.atEnd())
+        {
+            const Server::Message msg(elements.next());
+            ReadStream            tags, args;
+            std::tie(tags, args) = msg.args().state();
+            const char*                 value = tags.begin() - 1;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_values[msg.address()].assign(value, args.end());
+        }
+    }
+
+    bool read(const std::string& address, int32_t& a, int32_t& b)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const auto                  it = m_values.find(address);
+            if (it == m_values.end())
+                return false;
+            m_value = it->second;
+        }
+        Server::ArgStream args(ReadStream(m_value.data(), m_value.size()));
+        a = args.int32();
+        b = args.int32();
+        return true;
+    }
+
+private:
+    std::mutex                                   m_mutex;
+    std::unordered_map<std::string, std::string> m_values;
+    std::string                                  m_value;
+};
+
+template <typename S>
+void addState(Registry& registry, const std::string& name)
+{
+    registry.add("state/update" + name, [](State& state) {
+        const std::vector<std::vector<char>> bundles = makeBundles();
+        S                                    store;
+        state.setBytesPerOp(bundles[0].size());
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            const std::vector<char>& bundle = bundles[i % kNumBundles];
+            store.update(Server::Packet(bundle.data(), bundle.size()));
+        }
+        state.stopTimer();
+        const double seconds = state.seconds();
+        const double numMessages = double(kBundleSize) * state.iterations();
+        state.setCounter("msgs/s", seconds > 0 ? numMessages / seconds : 0);
+    });
+
+    registry.add("state/read" + name, [](State& state) {
+        const std::vector<std::vector<char>> bundles = makeBundles();
+        S                                    store;
+        for (const std::vector<char>& bundle : bundles)
+            store.update(Server::Packet(bundle.data(), bundle.size()));
+        std::vector<std::string> addresses;
+        for (size_t i = 0; i < kNumAddresses; i++)
+            addresses.push_back(addressOf(i));
+        int64_t sum = 0;
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            int32_t a = 0, b = 0;
+            store.read(addresses[i % kNumAddresses], a, b);
+            sum += a;
+        }
+        state.stopTimer();
+        doNotOptimize(sum);
+        const double seconds = state.seconds();
+        const double numReads = double(state.iterations());
+        state.setCounter("reads/s", seconds > 0 ? numReads / seconds : 0);
+    });
+
+    registry.add("state/read-while-writing" + name, [](State& state) {
+        const std::vector<std::vector<char>> bundles = makeBundles();
+        S                                    store;
+        for (const std::vector<char>& bundle : bundles)
+            store.update(Server::Packet(bundle.data(), bundle.size()));
+        std::vector<std::string> addresses;
+        for (size_t i = 0; i < kNumAddresses; i++)
+            addresses.push_back(addressOf(i));
+        std::atomic<bool> done(false);
+        std::thread       writer([&] {
+            for (size_t i = 0; !done.load(std::memory_order_relaxed); i++)
+            {
+                const std::vector<char>& bundle = bundles[i % kNumBundles];
+                store.update(Server::Packet(bundle.data(), bundle.size()));
+            }
+        });
+        size_t torn = 0;
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            int32_t a = 0, b = 0;
+            store.read(addresses[i % kNumAddresses], a, b);
+            torn += a != b;
+        }
+        state.stopTimer();
+        done = true;
+        writer.join();
+        const double seconds = state.seconds();
+        const double numReads = double(state.iterations());
+        state.setCounter("reads/s", seconds > 0 ? numReads / seconds : 0);
+        state.setCounter("torn", torn / numReads);
+    });
+}
+
+} // namespace
+
+void registerState(Registry& registry)
+{
+    addState<StoreState>(registry, "");
+    addState<MapState>(registry, "/mutex-map");
+
+    registry.add("state/snapshot", [](State& state) {
+        const std::vector<std::vector<char>> bundles = makeBundles();
+        Server::StateStore                   store(kNumAddresses, 64);
+        for (const std::vector<char>& bundle : bundles)
+            store.updateAll(Server::Packet(bundle.data(), bundle.size()));
+        Client::DynamicPacket packet(kNumAddresses * 64);
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            packet.reset();
+            store.snapshot(packet);
+            doNotOptimize(packet.size());
+        }
+        state.stopTimer();
+        state.setBytesPerOp(packet.size());
+    });
+}
+
+}} // namespace OSCPP::Bench
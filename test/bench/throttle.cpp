@@ -0,0 +1,154 @@
+#include "bench.hpp"
+
+#include <oscpp/client.hpp>
+#include <oscpp/server.hpp>
+#include <oscpp/throttle.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+// Deduplicating and rate limiting a stream of fader updates to 256
+// addresses, where three out of four messages repeat the last value of
+// their address, with Server::Throttle and with a std::unordered_map
+// from address to last value for comparison. Messages are checked one
+// bundle of 64 at a time; reports the number of messages checked per
+// second and the fraction passed.
+
+namespace OSCPP { namespace Bench {
+
+namespace {
+
+const size_t kNumAddresses = 256;
+const size_t kNumBundles = 64;
+const size_t kBundleSize = 64;
+
+std::vector<std::vector<char>> makeBundles()
+{
+    std::vector<std::vector<char>> bundles;
+    size_t                         n = 0;
+    for (size_t b = 0; b < kNumBundles; b++)
+    {
+        Client::StaticPacket<4096> packet;
+        packet.openBundle(1);
+        for (size_t i = 0; i < kBundleSize; i++, n++)
+        {
+            const std::string address =
+                "/mixer/fader/" + std::to_string(n * 7 % kNumAddresses);
+            packet.openMessage(address.c_str(), 1)
+                .float32(static_cast<float>(n / (4 * kNumAddresses)))
+                .closeMessage();
+        }
+        packet.closeBundle();
+        const char* data = static_cast<const char*>(packet.data());
+        bundles.emplace_back(data, data + packet.size());
+    }
+    return bundles;
+}
+
+// Checks with Server::Throttle.
+class ThrottleCheck
+{
+public:
+    ThrottleCheck(std::chrono::nanoseconds interval, bool deduplicate)
+    : m_throttle(2 * kNumAddresses, 64, interval, 1, deduplicate)
+    {}
+
+    size_t operator()(const Server::Packet& packet)
+    {
+        return m_throttle.apply(packet, [](const Server::Message&) {});
+    }
+
+private:
+    Server::Throttle<> m_throttle;
+};
+
+// Checks with a hash map from address to last value and rate state.
+class MapCheck
+{
+public:
+    MapCheck(std::chrono::nanoseconds interval, bool deduplicate)
+    : m_interval(interval)
+    , m_deduplicate(deduplicate)
+    {}
+
+    size_t operator()(const Server::Packet& packet)
+    {
+        const auto           now = std::chrono::steady_clock::now();
+        size_t               n = 0;
+        Server::PacketStream elements(Server::Bundle(packet).packets());
+        while (!elements.atEnd())
+        {
+            const Server::Message msg(elements.next());
+            Entry&                entry = m_entries[msg.address()];
+            ReadStream            tags, args;
+            std::tie(tags, args) = msg.args().state();
+            const char*       value = tags.begin() - 1;
+            const std::string current(value, args.end());
+            if (m_deduplicate && entry.value == current)
+                continue;
+            if (m_interval.count() > 0)
+            {
+                if (entry.full > now)
+                    continue;
+                entry.full = std::max(entry.full, now) + m_interval;
+            }
+            if (m_deduplicate)
+                entry.value = current;
+            n++;
+        }
+        return n;
+    }
+
+private:
+    struct Entry
+    {
+        std::string                           value;
+        std::chrono::steady_clock::time_point full;
+    };
+
+    std::chrono::nanoseconds               m_interval;
+    bool                                   m_deduplicate;
+    std::unordered_map<std::string, Entry> m_entries;
+};
+
+template <typename Check>
+void addThrottle(Registry& registry, const std::string& name,
+                 std::chrono::nanoseconds interval, bool deduplicate)
+{
+    registry.add("throttle/" + name, [=](State& state) {
+        const std::vector<std::vector<char>> bundles = makeBundles();
+        Check  check(interval, deduplicate);
+        size_t passed = 0;
+        state.setBytesPerOp(bundles[0].size());
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            const std::vector<char>& bundle = bundles[i % kNumBundles];
+            passed += check(Server::Packet(bundle.data(), bundle.size()));
+        }
+        state.stopTimer();
+        const double seconds = state.seconds();
+        const double numMessages = double(kBundleSize) * state.iterations();
+        state.setCounter("msgs/s", seconds > 0 ? numMessages / seconds : 0);
+        state.setCounter("passed", passed / numMessages);
+    });
+}
+
+} // namespace
+
+void registerThrottle(Registry& registry)
+{
+    const std::chrono::nanoseconds none(0);
+    const std::chrono::nanoseconds rate = std::chrono::microseconds(10);
+    addThrottle<ThrottleCheck>(registry, "dedup", none, true);
+    addThrottle<ThrottleCheck>(registry, "rate", rate, false);
+    addThrottle<ThrottleCheck>(registry, "dedup-rate", rate, true);
+    addThrottle<MapCheck>(registry, "dedup/unordered_map", none, true);
+    addThrottle<MapCheck>(registry, "dedup-rate/unordered_map", rate, true);
+}
+
+}} // namespace OSCPP::Bench
@@ -0,0 +1,223 @@
+#include "bench.hpp"
+
+#include <oscpp/client.hpp>
+#include <oscpp/server.hpp>
+
+#include <memory>
+#include <vector>
+
+// Packet construction and parsing workloads.
+
+namespace OSCPP { namespace Bench {
+
+namespace {
+
+typedef void (*Builder)(Client::Packet&);
+
+void buildSmall(Client::Packet& packet)
+{
+    packet.openMessage("/n_set", 3)
+        .int32(1000)
+        .string("freq")
+        .float32(440.f)
+        .closeMessage();
+}
+
+const size_t kBlobSize = 64 * 1024;
+
+void buildBlob(Client::Packet& packet)
+{
+    static const std::vector<char> data(kBlobSize, 'x');
+    packet.openMessage("/b_setn", 2)
+        .int32(1)
+        .blob(Blob(data.data(), data.size()))
+        .closeMessage();
+}
+
+const size_t kBundleDepth = 16;
+
+void buildDeepBundle(Client::Packet& packet)
+{
+    for (size_t i = 0; i < kBundleDepth; i++)
+    {
+        packet.openBundle(i + 1);
+        packet.openMessage("/level", 2)
+            .int32(static_cast<int32_t>(i))
+            .float32(static_cast<float>(i))
+            .closeMessage();
+    }
+    for (size_t i = 0; i < kBundleDepth; i++)
+        packet.closeBundle();
+}
+
+const size_t kNumFloats = 256;
+
+void buildFloatArray(Client::Packet& packet)
+{
+    packet.openMessage("/b_setn", 2 + Tags::array(kNumFloats))
+        .int32(1)
+        .int32(0)
+        .openArray();
+    for (size_t i = 0; i < kNumFloats; i++)
+        packet.float32(static_cast<float>(i) * 0.25f);
+    packet.closeArray().closeMessage();
+}
+
+const size_t kNumStrings = 16;
+
+void buildStrings(Client::Packet& packet)
+{
+    static const char* const strings[] = {
+        "a",
+        "freq",
+        "amplitude",
+        "sinesweep",
+        "/some/longer/path/to/a/sound/file.wav",
+        "x",
+        "carrier-frequency",
+        "modulator-index",
+        "abc",
+        "release-time",
+        "attack",
+        "a much longer string argument that spans several words",
+        "pan",
+        "out",
+        "gate",
+        "lfo-rate"};
+    packet.openMessage("/strings", kNumStrings);
+    for (size_t i = 0; i < kNumStrings; i++)
+        packet.string(strings[i]);
+    packet.closeMessage();
+}
+
+void consumeArgs(Server::ArgStream args, uint64_t& acc)
+{
+    while (!args.atEnd())
+    {
+        switch (args.tag())
+        {
+            case 'i':
+                acc += static_cast<uint32_t>(args.int32());
+                break;
+            case 'f':
+                acc += static_cast<uint64_t>(args.float32());
+                break;
+            case 's':
+                acc += static_cast<uint8_t>(args.string()[0]);
+                break;
+            case 'b':
+                acc += args.blob().size();
+                break;
+            case '[':
+                consumeArgs(args.array(), acc);
+                break;
+            default:
+                args.drop();
+                break;
+        }
+    }
+}
+
+void consumePacket(const Server::Packet& packet, uint64_t& acc)
+{
+    if (packet.isBundle())
+    {
+        Server::Bundle       bundle(packet);
+        Server::PacketStream packets(bundle.packets());
+        acc += bundle.time();
+        while (!packets.atEnd())
+            consumePacket(packets.next(), acc);
+    }
+    else
+    {
+        Server::Message msg(packet);
+        acc += static_cast<uint8_t>(msg.address()[1]);
+        consumeArgs(msg.args(), acc);
+    }
+}
+
+std::shared_ptr<Client::DynamicPacket> makePacket(Builder build)
+{
+    std::shared_ptr<Client::DynamicPacket> packet(
+        new Client::DynamicPacket(kBlobSize + 4096));
+    build(*packet);
+    return packet;
+}
+
+void addWorkload(Registry& registry, const std::string& name, Builder build)
+{
+    registry.add("build/" + name, [build](State& state) {
+        auto packet = makePacket(build);
+        state.setBytesPerOp(packet->size());
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            packet->reset();
+            build(*packet);
+            doNotOptimize(packet->size());
+        }
+    });
+
+    registry.add("parse/" + name, [build](State& state) {
+        auto packet = makePacket(build);
+        state.setBytesPerOp(packet->size());
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            uint64_t acc = 0;
+            consumePacket(Server::Packet(packet->data(), packet->size()), acc);
+            doNotOptimize(acc);
+        }
+    });
+}
+
+} // namespace
+
+void registerWorkloads(Registry& registry)
+{
+    addWorkload(registry, "small", buildSmall);
+    addWorkload(registry, "blob-64k", buildBlob);
+    addWorkload(registry, "deep-bundle", buildDeepBundle);
+    addWorkload(registry, "float-array", buildFloatArray);
+    addWorkload(registry, "strings", buildStrings);
+
+    // Skipping all arguments of a message
+    registry.add("skip/float-array/drop", [](State& state) {
+        auto packet = makePacket(buildFloatArray);
+        state.setBytesPerOp(packet->size());
+        const Server::Message msg(
+            Server::Packet(packet->data(), packet->size()));
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            Server::ArgStream args(msg.args());
+            while (!args.atEnd())
+                args.drop();
+            doNotOptimize(args);
+        }
+    });
+    registry.add("skip/float-array/dropAll", [](State& state) {
+        auto packet = makePacket(buildFloatArray);
+        state.setBytesPerOp(packet->size());
+        const Server::Message msg(
+            Server::Packet(packet->data(), packet->size()));
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+        {
+            Server::ArgStream args(msg.args());
+            args.dropAll();
+            doNotOptimize(args);
+        }
+    });
+    registry.add("skip/strings/measure", [](State& state) {
+        auto packet = makePacket(buildStrings);
+        state.setBytesPerOp(packet->size());
+        const Server::Message msg(
+            Server::Packet(packet->data(), packet->size()));
+        state.resetTimer();
+        for (size_t i = 0; i < state.iterations(); i++)
+            doNotOptimize(msg.args().measure());
+    });
+}
+
+}} // namespace OSCPP::Bench
@@ -0,0 +1,47 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+// Standalone driver for fuzz targets when libFuzzer is not available.
+//
+// Runs the target once on every file given on the command line, or on
+// standard input if there are no arguments; the latter is suitable for
+// AFL (afl-fuzz -i seeds -o findings -- oscpp_fuzz_server).
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+namespace {
+
+void runFile(std::istream& in)
+{
+    const std::vector<char> data((std::istreambuf_iterator<char>(in)),
+                                 std::istreambuf_iterator<char>());
+    LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(data.data()),
+                           data.size());
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        runFile(std::cin);
+        return 0;
+    }
+    for (int i = 1; i < argc; i++)
+    {
+        std::ifstream in(argv[i], std::ios::binary);
+        if (!in)
+        {
+            std::fprintf(stderr, "Cannot open %s\n", argv[i]);
+            return 1;
+        }
+        runFile(in);
+    }
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include "../oscpp_ast.hpp"
+#include "../oscpp_generators.hpp"
+
+#include <oscpp/client.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Write a seed corpus for the fuzz targets, generated from the random
+// packet ASTs used by oscpp_autocheck.
+//
+// Usage: oscpp_fuzz_corpus DIRECTORY [COUNT]
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "Usage: %s DIRECTORY [COUNT]\n", argv[0]);
+        return 1;
+    }
+    const std::string dir(argv[1]);
+    const size_t count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 256;
+
+    OSCPP::AutoCheck::PacketGen gen;
+    for (size_t i = 0; i < count; i++)
+    {
+        // Grow the AST size with the index, like autocheck does
+        const std::vector<char> data = OSCPP::AutoCheck::encode(*gen(i % 64));
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "/seed-%04zu.osc", i);
+        std::ofstream out(dir + name, std::ios::binary);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!out)
+        {
+            std::fprintf(stderr, "Cannot write %s%s\n", dir.c_str(), name);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,62 @@
+#include <oscpp/client.hpp>
+#include <oscpp/delta.hpp>
+#include <oscpp/server.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Fuzz target for the delta frame decoder.
+//
+// Decodes arbitrary input as a delta frame into a bundle of plain
+// messages. Decoded messages are encoded and decoded again, which must
+// restore the same bundle. Errors are expected and reported as
+// OSCPP::Error; any other exception, crash or sanitizer report is a bug.
+
+namespace {
+
+const size_t kBufferSize = 65536;
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    // Receive buffers are word aligned
+    std::vector<uint32_t> buffer((size + 3) / 4);
+    if (size > 0)
+        std::memcpy(buffer.data(), data, size);
+
+    OSCPP::Client::StaticPacket<kBufferSize> packet;
+    try
+    {
+        OSCPP::Server::DeltaDecoder decoder;
+        packet.openBundle(1);
+        decoder.decodeInto(buffer.data(), size, packet);
+        packet.closeBundle();
+    }
+    catch (OSCPP::Error&)
+    {
+        return 0;
+    }
+
+    // Definitions are larger than the messages they define
+    std::vector<uint32_t>       frame(kBufferSize / 2);
+    OSCPP::Client::DeltaEncoder encoder(frame.data(), 4 * frame.size());
+    const OSCPP::Server::Packet bundle(packet.data(), packet.size());
+    OSCPP::Server::PacketStream elements(
+        static_cast<OSCPP::Server::Bundle>(bundle).packets());
+    while (!elements.atEnd())
+        encoder.add(elements.next());
+
+    OSCPP::Client::StaticPacket<kBufferSize> packet2;
+    OSCPP::Server::DeltaDecoder              decoder;
+    packet2.openBundle(1);
+    decoder.decodeInto(encoder.data(), encoder.size(), packet2);
+    packet2.closeBundle();
+    if (packet2.size() != packet.size() ||
+        std::memcmp(packet.data(), packet2.data(), packet.size()) != 0)
+        std::abort();
+    return 0;
+}
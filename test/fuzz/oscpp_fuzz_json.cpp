@@ -0,0 +1,49 @@
+#include <oscpp/client.hpp>
+#include <oscpp/json.hpp>
+#include <oscpp/server.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Fuzz target for the JSON reader.
+//
+// Reads arbitrary input as JSON text. Input that is accepted is written
+// back as JSON, which must read back to an identical packet. Errors are
+// expected and reported as OSCPP::Error; any other exception, crash or
+// sanitizer report is a bug.
+
+namespace {
+
+const size_t kBufferSize = 65536;
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    const char*                 text = reinterpret_cast<const char*>(data);
+    OSCPP::Client::StaticPacket<kBufferSize> packet;
+    OSCPP::Json::Reader                      reader;
+    try
+    {
+        reader.read(text, size, packet);
+    }
+    catch (OSCPP::Error&)
+    {
+        return 0;
+    }
+
+    std::vector<char> json(8 * kBufferSize);
+    const size_t      length = OSCPP::Json::write(
+        OSCPP::Server::Packet(packet.data(), packet.size()), json.data(),
+        json.size());
+
+    OSCPP::Client::StaticPacket<kBufferSize> packet2;
+    if (reader.read(json.data(), length, packet2) != length ||
+        packet2.size() != packet.size() ||
+        std::memcmp(packet.data(), packet2.data(), packet.size()) != 0)
+        std::abort();
+    return 0;
+}
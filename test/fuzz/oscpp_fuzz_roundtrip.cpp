@@ -0,0 +1,266 @@
+#include <oscpp/client.hpp>
+#include <oscpp/server.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Round-trip fuzz target.
+//
+// Interprets the input as a recipe for building a packet with
+// Client::Packet, parses the result with the server API, writes it again
+// and checks that both encodings are identical.
+
+namespace {
+
+const size_t kBufferSize = 65536;
+const size_t kMaxDepth = 8;
+
+class Input
+{
+public:
+    Input(const uint8_t* data, size_t size)
+    : m_pos(data)
+    , m_end(data + size)
+    {}
+
+    uint8_t byte()
+    {
+        return m_pos < m_end ? *m_pos++ : 0;
+    }
+
+    uint32_t word()
+    {
+        uint32_t x = 0;
+        for (int i = 0; i < 4; i++)
+            x = (x << 8) | byte();
+        return x;
+    }
+
+    std::string string(size_t maxLength)
+    {
+        std::string result;
+        const size_t n = byte() % maxLength;
+        for (size_t i = 0; i < n; i++)
+        {
+            const char c = static_cast<char>(byte());
+            result += c == '\0' ? 'a' : c;
+        }
+        return result;
+    }
+
+private:
+    const uint8_t* m_pos;
+    const uint8_t* m_end;
+};
+
+std::string makeTags(Input& in)
+{
+    static const char kTags[] = "ifsbTFNIcrmS[]";
+    const size_t      n = in.byte() % 16;
+    std::string       tags;
+    size_t            depth = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        const char t = kTags[in.byte() % (sizeof(kTags) - 1)];
+        if (t == ']')
+        {
+            if (depth == 0)
+                continue;
+            depth--;
+        }
+        else if (t == '[')
+        {
+            depth++;
+        }
+        tags += t;
+    }
+    tags.append(depth, ']');
+    return tags;
+}
+
+void writeArg(Input& in, OSCPP::Client::Packet& packet, char t)
+{
+    switch (t)
+    {
+        case 'i':
+            packet.int32(static_cast<int32_t>(in.word()));
+            break;
+        case 'f':
+        {
+            const uint32_t bits = in.word();
+            float          x;
+            std::memcpy(&x, &bits, 4);
+            // NaN payloads are not guaranteed to survive a round trip
+            packet.float32(std::isnan(x) ? 0.f : x);
+        }
+        break;
+        case 's':
+            packet.string(in.string(64).c_str());
+            break;
+        case 'S':
+            packet.symbol(in.string(64).c_str());
+            break;
+        case 'b':
+        {
+            const size_t      n = in.byte() % 64;
+            std::vector<char> data(n);
+            for (size_t i = 0; i < n; i++)
+                data[i] = static_cast<char>(in.byte());
+            packet.blob(OSCPP::Blob(data.data(), n));
+        }
+        break;
+        case 'T':
+            packet.boolean(true);
+            break;
+        case 'F':
+            packet.boolean(false);
+            break;
+        case 'N':
+            packet.nil();
+            break;
+        case 'I':
+            packet.infinitum();
+            break;
+        case 'c':
+            packet.character(static_cast<char>(in.byte()));
+            break;
+        case 'r':
+            packet.rgba(OSCPP::Rgba(in.word()));
+            break;
+        case 'm':
+            packet.midi(OSCPP::Midi(in.word()));
+            break;
+        case '[':
+            packet.openArray();
+            break;
+        case ']':
+            packet.closeArray();
+            break;
+    }
+}
+
+void build(Input& in, OSCPP::Client::Packet& packet, size_t depth)
+{
+    if (depth < kMaxDepth && (in.byte() & 3) == 0)
+    {
+        packet.openBundle((uint64_t(in.word()) << 32) | in.word());
+        const size_t n = in.byte() % 4;
+        for (size_t i = 0; i < n; i++)
+            build(in, packet, depth + 1);
+        packet.closeBundle();
+    }
+    else
+    {
+        const std::string address = "/" + in.string(32);
+        const std::string tags = makeTags(in);
+        packet.openMessage(address.c_str(), tags.size());
+        for (char t : tags)
+            writeArg(in, packet, t);
+        packet.closeMessage();
+    }
+}
+
+void copyArgs(OSCPP::Server::ArgStream args, OSCPP::Client::Packet& packet)
+{
+    while (!args.atEnd())
+    {
+        switch (args.tag())
+        {
+            case 'i':
+                packet.int32(args.int32());
+                break;
+            case 'f':
+                packet.float32(args.float32());
+                break;
+            case 's':
+                packet.string(args.string());
+                break;
+            case 'S':
+                packet.symbol(args.symbol());
+                break;
+            case 'b':
+                packet.blob(args.blob());
+                break;
+            case 'T':
+            case 'F':
+                packet.boolean(args.boolean());
+                break;
+            case 'N':
+                args.nil();
+                packet.nil();
+                break;
+            case 'I':
+                args.infinitum();
+                packet.infinitum();
+                break;
+            case 'c':
+                packet.character(args.character());
+                break;
+            case 'r':
+                packet.rgba(args.rgba());
+                break;
+            case 'm':
+                packet.midi(args.midi());
+                break;
+            case '[':
+                packet.openArray();
+                copyArgs(args.array(), packet);
+                packet.closeArray();
+                break;
+            default:
+                std::abort();
+        }
+    }
+}
+
+void copy(const OSCPP::Server::Packet& in, OSCPP::Client::Packet& out)
+{
+    if (in.isBundle())
+    {
+        OSCPP::Server::Bundle       bundle(in);
+        OSCPP::Server::PacketStream packets(bundle.packets());
+        out.openBundle(bundle.time());
+        while (!packets.atEnd())
+            copy(packets.next(), out);
+        out.closeBundle();
+    }
+    else
+    {
+        OSCPP::Server::Message msg(in);
+        out.openMessage(msg.address(), msg.args().size());
+        copyArgs(msg.args(), out);
+        out.closeMessage();
+    }
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    OSCPP::Client::DynamicPacket packet1(kBufferSize);
+    Input                        in(data, size);
+    try
+    {
+        build(in, packet1, 0);
+    }
+    catch (OSCPP::OverflowError&)
+    {
+        return 0;
+    }
+
+    // Parsing a packet built by the client must not fail
+    OSCPP::Client::DynamicPacket packet2(kBufferSize);
+    copy(OSCPP::Server::Packet(packet1.data(), packet1.size()), packet2);
+
+    if (packet1.size() != packet2.size() ||
+        std::memcmp(packet1.data(), packet2.data(), packet1.size()) != 0)
+    {
+        std::abort();
+    }
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include <oscpp/print.hpp>
+#include <oscpp/server.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+// Fuzz target for the server side parser.
+//
+// Traverses arbitrary input as an OSC packet, reading every argument with
+// its typed getter. Parse errors are expected and reported as
+// OSCPP::Error; any other exception, crash or sanitizer report is a bug.
+
+namespace {
+
+// Limit recursion in this harness; the library itself doesn't recurse.
+const size_t kMaxDepth = 256;
+
+void traverseArgs(OSCPP::Server::ArgStream args, size_t depth)
+{
+    // Exercise the table driven skipping on a copy
+    OSCPP::Server::ArgStream rest(args);
+    const OSCPP::TagSummary  summary = rest.summary();
+    if (summary.isFixedSize() && rest.measure() != summary.fixedSize)
+        std::abort();
+
+    while (!args.atEnd())
+    {
+        switch (args.tag())
+        {
+            case 'i':
+                args.int32();
+                break;
+            case 'f':
+                args.float32();
+                break;
+            case 's':
+                args.string();
+                break;
+            case 'S':
+                args.symbol();
+                break;
+            case 'b':
+            {
+                const OSCPP::Blob blob = args.blob();
+                volatile char     x = 0;
+                if (blob.size() > 0)
+                    x = static_cast<const char*>(blob.data())[blob.size() - 1];
+                (void)x;
+            }
+            break;
+            case 'T':
+            case 'F':
+                args.boolean();
+                break;
+            case 'N':
+                args.nil();
+                break;
+            case 'I':
+                args.infinitum();
+                break;
+            case 'c':
+                args.character();
+                break;
+            case 'r':
+                args.rgba();
+                break;
+            case 'm':
+                args.midi();
+                break;
+            case '[':
+                if (depth < kMaxDepth)
+                    traverseArgs(args.array(), depth + 1);
+                else
+                    args.drop();
+                break;
+            default:
+                args.drop();
+                break;
+        }
+    }
+}
+
+void traversePacket(const OSCPP::Server::Packet& packet, size_t depth)
+{
+    if (packet.isBundle())
+    {
+        OSCPP::Server::Bundle       bundle(packet);
+        OSCPP::Server::PacketStream packets(bundle.packets());
+        while (!packets.atEnd())
+        {
+            const OSCPP::Server::Packet element(packets.next());
+            if (depth < kMaxDepth)
+                traversePacket(element, depth + 1);
+        }
+    }
+    else
+    {
+        OSCPP::Server::Message msg(packet);
+        if (msg.addressLength() != std::strlen(msg.address()))
+            std::abort();
+        traverseArgs(msg.args(), depth);
+    }
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    // Receive buffers are word aligned
+    std::vector<uint32_t> buffer((size + 3) / 4);
+    if (size > 0)
+        std::memcpy(buffer.data(), data, size);
+
+    const OSCPP::Server::Packet packet(buffer.data(), size);
+    try
+    {
+        traversePacket(packet, 0);
+    }
+    catch (OSCPP::Error&)
+    {
+    }
+
+    try
+    {
+        std::ostringstream out;
+        out << packet;
+    }
+    catch (OSCPP::Error&)
+    {
+    }
+
+    return 0;
+}
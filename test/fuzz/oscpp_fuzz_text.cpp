@@ -0,0 +1,50 @@
+#include <oscpp/client.hpp>
+#include <oscpp/format.hpp>
+#include <oscpp/parse.hpp>
+#include <oscpp/server.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Fuzz target for the text parser.
+//
+// Parses arbitrary input as compact text. Input that is accepted is
+// formatted again, which must parse back to an identical packet. Errors
+// are expected and reported as OSCPP::Error; any other exception, crash
+// or sanitizer report is a bug.
+
+namespace {
+
+const size_t kBufferSize = 65536;
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    const char*                 text = reinterpret_cast<const char*>(data);
+    OSCPP::Client::StaticPacket<kBufferSize> packet;
+    OSCPP::TextParser                        parser;
+    try
+    {
+        parser.parse(text, size, packet);
+    }
+    catch (OSCPP::Error&)
+    {
+        return 0;
+    }
+
+    std::vector<char> formatted(8 * kBufferSize);
+    const size_t      length =
+        OSCPP::format(OSCPP::Server::Packet(packet.data(), packet.size()),
+                      formatted.data(), formatted.size());
+
+    OSCPP::Client::StaticPacket<kBufferSize> packet2;
+    if (parser.parse(formatted.data(), length, packet2) != length ||
+        packet2.size() != packet.size() ||
+        std::memcmp(packet.data(), packet2.data(), packet.size()) != 0)
+        std::abort();
+    return 0;
+}
@@ -0,0 +1,890 @@
+#ifndef OSCPP_TEST_AST_HPP_INCLUDED
+#define OSCPP_TEST_AST_HPP_INCLUDED
+
+#include <oscpp/client.hpp>
+#include <oscpp/server.hpp>
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <ostream>
+#include <string>
+
+// In-memory representation of OSC packets for round-trip testing.
+
+namespace OSCPP { namespace AST {
+class Value
+{
+public:
+    virtual ~Value()
+    {}
+    virtual void print(std::ostream& out) const = 0;
+    virtual void put(OSCPP::Client::Packet& packet) const = 0;
+};
+
+template <class T> using List = std::list<std::shared_ptr<T>>;
+
+template <class T> bool equalList(const List<T>& list1, const List<T>& list2)
+{
+    if (list1.size() != list2.size())
+        return false;
+    auto it1 = list1.begin();
+    auto it2 = list2.begin();
+    while ((it1 != list1.end()) && (it2 != list2.end()))
+    {
+        if (**it1 == **it2)
+        {
+            it1++;
+            it2++;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <class T> void printList(std::ostream& out, const List<T>& list)
+{
+    const size_t n = list.size();
+    size_t       i = 1;
+    out << '[';
+    for (auto x : list)
+    {
+        x->print(out);
+        if (i != n)
+        {
+            out << ',';
+        }
+        i++;
+    }
+    out << ']';
+}
+
+class Argument : public Value
+{
+public:
+    enum Type
+    {
+        kInt32,
+        kFloat32,
+        kString,
+        kBlob,
+        kBoolean,
+        kNil,
+        kInfinitum,
+        kCharacter,
+        kRgba,
+        kMidi,
+        kSymbol,
+        kInt64,
+        kTimeTag,
+        kFloat64,
+        kArray,
+    };
+    static constexpr size_t kNumTypes = kArray + 1;
+
+    Argument(Type type)
+    : m_type(type)
+    {}
+
+    Type type() const
+    {
+        return m_type;
+    }
+
+    virtual size_t numTags() const
+    {
+        return 1;
+    }
+
+    static size_t numTags(const List<Argument>& args)
+    {
+        size_t n = 0;
+        for (auto x : args)
+            n += x->numTags();
+        return n;
+    }
+
+    bool operator==(const Argument& other)
+    {
+        return (type() == other.type()) && equals(other);
+    }
+
+    virtual size_t size() const = 0;
+
+protected:
+    virtual bool equals(const Argument& other) const = 0;
+
+private:
+    Type m_type;
+};
+
+class Bundle;
+class Message;
+
+class Packet : public Value
+{
+public:
+    enum Type
+    {
+        kMessage,
+        kBundle
+    };
+
+    Packet(Type type)
+    : m_type(type)
+    {}
+
+    Type type() const
+    {
+        return m_type;
+    }
+
+    virtual size_t size() const = 0;
+
+    static std::shared_ptr<Packet> parse(const OSCPP::Server::Packet& packet)
+    {
+        return packet.isBundle() ? parseBundle(packet) : parseMessage(packet);
+    }
+
+    bool operator==(const Packet& other) const
+    {
+        return type() == other.type() && equals(other);
+    }
+
+protected:
+    virtual bool equals(const Packet& other) const = 0;
+
+private:
+    static std::shared_ptr<Packet>
+                parseBundle(const OSCPP::Server::Bundle& bdl);
+    static void parseArgs(OSCPP::Server::ArgStream& inArgs,
+                          List<Argument>&           outArgs);
+    static std::shared_ptr<Packet>
+    parseMessage(const OSCPP::Server::Message& msg);
+
+    Type m_type;
+};
+
+class Bundle : public Packet
+{
+public:
+    Bundle(uint64_t time, List<Packet> packets)
+    : Packet(kBundle)
+    , m_time(time)
+    , m_packets(packets)
+    {
+        // assert(packets.size() > 0);
+    }
+
+    void print(std::ostream& out) const override
+    {
+        out << "Bundle(" << m_time << ", ";
+        printList(out, m_packets);
+        out << ')';
+    }
+
+    void put(OSCPP::Client::Packet& packet) const override
+    {
+        packet.openBundle(m_time);
+        for (auto p : m_packets)
+            p->put(packet);
+        packet.closeBundle();
+    }
+
+    size_t size() const override
+    {
+        size_t payload = 0;
+        for (auto x : m_packets)
+            payload += x->size();
+        assert(OSCPP::isAligned(payload));
+        return OSCPP::Size::bundle(m_packets.size()) + payload;
+    }
+
+protected:
+    bool equals(const Packet& other) const override
+    {
+        const auto& otherBundle = dynamic_cast<const Bundle&>(other);
+        return m_time == otherBundle.m_time &&
+               equalList(m_packets, otherBundle.m_packets);
+    }
+
+private:
+    uint64_t     m_time;
+    List<Packet> m_packets;
+};
+
+class Message : public Packet
+{
+public:
+    Message(std::string address, List<Argument> args)
+    : Packet(kMessage)
+    , m_address(address)
+    , m_args(args)
+    {}
+
+    void print(std::ostream& out) const override
+    {
+        out << "Message(" << m_address << ", ";
+        printList(out, m_args);
+        out << ')';
+    }
+
+    void put(OSCPP::Client::Packet& packet) const override
+    {
+        packet.openMessage(m_address.c_str(), Argument::numTags(m_args));
+        for (auto x : m_args)
+            x->put(packet);
+        packet.closeMessage();
+    }
+
+    size_t size() const override
+    {
+        size_t payload = 0;
+        for (auto x : m_args)
+            payload += x->size();
+        assert(OSCPP::isAligned(payload));
+        return OSCPP::Size::message(OSCPP::Size::String(m_address.c_str()),
+                                    Argument::numTags(m_args)) +
+               payload;
+    }
+
+protected:
+    bool equals(const Packet& other) const override
+    {
+        const auto& otherMsg = dynamic_cast<const Message&>(other);
+        return m_address == otherMsg.m_address &&
+               equalList(m_args, otherMsg.m_args);
+    }
+
+private:
+    std::string    m_address;
+    List<Argument> m_args;
+};
+
+class Int32 : public Argument
+{
+public:
+    Int32(int32_t value)
+    : Argument(kInt32)
+    , m_value(value)
+    {}
+
+    void print(std::ostream& out) const override
+    {
+        out << "i:" << m_value;
+    }
+
+    void put(OSCPP::Client::Packet& packet) const override
+    {
+        packet.put(m_value);
+    }
+
+    size_t size() const override
+    {
+        return OSCPP::Size::int32();
+    }
+
+protected:
+    bool equals(const Argument& other) const override
+    {
+        return dynamic_cast<const Int32&>(other).m_value == m_value;
+    }
+
+private:
+    int32_t m_value;
+};
+
+class Float32 : public Argument
+{
+public:
+    Float32(float value)
+    : Argument(kFloat32)
+    , m_value(value)
+    {}
+
+    void print(std::ostream& out) const override
+    {
+        out << "f:" << m_value;
+    }
+
+    void put(OSCPP::Client::Packet& packet) const override
+    {
+        packet.put(m_value);
+    }
+
+    size_t size() const override
+    {
+        return OSCPP::Size::float32();
+    }
+
+protected:
+    bool equals(const Argument& other) const override
+    {
+        return dynamic_cast<const Float32&>(other).m_value == m_value;
+    }
+
+private:
+    float m_value;
+};
+
+class String : public Argument
+{
+public:
+    String(std::string value)
+    : Argument(kString)
+    , m_value(value)
+    {}
+
+    void print(std::ostream& out) const override
+    {
+        out << "s:" << m_value;
+    }
+
+    void put(OSCPP::Client::Packet& packet) const override
+    {
+        packet.put(m_value.c_str());
+    }
+
+    size_t size() const override
+    {
+        return OSCPP::Size::string(OSCPP::Size::String(m_value.c_str()));
+    }
+
+protected:
+    bool equals(const Argument& other) const override
+    {
+        return dynamic_cast<const String&>(other).m_value == m_value;
+    }
+
+private:
+    std::string m_value;
+};
+
+class Blob : public Argument
+{
+public:
+    Blob(int32_t size, const void* data = nullptr)
+    : Argument(kBlob)
+    , m_size(std::max(0, size))
+    , m_data(nullptr)
+    {
+        if (m_size > 0)
+        {
+            m_data = new char[m_size];
+            if (data != nullptr)
+                std::memcpy(m_data, data, m_size);
+        }
+    }
+
+    Blob(OSCPP::Blob b)
+    : Blob(static_cast<int32_t>(b.size()), b.data())
+    {}
+
+    ~Blob()
+    {
+        delete[] m_data;
+    }
+
+    void print(std::ostream& out) const override
+    {
+        out << "b:" << m_size;
+    }
+
+    void put(OSCPP::Client::Packet& packet) const override
+    {
+        packet.put(OSCPP::Blob(m_data, m_size));
+    }
+
+    size_t size() const override
+    {
+        return OSCPP::Size::blob(m_size);
+    }
+
+protected:
+    bool equals(const Argument& other) const override
+    {
+        const Blob& otherBlob = dynamic_cast<const Blob&>(other);
+        return otherBlob.m_size == m_size &&
+               memcmp(m_data, otherBlob.m_data, m_size) == 0;
+    }
+
+private:
+    size_t m_size;
+    char*  m_data;
+};
+
+class Boolean : public Argument
+{
+public:
+    Boolean(bool value)
+    : Argument(kBoolean)
+    , m_value(value)
+    {}
+
+    void print(std::ostream& out) const override
+    {
+        out << (m_value ? 'T' : 'F');
+    }
+
+    void put(OSCPP::Client::Packet& packet) const override
+    {
+        packet.put(m_value);
+    }
+
+    size_t size() const override
+    {
+        return OSCPP::Size::boolean();
+    }
+
+protected:
+    bool equals(const Argument& other) const override
+    {
+        return dynamic_cast<const Boolean&>(other).m_value == m_value;
+    }
+
+private:
+    bool m_value;
+};
+
+class Nil : public Argument
+{
+public:
+    Nil()
+    : Argument(kNil)
+    {}
+
+    void print(std::ostream& out) const override
+    {
+        out << 'N';
+    }
+
+    void put(OSCPP::Client::Packet& packet) const override
+    {
+        packet.nil();
+    }
+
+    size_t size() const override
+    {
+        return OSCPP::Size::nil();
+    }
+
+protected:
+    bool equals(const Argument&) const override
+    {
+        return true;
+    }
+};
+
+class Infinitum : public Argument
+{
+public:
+    Infinitum()
+    : Argument(kInfinitum)
+    {}
+
+    void print(std::ostream& out) const override
+    {
+        out << 'I';
+    }
+
+    void put(OSCPP::Client::Packet& packet) const override
+    {
+        packet.infinitum();
+    }
+
+    size_t size() const override
+    {
+        return OSCPP::Size::infinitum();
+    }
+
+protected:
+    bool equals(const Argument&) const override
+    {
+        return true;
+    }
+};
+
+class Character : public Argument
+{
+public:
+    Character(char value)
+    : Argument(kCharacter)
+    , m_value(value)
+    {}
+
+    void print(std::ostream& out) const override
+    {
+        out << "c:" << m_value;
+    }
+
+    void put(OSCPP::Client::Packet& packet) const override
+    {
+        packet.put(m_value);
+    }
+
+    size_t size() const override
+    {
+        return OSCPP::Size::character();
+    }
+
+protected:
+    bool equals(const Argument& other) const override
+    {
+        return dynamic_cast<const Character&>(other).m_value == m_value;
+    }
+
+private:
+    char m_value;
+};
+
+class Rgba : public Argument
+{
+public:
+    Rgba(OSCPP::Rgba value)
+    : Argument(kRgba)
+    , m_value(value)
+    {}
+
+    void print(std::ostream& out) const override
+    {
+        out << "r:" << m_value.value();
+    }
+
+    void put(OSCPP::Client::Packet& packet) const override
+    {
+        packet.put(m_value);
+    }
+
+    size_t size() const override
+    {
+        return OSCPP::Size::rgba();
+    }
+
+protected:
+    bool equals(const Argument& other) const override
+    {
+        return dynamic_cast<const Rgba&>(other).m_value.value() ==
+               m_value.value();
+    }
+
+private:
+    OSCPP::Rgba m_value;
+};
+
+class Midi : public Argument
+{
+public:
+    Midi(OSCPP::Midi value)
+    : Argument(kMidi)
+    , m_value(value)
+    {}
+
+    void print(std::ostream& out) const override
+    {
+        out << "m:" << m_value.value();
+    }
+
+    void put(OSCPP::Client::Packet& packet) const override
+    {
+        packet.put(m_value);
+    }
+
+    size_t size() const override
+    {
+        return OSCPP::Size::midi();
+    }
+
+protected:
+    bool equals(const Argument& other) const override
+    {
+        return dynamic_cast<const Midi&>(other).m_value.value() ==
+               m_value.value();
+    }
+
+private:
+    OSCPP::Midi m_value;
+};
+
+class Symbol : public Argument
+{
+public:
+    Symbol(std::string value)
+    : Argument(kSymbol)
+    , m_value(value)
+    {}
+
+    void print(std::ostream& out) const override
+    {
+        out << "S:" << m_value;
+    }
+
+    void put(OSCPP::Client::Packet& packet) const override
+    {
+        packet.symbol(m_value.c_str());
+    }
+
+    size_t size() const override
+    {
+        return OSCPP::Size::string(OSCPP::Size::String(m_value.c_str()));
+    }
+
+protected:
+    bool equals(const Argument& other) const override
+    {
+        return dynamic_cast<const Symbol&>(other).m_value == m_value;
+    }
+
+private:
+    std::string m_value;
+};
+
+class Int64 : public Argument
+{
+public:
+    Int64(int64_t value)
+    : Argument(kInt64)
+    , m_value(value)
+    {}
+
+    void print(std::ostream& out) const override
+    {
+        out << "h:" << m_value;
+    }
+
+    void put(OSCPP::Client::Packet& packet) const override
+    {
+        packet.int64(m_value);
+    }
+
+    size_t size() const override
+    {
+        return OSCPP::Size::int64();
+    }
+
+protected:
+    bool equals(const Argument& other) const override
+    {
+        return dynamic_cast<const Int64&>(other).m_value == m_value;
+    }
+
+private:
+    int64_t m_value;
+};
+
+class TimeTag : public Argument
+{
+public:
+    TimeTag(uint64_t value)
+    : Argument(kTimeTag)
+    , m_value(value)
+    {}
+
+    void print(std::ostream& out) const override
+    {
+        out << "t:" << m_value;
+    }
+
+    void put(OSCPP::Client::Packet& packet) const override
+    {
+        packet.timeTag(m_value);
+    }
+
+    size_t size() const override
+    {
+        return OSCPP::Size::timeTag();
+    }
+
+protected:
+    bool equals(const Argument& other) const override
+    {
+        return dynamic_cast<const TimeTag&>(other).m_value == m_value;
+    }
+
+private:
+    uint64_t m_value;
+};
+
+class Float64 : public Argument
+{
+public:
+    Float64(double value)
+    : Argument(kFloat64)
+    , m_value(value)
+    {}
+
+    void print(std::ostream& out) const override
+    {
+        out << "d:" << m_value;
+    }
+
+    void put(OSCPP::Client::Packet& packet) const override
+    {
+        packet.float64(m_value);
+    }
+
+    size_t size() const override
+    {
+        return OSCPP::Size::float64();
+    }
+
+protected:
+    bool equals(const Argument& other) const override
+    {
+        return dynamic_cast<const Float64&>(other).m_value == m_value;
+    }
+
+private:
+    double m_value;
+};
+
+class Array : public Argument
+{
+public:
+    Array(List<Argument> elems = List<Argument>())
+    : Argument(kArray)
+    , m_elems(elems)
+    {}
+
+    void print(std::ostream& out) const override
+    {
+        printList(out, m_elems);
+    }
+
+    void put(OSCPP::Client::Packet& packet) const override
+    {
+        packet.openArray();
+        for (auto x : m_elems)
+            x->put(packet);
+        packet.closeArray();
+    }
+
+    size_t size() const override
+    {
+        size_t payload = 0;
+        for (auto x : m_elems)
+            payload += x->size();
+        assert(OSCPP::isAligned(payload));
+        return payload;
+    }
+
+    size_t numTags() const override
+    {
+        return OSCPP::Tags::array(Argument::numTags(m_elems));
+    }
+
+protected:
+    bool equals(const Argument& other) const override
+    {
+        return equalList(m_elems, dynamic_cast<const Array&>(other).m_elems);
+    }
+
+private:
+    List<Argument> m_elems;
+};
+
+inline std::shared_ptr<Packet>
+Packet::parseBundle(const OSCPP::Server::Bundle& bdl)
+{
+    List<Packet>                outPackets;
+    OSCPP::Server::PacketStream inPackets(bdl.packets());
+    while (!inPackets.atEnd())
+    {
+        outPackets.push_back(parse(inPackets.next()));
+    }
+    return std::make_shared<Bundle>(bdl.time(), std::move(outPackets));
+}
+
+inline void Packet::parseArgs(OSCPP::Server::ArgStream& inArgs,
+                              List<Argument>&           outArgs)
+{
+    while (!inArgs.atEnd())
+    {
+        switch (inArgs.tag())
+        {
+            case 'i':
+                outArgs.push_back(std::make_shared<Int32>(inArgs.int32()));
+                break;
+            case 'f':
+                outArgs.push_back(std::make_shared<Float32>(inArgs.float32()));
+                break;
+            case 's':
+                outArgs.push_back(std::make_shared<String>(inArgs.string()));
+                break;
+            case 'b':
+                outArgs.push_back(std::make_shared<Blob>(inArgs.blob()));
+                break;
+            case 'T':
+            case 'F':
+                outArgs.push_back(std::make_shared<Boolean>(inArgs.boolean()));
+                break;
+            case 'N':
+                inArgs.nil();
+                outArgs.push_back(std::make_shared<Nil>());
+                break;
+            case 'I':
+                inArgs.infinitum();
+                outArgs.push_back(std::make_shared<Infinitum>());
+                break;
+            case 'c':
+                outArgs.push_back(
+                    std::make_shared<Character>(inArgs.character()));
+                break;
+            case 'r':
+                outArgs.push_back(std::make_shared<Rgba>(inArgs.rgba()));
+                break;
+            case 'm':
+                outArgs.push_back(std::make_shared<Midi>(inArgs.midi()));
+                break;
+            case 'S':
+                outArgs.push_back(std::make_shared<Symbol>(inArgs.symbol()));
+                break;
+            case 'h':
+                outArgs.push_back(std::make_shared<Int64>(inArgs.int64()));
+                break;
+            case 't':
+                outArgs.push_back(std::make_shared<TimeTag>(inArgs.timeTag()));
+                break;
+            case 'd':
+                outArgs.push_back(std::make_shared<Float64>(inArgs.float64()));
+                break;
+            case '[':
+            {
+                OSCPP::Server::ArgStream inElems(inArgs.array());
+                List<Argument>           outElems;
+                parseArgs(inElems, outElems);
+                outArgs.push_back(std::make_shared<Array>(outElems));
+            }
+            break;
+        }
+    }
+}
+
+inline std::shared_ptr<Packet>
+Packet::parseMessage(const OSCPP::Server::Message& msg)
+{
+    OSCPP::Server::ArgStream inArgs(msg.args());
+    List<Argument>           outArgs;
+    parseArgs(inArgs, outArgs);
+    return std::make_shared<Message>(msg.address(), outArgs);
+}
+
+inline std::ostream& operator<<(std::ostream& out, const Packet& packet)
+{
+    packet.print(out);
+    return out;
+}
+
+inline std::ostream& operator<<(std::ostream&                  out,
+                                const std::shared_ptr<Packet>& packet)
+{
+    packet->print(out);
+    return out;
+}
+}} // namespace OSCPP::AST
+
+#endif // OSCPP_TEST_AST_HPP_INCLUDED
@@ -0,0 +1,140 @@
+#ifndef OSCPP_TEST_GENERATORS_HPP_INCLUDED
+#define OSCPP_TEST_GENERATORS_HPP_INCLUDED
+
+#include "oscpp_ast.hpp"
+
+#include <autocheck/autocheck.hpp>
+#include <cassert>
+#include <stdexcept>
+#include <vector>
+
+// Random packet generators for autocheck.
+
+namespace ac = autocheck;
+
+namespace OSCPP { namespace AutoCheck {
+
+struct MessageArgListGen
+{
+    typedef AST::List<AST::Argument> result_type;
+    result_type                      operator()(size_t size) const;
+};
+
+struct MessageArgGen
+{
+    typedef std::shared_ptr<AST::Argument> result_type;
+    result_type                            operator()(size_t size) const
+    {
+        AST::Argument::Type argType = static_cast<AST::Argument::Type>(
+            ac::generator<size_t>()(AST::Argument::kNumTypes - 1));
+        switch (argType)
+        {
+            case AST::Argument::kInt32:
+                return std::make_shared<AST::Int32>(
+                    ac::generator<int32_t>()(size));
+            case AST::Argument::kFloat32:
+                return std::make_shared<AST::Float32>(
+                    ac::generator<float>()(size));
+            case AST::Argument::kString:
+                return std::make_shared<AST::String>(
+                    ac::string<ac::ccPrintable>()(std::max<size_t>(1, size)));
+            case AST::Argument::kBlob:
+                return std::make_shared<AST::Blob>(
+                    ac::generator<int32_t>()(size));
+            case AST::Argument::kBoolean:
+                return std::make_shared<AST::Boolean>(
+                    ac::generator<bool>()(size));
+            case AST::Argument::kNil:
+                return std::make_shared<AST::Nil>();
+            case AST::Argument::kInfinitum:
+                return std::make_shared<AST::Infinitum>();
+            case AST::Argument::kCharacter:
+                return std::make_shared<AST::Character>(
+                    static_cast<char>(ac::generator<size_t>()(255)));
+            case AST::Argument::kRgba:
+                return std::make_shared<AST::Rgba>(
+                    OSCPP::Rgba(ac::generator<uint32_t>()(size)));
+            case AST::Argument::kMidi:
+                return std::make_shared<AST::Midi>(
+                    OSCPP::Midi(ac::generator<uint32_t>()(size)));
+            case AST::Argument::kSymbol:
+                return std::make_shared<AST::Symbol>(
+                    ac::string<ac::ccPrintable>()(std::max<size_t>(1, size)));
+            case AST::Argument::kInt64:
+                // Small values and values beyond 32 bits of either sign
+                return std::make_shared<AST::Int64>(static_cast<int64_t>(
+                    (static_cast<uint64_t>(ac::generator<int32_t>()(size))
+                     << 32) ^
+                    ac::generator<uint32_t>()(size)));
+            case AST::Argument::kTimeTag:
+                return std::make_shared<AST::TimeTag>(
+                    (static_cast<uint64_t>(ac::generator<uint32_t>()(size))
+                     << 32) |
+                    ac::generator<uint32_t>()(size));
+            case AST::Argument::kFloat64:
+                // Mostly values that need 17 significant digits
+                return std::make_shared<AST::Float64>(
+                    ac::generator<float>()(size) / 3.0);
+            case AST::Argument::kArray:
+                // Exponential size backoff
+                return std::make_shared<AST::Array>(
+                    MessageArgListGen()(size / 2));
+            default:
+                throw std::logic_error("Invalid AST::Argument::Type value");
+        }
+        assert(false && "Invalid argument type");
+    }
+};
+
+inline MessageArgListGen::result_type
+MessageArgListGen::operator()(size_t size) const
+{
+    const auto& elems = ac::list_of(MessageArgGen())(size);
+    return AST::List<AST::Argument>(elems.begin(), elems.end());
+}
+
+struct PacketGen
+{
+    // ac::generator<std::shared_ptr<oscpp::AST::Packet>> source;
+    typedef std::shared_ptr<AST::Packet> result_type;
+    result_type                          operator()(size_t size) const
+    {
+        return ac::generator<bool>()(size) ? gen_bundle(size)
+                                           : gen_message(size);
+    }
+
+    result_type gen_bundle(size_t size) const
+    {
+        const auto& packets = ac::list_of(PacketGen())(size / 2);
+        return std::make_shared<AST::Bundle>(
+            ac::generator<uint64_t>()(size),
+            AST::List<AST::Packet>(packets.begin(), packets.end()));
+    }
+
+    std::string gen_message_address(size_t size) const
+    {
+        std::string result(
+            ac::string<ac::ccAlphaNumeric>()(std::max<size_t>(2, size)));
+        if (result[0] != '/')
+            result[0] = '/';
+        return result;
+    }
+
+    result_type gen_message(size_t size) const
+    {
+        return std::make_shared<AST::Message>(gen_message_address(size),
+                                              MessageArgListGen()(size));
+    }
+};
+
+// Encode a packet into a buffer of exactly its size.
+inline std::vector<char> encode(const AST::Packet& packet)
+{
+    std::vector<char> data(packet.size());
+    Client::Packet    clientPacket(data.data(), data.size());
+    packet.put(clientPacket);
+    return data;
+}
+}} // namespace OSCPP::AutoCheck
+
+#endif // OSCPP_TEST_GENERATORS_HPP_INCLUDED
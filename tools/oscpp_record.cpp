@@ -0,0 +1,113 @@
+// Record OSC packets received on a UDP port.
+//
+// Usage: oscpp_record [--segment-size BYTES] PREFIX PORT
+//
+// Records are flushed after every received packet; stop with SIGINT or
+// SIGTERM.
+
+#include <oscpp/recording.hpp>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+volatile std::sig_atomic_t gStop = 0;
+
+void stop(int)
+{
+    gStop = 1;
+}
+
+void usage()
+{
+    std::fprintf(stderr,
+                 "Usage: oscpp_record [--segment-size BYTES] PREFIX PORT\n");
+    std::exit(1);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t segmentSize = 64 << 20;
+    int    i = 1;
+    for (; i < argc && argv[i][0] == '-'; i++)
+    {
+        if (std::strcmp(argv[i], "--segment-size") == 0 && i + 1 < argc)
+            segmentSize = std::strtoul(argv[++i], nullptr, 10);
+        else
+            usage();
+    }
+    if (argc - i != 2)
+        usage();
+    const std::string prefix(argv[i]);
+    const int         port = std::atoi(argv[i + 1]);
+
+    const int sock = socket(AF_INET6, SOCK_DGRAM, 0);
+    if (sock < 0)
+    {
+        std::perror("socket");
+        return 1;
+    }
+    sockaddr_in6 addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin6_family = AF_INET6;
+    addr.sin6_addr = in6addr_any;
+    addr.sin6_port = htons(static_cast<uint16_t>(port));
+    const int no = 0;
+    setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, &no, sizeof(no));
+    if (bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        std::perror("bind");
+        return 1;
+    }
+
+    // Don't restart recv, so that signals end the loop.
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = stop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    try
+    {
+        OSCPP::Recording::Recorder recorder(prefix, segmentSize);
+        std::vector<char>          buffer(65536);
+        uint64_t                   numPackets = 0;
+        while (!gStop)
+        {
+            const ssize_t n = recv(sock, buffer.data(), buffer.size(), 0);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                std::perror("recv");
+                break;
+            }
+            recorder.append(buffer.data(), static_cast<size_t>(n));
+            recorder.flush();
+            numPackets++;
+        }
+        std::printf("%llu packets recorded\n",
+                    static_cast<unsigned long long>(numPackets));
+    }
+    catch (std::exception& e)
+    {
+        std::fprintf(stderr, "%s\n", e.what());
+        close(sock);
+        return 1;
+    }
+
+    close(sock);
+    return 0;
+}
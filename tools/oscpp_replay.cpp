@@ -0,0 +1,179 @@
+// Replay a recorded OSC session to a UDP destination.
+//
+// Usage: oscpp_replay [options] PREFIX HOST PORT
+//
+//   --fast         send packets as fast as possible
+//   --speed X      scale the original timing by X (default 1)
+//   --loop N       replay the recording N times (default 1)
+//   --from S       start S seconds after the first record
+//   --to S         stop S seconds after the first record
+
+#include <oscpp/recording.hpp>
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <thread>
+
+namespace {
+
+struct Options
+{
+    bool        fast = false;
+    double      speed = 1;
+    long        loops = 1;
+    double      from = 0;
+    double      to = -1;
+    std::string prefix;
+    std::string host;
+    std::string port;
+};
+
+void usage()
+{
+    std::fprintf(stderr,
+                 "Usage: oscpp_replay [--fast] [--speed X] [--loop N] "
+                 "[--from S] [--to S] PREFIX HOST PORT\n");
+    std::exit(1);
+}
+
+Options parseOptions(int argc, char** argv)
+{
+    Options options;
+    int     i = 1;
+    for (; i < argc && argv[i][0] == '-'; i++)
+    {
+        const std::string arg(argv[i]);
+        if (arg == "--fast")
+            options.fast = true;
+        else if (arg == "--speed" && i + 1 < argc)
+            options.speed = std::atof(argv[++i]);
+        else if (arg == "--loop" && i + 1 < argc)
+            options.loops = std::atol(argv[++i]);
+        else if (arg == "--from" && i + 1 < argc)
+            options.from = std::atof(argv[++i]);
+        else if (arg == "--to" && i + 1 < argc)
+            options.to = std::atof(argv[++i]);
+        else
+            usage();
+    }
+    if (argc - i != 3 || options.speed <= 0)
+        usage();
+    options.prefix = argv[i];
+    options.host = argv[i + 1];
+    options.port = argv[i + 2];
+    return options;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const Options options = parseOptions(argc, argv);
+
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* addr = nullptr;
+    const int err = getaddrinfo(options.host.c_str(), options.port.c_str(),
+                                &hints, &addr);
+    if (err != 0)
+    {
+        std::fprintf(stderr, "%s: %s\n", options.host.c_str(),
+                     gai_strerror(err));
+        return 1;
+    }
+    const int sock = socket(addr->ai_family, addr->ai_socktype, 0);
+    if (sock < 0 || connect(sock, addr->ai_addr, addr->ai_addrlen) != 0)
+    {
+        std::perror("socket");
+        return 1;
+    }
+    freeaddrinfo(addr);
+
+    try
+    {
+        const OSCPP::Recording::Reader reader(options.prefix);
+        uint64_t numPackets = 0;
+        uint64_t numBytes = 0;
+        uint64_t numErrors = 0;
+        const auto start = std::chrono::steady_clock::now();
+
+        // Select the time range relative to the first record
+        uint64_t begin = 0;
+        uint64_t end = std::numeric_limits<uint64_t>::max();
+        if (reader.numSegments() > 0)
+        {
+            const uint64_t origin = reader.index(0).firstTime();
+            begin = origin + static_cast<uint64_t>(options.from * 1e9);
+            if (options.to >= 0)
+                end = origin + static_cast<uint64_t>(options.to * 1e9);
+        }
+
+        for (long loop = 0; loop < options.loops; loop++)
+        {
+            auto records = reader.range(begin, end);
+            if (records.atEnd())
+                break;
+            const auto loopStart = std::chrono::steady_clock::now();
+            uint64_t   firstTime = 0;
+            bool       first = true;
+            while (!records.atEnd())
+            {
+                const OSCPP::Recording::Record record = records.next();
+                if (first)
+                {
+                    firstTime = record.time;
+                    first = false;
+                }
+                if (!options.fast && record.time > firstTime)
+                {
+                    const double offset =
+                        (record.time - firstTime) / options.speed;
+                    std::this_thread::sleep_until(
+                        loopStart +
+                        std::chrono::nanoseconds(static_cast<int64_t>(offset)));
+                }
+                if (send(sock, record.packet.data(), record.packet.size(), 0) <
+                    0)
+                {
+                    numErrors++;
+                }
+                else
+                {
+                    numPackets++;
+                    numBytes += record.packet.size();
+                }
+            }
+        }
+
+        const double secs = std::chrono::duration<double>(
+                                std::chrono::steady_clock::now() - start)
+                                .count();
+        std::printf("%llu packets, %llu bytes, %llu errors in %.3f s "
+                    "(%.0f packets/s)\n",
+                    static_cast<unsigned long long>(numPackets),
+                    static_cast<unsigned long long>(numBytes),
+                    static_cast<unsigned long long>(numErrors), secs,
+                    secs > 0 ? numPackets / secs : 0.);
+    }
+    catch (std::exception& e)
+    {
+        std::fprintf(stderr, "%s\n", e.what());
+        close(sock);
+        return 1;
+    }
+
+    close(sock);
+    return 0;
+}